@@ -0,0 +1,365 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBBakeSurfaceFieldCommandlet.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "Surface/SBSurfaceField.h"
+#include "Surface/SBSurfaceFieldSubsystem.h"
+#include "Surface/SBSurfaceMaterialTable.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSkateSurfaceBake, Log, All);
+
+namespace
+{
+	/** Max amount of bricks in the dense brick index, keeps a wrong cell size from allocating the whole machine */
+	constexpr int64 MaxBrickIndexSize = 64 * 1024 * 1024;
+
+	UWorld* LoadBakeWorld(const FString& MapPackageName)
+	{
+		UPackage* Package = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+		UWorld* World = UWorld::FindWorldInPackage(Package);
+		if (World == nullptr)
+		{
+			return nullptr;
+		}
+
+		World->AddToRoot();
+		World->WorldType = EWorldType::Editor;
+
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Editor);
+		WorldContext.SetCurrentWorld(World);
+
+		// Only the physics scene is needed to query the collision
+		World->InitWorld(UWorld::InitializationValues()
+			.InitializeScenes(false)
+			.AllowAudioPlayback(false)
+			.RequiresHitProxies(false)
+			.CreatePhysicsScene(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.SetTransactional(false));
+		World->UpdateWorldComponents(true, false);
+		return World;
+	}
+
+	void DestroyBakeWorld(UWorld* World)
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	/** Collision that never moves, everything else is traced at runtime */
+	bool IsBakedPrimitive(const UPrimitiveComponent* Component, const UWorld* World)
+	{
+		return Component->GetWorld() == World
+			&& Component->IsRegistered()
+			&& Component->Mobility == EComponentMobility::Static
+			&& Component->IsQueryCollisionEnabled()
+			&& Component->GetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility) == ECR_Block;
+	}
+
+	bool ParseBounds(const FString& BoundsParam, FBox& OutBounds)
+	{
+		TArray<FString> Values;
+		BoundsParam.ParseIntoArray(Values, TEXT(","));
+		if (Values.Num() != 6)
+		{
+			return false;
+		}
+
+		OutBounds = FBox(FVector(FCString::Atod(*Values[0]), FCString::Atod(*Values[1]), FCString::Atod(*Values[2])),
+		                 FVector(FCString::Atod(*Values[3]), FCString::Atod(*Values[4]), FCString::Atod(*Values[5])));
+		return OutBounds.IsValid != 0;
+	}
+
+	/**
+	 * Gives every primitive the slot of its surface keys in the surface table, primitives with the same keys share a slot.
+	 * Slot 0 is unknown, it is used for every primitive past the 255 slots a sample can address.
+	 */
+	FString BuildSurfaceTable(const TArray<const UPrimitiveComponent*>& Primitives, TMap<const UPrimitiveComponent*, uint8>& OutPrimitiveSurfaces)
+	{
+		TArray<FString> Lines;
+		TMap<FString, uint8> LineSlots;
+		TArray<FSoftObjectPath> Keys;
+		for (const UPrimitiveComponent* Primitive : Primitives)
+		{
+			USBSurfaceMaterialTable::GetSurfaceKeys(Primitive, Keys);
+			FString Line = FString::JoinBy(Keys, TEXT(";"), [](const FSoftObjectPath& Key) { return Key.ToString(); });
+
+			uint8 Slot = 0;
+			if (const uint8* ExistingSlot = LineSlots.Find(Line))
+			{
+				Slot = *ExistingSlot;
+			}
+			else if (Lines.Num() < MAX_uint8)
+			{
+				Slot = static_cast<uint8>(Lines.Add(Line) + 1);
+				LineSlots.Add(MoveTemp(Line), Slot);
+			}
+			else
+			{
+				UE_LOG(LogSkateSurfaceBake, Warning, TEXT("More than %d surfaces, %s is baked as unknown"), MAX_uint8, *GetPathNameSafe(Primitive));
+			}
+			OutPrimitiveSurfaces.Add(Primitive, Slot);
+		}
+		return FString::Join(Lines, TEXT("\n"));
+	}
+
+	/** Distance, normal and surface of every sample of a brick, false if the whole brick is outside the narrow band */
+	bool BakeBrick(const FIntVector& Brick, const FSBSurfaceFieldHeader& Header, const TArray<const UPrimitiveComponent*>& Primitives,
+	               const TMap<const UPrimitiveComponent*, uint8>& PrimitiveSurfaces, TArrayView<FSBSurfaceFieldSample> OutSamples)
+	{
+		const int32 Stride = Header.BrickSize + 1;
+		const float BrickExtent = Header.BrickSize * Header.CellSize;
+		const FVector BrickMin = FVector(Header.Origin) + FVector(Brick) * BrickExtent;
+		const FBox BrickBounds(BrickMin, BrickMin + FVector(BrickExtent));
+
+		TArray<const UPrimitiveComponent*, TInlineAllocator<16>> Overlapping;
+		for (const UPrimitiveComponent* Primitive : Primitives)
+		{
+			if (Primitive->Bounds.GetBox().ExpandBy(Header.MaxDistance).Intersect(BrickBounds))
+			{
+				Overlapping.Add(Primitive);
+			}
+		}
+
+		if (Overlapping.Num() == 0)
+		{
+			return false;
+		}
+
+		TArray<float> Distances;
+		TArray<FVector> Normals;
+		TArray<uint8> Surfaces;
+		Distances.SetNumUninitialized(OutSamples.Num());
+		Normals.SetNumZeroed(OutSamples.Num());
+		Surfaces.SetNumZeroed(OutSamples.Num());
+
+		bool bInBand = false;
+		for (int32 Z = 0; Z < Stride; ++Z)
+		{
+			for (int32 Y = 0; Y < Stride; ++Y)
+			{
+				for (int32 X = 0; X < Stride; ++X)
+				{
+					const int32 Index = (Z * Stride + Y) * Stride + X;
+					const FVector Location = BrickMin + FVector(X, Y, Z) * Header.CellSize;
+
+					float ClosestDistance = Header.MaxDistance;
+					for (const UPrimitiveComponent* Primitive : Overlapping)
+					{
+						FVector ClosestPoint;
+						const float Distance = Primitive->GetDistanceToCollision(Location, ClosestPoint);
+						if (Distance >= 0.f && Distance < ClosestDistance)
+						{
+							ClosestDistance = Distance;
+							Normals[Index] = Distance > UE_KINDA_SMALL_NUMBER ? (Location - ClosestPoint) / Distance : FVector::ZeroVector;
+							Surfaces[Index] = PrimitiveSurfaces.FindRef(Primitive);
+						}
+					}
+
+					Distances[Index] = ClosestDistance;
+					bInBand |= ClosestDistance < Header.MaxDistance;
+				}
+			}
+		}
+
+		if (bInBand == false)
+		{
+			return false;
+		}
+
+		for (int32 Z = 0; Z < Stride; ++Z)
+		{
+			for (int32 Y = 0; Y < Stride; ++Y)
+			{
+				for (int32 X = 0; X < Stride; ++X)
+				{
+					const int32 Index = (Z * Stride + Y) * Stride + X;
+
+					// Samples inside the collision have no closest point direction, use the distance gradient of the brick instead
+					FVector Normal = Normals[Index];
+					if (Normal.IsNearlyZero())
+					{
+						auto DistanceAt = [&](int32 SampleX, int32 SampleY, int32 SampleZ)
+						{
+							return Distances[(FMath::Clamp(SampleZ, 0, Stride - 1) * Stride + FMath::Clamp(SampleY, 0, Stride - 1)) * Stride + FMath::Clamp(SampleX, 0, Stride - 1)];
+						};
+						Normal = FVector(DistanceAt(X + 1, Y, Z) - DistanceAt(X - 1, Y, Z),
+						                 DistanceAt(X, Y + 1, Z) - DistanceAt(X, Y - 1, Z),
+						                 DistanceAt(X, Y, Z + 1) - DistanceAt(X, Y, Z - 1));
+					}
+					Normal = Normal.GetSafeNormal(UE_SMALL_NUMBER, FVector::UpVector);
+
+					FSBSurfaceFieldSample& Sample = OutSamples[Index];
+					Sample.Distance = FSBSurfaceField::QuantizeDistance(Distances[Index], Header.MaxDistance);
+					Sample.NormalX = FSBSurfaceField::QuantizeNormal(Normal.X);
+					Sample.NormalY = FSBSurfaceField::QuantizeNormal(Normal.Y);
+					Sample.NormalZ = FSBSurfaceField::QuantizeNormal(Normal.Z);
+					Sample.Surface = Surfaces[Index];
+				}
+			}
+		}
+		return true;
+	}
+}
+
+USBBakeSurfaceFieldCommandlet::USBBakeSurfaceFieldCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USBBakeSurfaceFieldCommandlet::Main(const FString& Params)
+{
+	FString MapPackageName;
+	if (FParse::Value(*Params, TEXT("Map="), MapPackageName) == false || FPackageName::IsValidLongPackageName(MapPackageName) == false)
+	{
+		UE_LOG(LogSkateSurfaceBake, Error, TEXT("Missing or invalid -Map=/Game/Path/To/Map"));
+		return 1;
+	}
+
+	FSBSurfaceFieldHeader Header;
+	FParse::Value(*Params, TEXT("CellSize="), Header.CellSize);
+	FParse::Value(*Params, TEXT("BrickSize="), Header.BrickSize);
+	FParse::Value(*Params, TEXT("Band="), Header.MaxDistance);
+	if (Header.CellSize <= 0.f || Header.BrickSize <= 0 || Header.MaxDistance <= 0.f)
+	{
+		UE_LOG(LogSkateSurfaceBake, Error, TEXT("CellSize, BrickSize and Band have to be positive"));
+		return 1;
+	}
+
+	FString OutputPath = USBSurfaceFieldSubsystem::GetFieldFilename(MapPackageName);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	UWorld* World = LoadBakeWorld(MapPackageName);
+	if (World == nullptr)
+	{
+		UE_LOG(LogSkateSurfaceBake, Error, TEXT("Failed to load map %s"), *MapPackageName);
+		return 1;
+	}
+
+	TArray<const UPrimitiveComponent*> Primitives;
+	FBox Bounds(ForceInit);
+	for (TObjectIterator<UPrimitiveComponent> It; It; ++It)
+	{
+		if (IsBakedPrimitive(*It, World))
+		{
+			Primitives.Add(*It);
+			Bounds += It->Bounds.GetBox();
+		}
+	}
+
+	// Playable area can be restricted, the ground plane of a park is usually much bigger than the park
+	FString BoundsParam;
+	if (FParse::Value(*Params, TEXT("Bounds="), BoundsParam, false) && ParseBounds(BoundsParam, Bounds) == false)
+	{
+		UE_LOG(LogSkateSurfaceBake, Error, TEXT("Invalid -Bounds=MinX,MinY,MinZ,MaxX,MaxY,MaxZ"));
+		DestroyBakeWorld(World);
+		return 1;
+	}
+
+	if (Primitives.Num() == 0 || Bounds.IsValid == 0)
+	{
+		UE_LOG(LogSkateSurfaceBake, Error, TEXT("No static collision to bake in %s"), *MapPackageName);
+		DestroyBakeWorld(World);
+		return 1;
+	}
+
+	Bounds = Bounds.ExpandBy(Header.MaxDistance);
+	const float BrickExtent = Header.BrickSize * Header.CellSize;
+	const FVector GridSize = Bounds.GetSize() / BrickExtent;
+	Header.Origin = FVector3f(Bounds.Min);
+	Header.BrickGridSize = FIntVector3(FMath::CeilToInt32(GridSize.X), FMath::CeilToInt32(GridSize.Y), FMath::CeilToInt32(GridSize.Z));
+
+	const int64 BrickIndexSize = static_cast<int64>(Header.BrickGridSize.X) * Header.BrickGridSize.Y * Header.BrickGridSize.Z;
+	if (BrickIndexSize > MaxBrickIndexSize)
+	{
+		UE_LOG(LogSkateSurfaceBake, Error, TEXT("%lld bricks is too many, increase CellSize or restrict -Bounds"), BrickIndexSize);
+		DestroyBakeWorld(World);
+		return 1;
+	}
+
+	// Only bricks touched by the expanded bounds of a primitive can be inside the narrow band
+	TBitArray<> CandidateMask(false, static_cast<int32>(BrickIndexSize));
+	for (const UPrimitiveComponent* Primitive : Primitives)
+	{
+		const FBox PrimitiveBounds = Primitive->Bounds.GetBox().ExpandBy(Header.MaxDistance);
+		const FVector MinBrick = (PrimitiveBounds.Min - Bounds.Min) / BrickExtent;
+		const FVector MaxBrick = (PrimitiveBounds.Max - Bounds.Min) / BrickExtent;
+		for (int32 Z = FMath::Max(0, FMath::FloorToInt32(MinBrick.Z)); Z <= FMath::Min(Header.BrickGridSize.Z - 1, FMath::FloorToInt32(MaxBrick.Z)); ++Z)
+		{
+			for (int32 Y = FMath::Max(0, FMath::FloorToInt32(MinBrick.Y)); Y <= FMath::Min(Header.BrickGridSize.Y - 1, FMath::FloorToInt32(MaxBrick.Y)); ++Y)
+			{
+				for (int32 X = FMath::Max(0, FMath::FloorToInt32(MinBrick.X)); X <= FMath::Min(Header.BrickGridSize.X - 1, FMath::FloorToInt32(MaxBrick.X)); ++X)
+				{
+					CandidateMask[(Z * Header.BrickGridSize.Y + Y) * Header.BrickGridSize.X + X] = true;
+				}
+			}
+		}
+	}
+
+	TArray<int32> Candidates;
+	for (TConstSetBitIterator<> It(CandidateMask); It; ++It)
+	{
+		Candidates.Add(It.GetIndex());
+	}
+
+	TMap<const UPrimitiveComponent*, uint8> PrimitiveSurfaces;
+	const FString SurfaceTable = BuildSurfaceTable(Primitives, PrimitiveSurfaces);
+
+	UE_LOG(LogSkateSurfaceBake, Display, TEXT("Baking %d primitives, %d of %lld bricks are candidates"), Primitives.Num(), Candidates.Num(), BrickIndexSize);
+
+	const int32 SamplesPerBrick = FSBSurfaceField::GetSamplesPerBrick(Header.BrickSize);
+	TArray<FSBSurfaceFieldSample> CandidateSamples;
+	CandidateSamples.SetNum(Candidates.Num() * SamplesPerBrick);
+	TArray<bool> CandidateInBand;
+	CandidateInBand.SetNumZeroed(Candidates.Num());
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	ParallelFor(Candidates.Num(), [&](int32 CandidateIndex)
+	{
+		const int32 BrickIndex = Candidates[CandidateIndex];
+		const FIntVector Brick(BrickIndex % Header.BrickGridSize.X, (BrickIndex / Header.BrickGridSize.X) % Header.BrickGridSize.Y,
+		                       BrickIndex / (Header.BrickGridSize.X * Header.BrickGridSize.Y));
+		const TArrayView<FSBSurfaceFieldSample> BrickSamples(CandidateSamples.GetData() + static_cast<int64>(CandidateIndex) * SamplesPerBrick, SamplesPerBrick);
+		CandidateInBand[CandidateIndex] = BakeBrick(Brick, Header, Primitives, PrimitiveSurfaces, BrickSamples);
+	});
+
+	// Compact the bricks inside the narrow band, everything else reads as MaxDistance
+	TArray<int32> BrickIndex;
+	BrickIndex.Init(INDEX_NONE, static_cast<int32>(BrickIndexSize));
+	TArray<FSBSurfaceFieldSample> Samples;
+	for (int32 CandidateIndex = 0; CandidateIndex < Candidates.Num(); ++CandidateIndex)
+	{
+		if (CandidateInBand[CandidateIndex])
+		{
+			BrickIndex[Candidates[CandidateIndex]] = Header.NumBricks++;
+			Samples.Append(CandidateSamples.GetData() + static_cast<int64>(CandidateIndex) * SamplesPerBrick, SamplesPerBrick);
+		}
+	}
+
+	DestroyBakeWorld(World);
+
+	if (FSBSurfaceField::Save(OutputPath, Header, BrickIndex, Samples, SurfaceTable) == false)
+	{
+		UE_LOG(LogSkateSurfaceBake, Error, TEXT("Failed to write surface field to %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogSkateSurfaceBake, Display, TEXT("Baked %d bricks (%.1f MB) in %.1fs to %s"), Header.NumBricks,
+	       (sizeof(FSBSurfaceFieldHeader) + BrickIndex.Num() * sizeof(int32) + Samples.Num() * sizeof(FSBSurfaceFieldSample)) / (1024.f * 1024.f),
+	       FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles), *OutputPath);
+	return 0;
+}
@@ -0,0 +1,24 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SBBakeSurfaceFieldCommandlet.generated.h"
+
+/**
+ * Bakes the narrow band distance and normal field of the static collision of a map, loaded by USBSurfaceFieldSubsystem.
+ * Has to be run again whenever the static geometry of the map changes.
+ *
+ * UnrealEditor-Cmd Skateboarding -run=SBBakeSurfaceField -nullrhi -Map=/Game/Skateboarding/Maps/Playground -CellSize=10 -Band=30
+ */
+UCLASS()
+class USBBakeSurfaceFieldCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USBBakeSurfaceFieldCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,240 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateBenchmarkCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "SBSkateSimulationWorld.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+#include "Skateboarding/SBSkateMovementManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSkateBenchmark, Log, All);
+
+namespace
+{
+	/** Average cost of a benchmark run, stage times are in microseconds per skater per tick */
+	struct FSBBenchmarkResult
+	{
+		ESBSkateScenario Scenario = ESBSkateScenario::Flat;
+		int32 Skaters = 0;
+		int32 Frames = 0;
+		double FrameUs = 0.0;
+		double PhysSkateUs = 0.0;
+		double GetSurfaceUs = 0.0;
+		double RotationUs = 0.0;
+		double MoveUs = 0.0;
+		double BatchGatherUs = 0.0;
+		double BatchIntegrateUs = 0.0;
+		double BatchResolveUs = 0.0;
+		double StepsPerTick = 0.0;
+	};
+
+	FSBBenchmarkResult RunBenchmark(ESBSkateScenario Scenario, int32 SkaterCount, int32 WarmupFrames, int32 Frames, float DeltaTime)
+	{
+		FSBSkateSimulationWorld SimulationWorld(Scenario);
+		SimulationWorld.Populate(SkaterCount, FVector(600.f, 0.f, 0.f));
+
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			SimulationWorld.Tick(DeltaTime);
+		}
+
+		for (ASBCharacter* Skater : SimulationWorld.GetSkaters())
+		{
+			Skater->GetSkateMovementComponent()->ResetStageTimings();
+			Skater->GetSkateMovementComponent()->SetRecordStageTimings(true);
+		}
+
+		USBSkateMovementManager* MovementManager = SimulationWorld.GetWorld()->GetSubsystem<USBSkateMovementManager>();
+		if (MovementManager != nullptr)
+		{
+			MovementManager->ResetTimings();
+		}
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			SimulationWorld.Tick(DeltaTime);
+		}
+		const uint64 FrameCycles = FPlatformTime::Cycles64() - StartCycles;
+
+		FSBSkateStageTimings Total;
+		for (ASBCharacter* Skater : SimulationWorld.GetSkaters())
+		{
+			const FSBSkateStageTimings& Timings = Skater->GetSkateMovementComponent()->GetStageTimings();
+			Total.PhysSkateCycles += Timings.PhysSkateCycles;
+			Total.GetSurfaceCycles += Timings.GetSurfaceCycles;
+			Total.RotationCycles += Timings.RotationCycles;
+			Total.MoveCycles += Timings.MoveCycles;
+			Total.Steps += Timings.Steps;
+		}
+
+		const double SkaterTicks = FMath::Max(1.0, static_cast<double>(SimulationWorld.GetSkaters().Num()) * Frames);
+		auto ToMicroseconds = [SkaterTicks](uint64 Cycles)
+		{
+			return FPlatformTime::ToSeconds64(Cycles) * 1000000.0 / SkaterTicks;
+		};
+
+		FSBBenchmarkResult Result;
+		Result.Scenario = Scenario;
+		Result.Skaters = SimulationWorld.GetSkaters().Num();
+		Result.Frames = Frames;
+		Result.FrameUs = FPlatformTime::ToSeconds64(FrameCycles) * 1000000.0 / Frames;
+		Result.GetSurfaceUs = ToMicroseconds(Total.GetSurfaceCycles);
+		Result.RotationUs = ToMicroseconds(Total.RotationCycles);
+		Result.MoveUs = ToMicroseconds(Total.MoveCycles);
+		if (MovementManager != nullptr)
+		{
+			// Batched steps never go through PhysSkate, their three phases are the whole skate step
+			const FSBSkateBatchTimings& BatchTimings = MovementManager->GetTimings();
+			Total.PhysSkateCycles += BatchTimings.GatherCycles + BatchTimings.IntegrateCycles + BatchTimings.ResolveCycles;
+			Result.BatchGatherUs = ToMicroseconds(BatchTimings.GatherCycles);
+			Result.BatchIntegrateUs = ToMicroseconds(BatchTimings.IntegrateCycles);
+			Result.BatchResolveUs = ToMicroseconds(BatchTimings.ResolveCycles);
+		}
+		Result.PhysSkateUs = ToMicroseconds(Total.PhysSkateCycles);
+		Result.StepsPerTick = Total.Steps / SkaterTicks;
+		return Result;
+	}
+
+	FString ToJson(const TArray<FSBBenchmarkResult>& Results, float DeltaTime, bool bBatched)
+	{
+		TArray<TSharedPtr<FJsonValue>> JsonResults;
+		for (const FSBBenchmarkResult& Result : Results)
+		{
+			TSharedRef<FJsonObject> JsonResult = MakeShared<FJsonObject>();
+			JsonResult->SetStringField(TEXT("scenario"), LexToString(Result.Scenario));
+			JsonResult->SetNumberField(TEXT("skaters"), Result.Skaters);
+			JsonResult->SetNumberField(TEXT("frames"), Result.Frames);
+			JsonResult->SetNumberField(TEXT("frameUs"), Result.FrameUs);
+			JsonResult->SetNumberField(TEXT("physSkateUs"), Result.PhysSkateUs);
+			JsonResult->SetNumberField(TEXT("getSurfaceUs"), Result.GetSurfaceUs);
+			JsonResult->SetNumberField(TEXT("rotationUs"), Result.RotationUs);
+			JsonResult->SetNumberField(TEXT("moveUs"), Result.MoveUs);
+			JsonResult->SetNumberField(TEXT("batchGatherUs"), Result.BatchGatherUs);
+			JsonResult->SetNumberField(TEXT("batchIntegrateUs"), Result.BatchIntegrateUs);
+			JsonResult->SetNumberField(TEXT("batchResolveUs"), Result.BatchResolveUs);
+			JsonResult->SetNumberField(TEXT("stepsPerTick"), Result.StepsPerTick);
+			JsonResults.Add(MakeShared<FJsonValueObject>(JsonResult));
+		}
+
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetNumberField(TEXT("deltaTime"), DeltaTime);
+		Root->SetBoolField(TEXT("batched"), bBatched);
+		Root->SetStringField(TEXT("units"), TEXT("us per skater per tick"));
+		Root->SetArrayField(TEXT("results"), JsonResults);
+
+		FString Output;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+		FJsonSerializer::Serialize(Root, Writer);
+		return Output;
+	}
+
+	FString ToCsv(const TArray<FSBBenchmarkResult>& Results)
+	{
+		FString Output = TEXT("Scenario,Skaters,Frames,FrameUs,PhysSkateUs,GetSurfaceUs,RotationUs,MoveUs,BatchGatherUs,BatchIntegrateUs,BatchResolveUs,StepsPerTick\n");
+		for (const FSBBenchmarkResult& Result : Results)
+		{
+			Output += FString::Printf(TEXT("%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"), LexToString(Result.Scenario), Result.Skaters,
+			                          Result.Frames, Result.FrameUs, Result.PhysSkateUs, Result.GetSurfaceUs, Result.RotationUs,
+			                          Result.MoveUs, Result.BatchGatherUs, Result.BatchIntegrateUs, Result.BatchResolveUs, Result.StepsPerTick);
+		}
+		return Output;
+	}
+}
+
+USBSkateBenchmarkCommandlet::USBSkateBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USBSkateBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString SkatersParam = TEXT("1,16,64");
+	FParse::Value(*Params, TEXT("Skaters="), SkatersParam, false);
+
+	FString ScenariosParam = TEXT("Flat,Slope,Ramp");
+	FParse::Value(*Params, TEXT("Scenarios="), ScenariosParam, false);
+
+	int32 Frames = 600;
+	FParse::Value(*Params, TEXT("Frames="), Frames);
+
+	int32 WarmupFrames = 60;
+	FParse::Value(*Params, TEXT("Warmup="), WarmupFrames);
+
+	float DeltaTime = 1.f / 60.f;
+	FParse::Value(*Params, TEXT("DeltaTime="), DeltaTime);
+
+	bool bBatched = true;
+	FParse::Bool(*Params, TEXT("Batched="), bBatched);
+
+	FString Format = TEXT("json");
+	FParse::Value(*Params, TEXT("Format="), Format);
+	Format.ToLowerInline();
+	if (Format != TEXT("json") && Format != TEXT("csv"))
+	{
+		UE_LOG(LogSkateBenchmark, Error, TEXT("Unknown format '%s', expected json or csv"), *Format);
+		return 1;
+	}
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("SkateBenchmark.%s"), *Format);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	TArray<FString> SkaterCounts;
+	SkatersParam.ParseIntoArray(SkaterCounts, TEXT(","));
+
+	TArray<FString> ScenarioNames;
+	ScenariosParam.ParseIntoArray(ScenarioNames, TEXT(","));
+
+	// Compare the batched skate movement against the per component steps
+	IConsoleVariable* BatchMovementVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("sb.Skate.BatchMovement"));
+	const bool bWasBatched = BatchMovementVariable != nullptr && BatchMovementVariable->GetBool();
+	if (BatchMovementVariable != nullptr)
+	{
+		BatchMovementVariable->Set(bBatched, ECVF_SetByCommandline);
+	}
+
+	TArray<FSBBenchmarkResult> Results;
+	for (const FString& ScenarioName : ScenarioNames)
+	{
+		ESBSkateScenario Scenario;
+		if (LexFromString(Scenario, *ScenarioName.TrimStartAndEnd()) == false)
+		{
+			UE_LOG(LogSkateBenchmark, Error, TEXT("Unknown scenario '%s'"), *ScenarioName);
+			continue;
+		}
+
+		for (const FString& SkaterCount : SkaterCounts)
+		{
+			const FSBBenchmarkResult Result = RunBenchmark(Scenario, FCString::Atoi(*SkaterCount), WarmupFrames, Frames, DeltaTime);
+			UE_LOG(LogSkateBenchmark, Display, TEXT("%s x%d: frame %.1fus | per skater tick PhysSkate %.2fus GetSurface %.2fus Rotation %.2fus Move %.2fus | batch Gather %.2fus Integrate %.2fus Resolve %.2fus"),
+			       LexToString(Result.Scenario), Result.Skaters, Result.FrameUs, Result.PhysSkateUs, Result.GetSurfaceUs, Result.RotationUs,
+			       Result.MoveUs, Result.BatchGatherUs, Result.BatchIntegrateUs, Result.BatchResolveUs);
+			Results.Add(Result);
+		}
+	}
+
+	if (BatchMovementVariable != nullptr)
+	{
+		BatchMovementVariable->Set(bWasBatched, ECVF_SetByCommandline);
+	}
+
+	const FString Output = Format == TEXT("csv") ? ToCsv(Results) : ToJson(Results, DeltaTime, bBatched);
+	if (FFileHelper::SaveStringToFile(Output, *OutputPath) == false)
+	{
+		UE_LOG(LogSkateBenchmark, Error, TEXT("Failed to write benchmark results to %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogSkateBenchmark, Display, TEXT("Benchmark results written to %s"), *OutputPath);
+	return 0;
+}
@@ -0,0 +1,24 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SBSkateBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of the skate movement hot path.
+ * Times PhysSkate, GetSurface, the rotation alignment and SafeMoveUpdatedComponent for N skaters per scenario.
+ *
+ * UnrealEditor-Cmd Skateboarding -run=SBSkateBenchmark -nullrhi -Skaters=1,16,64 -Scenarios=Flat,Slope,Ramp -Frames=600 -Format=json
+ */
+UCLASS()
+class USBSkateBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USBSkateBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,173 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateSimulationWorld.h"
+
+#include "Components/CapsuleComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+namespace SBSkateSimulationWorld
+{
+	const TCHAR* CubeMeshPath = TEXT("/Engine/BasicShapes/Cube.Cube");
+	const TCHAR* RampMeshPath = TEXT("/Game/SkatePark/Meshes/SM_rampRadial.SM_rampRadial");
+
+	constexpr float LaneSpacing = 250.f;
+	constexpr float GroundLength = 20000.f;
+	constexpr float SlopeAngle = 12.f;
+}
+
+const TCHAR* LexToString(ESBSkateScenario Scenario)
+{
+	switch (Scenario)
+	{
+	case ESBSkateScenario::Flat:
+		return TEXT("Flat");
+	case ESBSkateScenario::Slope:
+		return TEXT("Slope");
+	case ESBSkateScenario::Ramp:
+		return TEXT("Ramp");
+	default:
+		return TEXT("Unknown");
+	}
+}
+
+bool LexFromString(ESBSkateScenario& OutScenario, const TCHAR* String)
+{
+	for (const ESBSkateScenario Scenario : {ESBSkateScenario::Flat, ESBSkateScenario::Slope, ESBSkateScenario::Ramp})
+	{
+		if (FCString::Stricmp(String, LexToString(Scenario)) == 0)
+		{
+			OutScenario = Scenario;
+			return true;
+		}
+	}
+	return false;
+}
+
+FSBSkateSimulationWorld::FSBSkateSimulationWorld(ESBSkateScenario InScenario)
+	: Scenario(InScenario)
+{
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("SkateSimulationWorld"));
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	// There is no game mode to start the match, so begin play on the actors directly
+	if (World->GetBegunPlay() == false)
+	{
+		World->GetWorldSettings()->NotifyBeginPlay();
+	}
+}
+
+FSBSkateSimulationWorld::~FSBSkateSimulationWorld()
+{
+	Skaters.Reset();
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World = nullptr;
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void FSBSkateSimulationWorld::Populate(int32 SkaterCount, const FVector& InitialVelocity)
+{
+	using namespace SBSkateSimulationWorld;
+
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, CubeMeshPath);
+	const float GroundWidth = (SkaterCount + 2) * LaneSpacing;
+
+	// Engine cube is 100 units wide and centered, keep its top face at Z = 0
+	FTransform GroundTransform(FRotator::ZeroRotator, FVector(0.f, 0.f, -50.f), FVector(GroundLength / 100.f, GroundWidth / 100.f, 1.f));
+	if (Scenario == ESBSkateScenario::Slope)
+	{
+		GroundTransform.SetRotation(FRotator(-SlopeAngle, 0.f, 0.f).Quaternion());
+	}
+	SpawnStaticMesh(CubeMesh, GroundTransform);
+
+	UStaticMesh* RampMesh = nullptr;
+	if (Scenario == ESBSkateScenario::Ramp)
+	{
+		RampMesh = LoadObject<UStaticMesh>(nullptr, RampMeshPath);
+	}
+
+	const float StartX = Scenario == ESBSkateScenario::Slope ? -GroundLength * 0.25f : 0.f;
+	for (int32 Index = 0; Index < SkaterCount; ++Index)
+	{
+		const float LaneY = (Index - SkaterCount * 0.5f) * LaneSpacing;
+
+		if (RampMesh != nullptr)
+		{
+			SpawnStaticMesh(RampMesh, FTransform(FVector(0.f, LaneY, 0.f)));
+		}
+
+		FVector GroundLocation;
+		if (FindGroundLocation(StartX, LaneY, GroundLocation) == false)
+		{
+			continue;
+		}
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		const float HalfHeight = GetDefault<ASBCharacter>()->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+		const FVector SpawnLocation = GroundLocation + FVector::UpVector * (HalfHeight + 5.f);
+		ASBCharacter* Skater = World->SpawnActor<ASBCharacter>(ASBCharacter::StaticClass(), SpawnLocation, FRotator::ZeroRotator, SpawnParameters);
+		if (Skater == nullptr)
+		{
+			continue;
+		}
+
+		USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+		MovementComponent->bRunPhysicsWithNoController = true;
+		MovementComponent->Velocity = InitialVelocity;
+		Skaters.Add(Skater);
+	}
+}
+
+void FSBSkateSimulationWorld::Tick(float DeltaTime)
+{
+	World->Tick(LEVELTICK_All, DeltaTime);
+	++GFrameCounter;
+}
+
+void FSBSkateSimulationWorld::SpawnStaticMesh(UStaticMesh* Mesh, const FTransform& Transform)
+{
+	if (Mesh == nullptr)
+	{
+		return;
+	}
+
+	AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), Transform);
+
+	// Mesh is assigned before registering, static components refuse mesh changes once the world has begun play
+	UStaticMeshComponent* MeshComponent = NewObject<UStaticMeshComponent>(Actor);
+	MeshComponent->SetMobility(EComponentMobility::Static);
+	MeshComponent->SetStaticMesh(Mesh);
+	MeshComponent->SetWorldTransform(Transform);
+	Actor->SetRootComponent(MeshComponent);
+	MeshComponent->RegisterComponent();
+}
+
+bool FSBSkateSimulationWorld::FindGroundLocation(float X, float Y, FVector& OutLocation) const
+{
+	FHitResult Hit;
+	const FVector Start(X, Y, 100000.f);
+	const FVector End(X, Y, -100000.f);
+	if (World->LineTraceSingleByChannel(Hit, Start, End, ECollisionChannel::ECC_Visibility) == false)
+	{
+		return false;
+	}
+
+	OutLocation = Hit.ImpactPoint;
+	return true;
+}
@@ -0,0 +1,47 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ASBCharacter;
+class UStaticMesh;
+class UWorld;
+
+/** Ground layouts the headless skate tools can simulate on */
+enum class ESBSkateScenario : uint8
+{
+	Flat,
+	Slope,
+	Ramp,
+};
+
+const TCHAR* LexToString(ESBSkateScenario Scenario);
+bool LexFromString(ESBSkateScenario& OutScenario, const TCHAR* String);
+
+/**
+ * Standalone game world without players or rendering, used by commandlets to simulate skaters headless.
+ * Skaters run their movement without a controller and are laid out in parallel lanes over the scenario ground.
+ */
+class FSBSkateSimulationWorld
+{
+public:
+	explicit FSBSkateSimulationWorld(ESBSkateScenario InScenario);
+	~FSBSkateSimulationWorld();
+
+	/** Builds the scenario ground and spawns the skaters already in skate mode */
+	void Populate(int32 SkaterCount, const FVector& InitialVelocity);
+
+	void Tick(float DeltaTime);
+
+	UWorld* GetWorld() const { return World; }
+	const TArray<ASBCharacter*>& GetSkaters() const { return Skaters; }
+
+private:
+	void SpawnStaticMesh(UStaticMesh* Mesh, const FTransform& Transform);
+	bool FindGroundLocation(float X, float Y, FVector& OutLocation) const;
+
+	ESBSkateScenario Scenario;
+	UWorld* World = nullptr;
+	TArray<ASBCharacter*> Skaters;
+};
@@ -0,0 +1,571 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateTuningCommandlet.h"
+
+#include "Components/CapsuleComponent.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SBSkateSimulationWorld.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSkateTuning, Log, All);
+
+namespace
+{
+	/** Largest grid a sweep accepts, keeps a typo in the step count from queuing a week of simulation */
+	constexpr int64 MaxConfigs = 100000;
+
+	/** Landing this soon after taking off counts as the ground flickering, not as a jump */
+	constexpr float FlickerAirTime = 0.1f;
+
+	/** Below the lowest ground or faster than anything a skater can reach, the configuration blew up */
+	constexpr float DivergedMinZ = -10000.f;
+	constexpr float DivergedSpeed = 100000.f;
+
+	/** Scripted input every lane of a sweep runs with */
+	enum class ESBTuningTrack : uint8
+	{
+		/** Rolls on the initial velocity only */
+		Coast,
+		/** Pushes every two seconds */
+		Push,
+		/** Pushes, carves left and right and ollies once the skater is up to speed */
+		Mixed,
+	};
+
+	bool LexFromString(ESBTuningTrack& OutTrack, const TCHAR* String)
+	{
+		const TPair<ESBTuningTrack, const TCHAR*> Tracks[] = {
+			{ESBTuningTrack::Coast, TEXT("Coast")},
+			{ESBTuningTrack::Push, TEXT("Push")},
+			{ESBTuningTrack::Mixed, TEXT("Mixed")},
+		};
+		for (const TPair<ESBTuningTrack, const TCHAR*>& Track : Tracks)
+		{
+			if (FCString::Stricmp(String, Track.Value) == 0)
+			{
+				OutTrack = Track.Key;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	struct FSBTuningInput
+	{
+		float Lean = 0.f;
+		bool bPush = false;
+		bool bJump = false;
+	};
+
+	FSBTuningInput SampleTrack(ESBTuningTrack Track, float Time, float DeltaTime)
+	{
+		FSBTuningInput Input;
+		if (Track == ESBTuningTrack::Coast)
+		{
+			return Input;
+		}
+
+		Input.bPush = FMath::Fmod(Time, 2.f) < 0.2f;
+		if (Track == ESBTuningTrack::Mixed)
+		{
+			// Straight for the first seconds so ramps are taken head on
+			if (Time >= 4.f)
+			{
+				Input.Lean = FMath::Fmod(Time, 4.f) < 2.f ? 1.f : -1.f;
+			}
+			Input.bJump = Time >= 5.f && FMath::Fmod(Time, 5.f) < DeltaTime;
+		}
+		return Input;
+	}
+
+	/** Numeric property of the skate movement component or the skater and the values it is swept over */
+	struct FSBTuningParameter
+	{
+		FString Name;
+		TArray<double> Values;
+		FNumericProperty* Property = nullptr;
+		bool bOnSkater = false;
+	};
+
+	bool ParseGrid(const FString& GridParam, TArray<FSBTuningParameter>& OutParameters)
+	{
+		TArray<FString> Entries;
+		GridParam.ParseIntoArray(Entries, TEXT(";"));
+		for (const FString& Entry : Entries)
+		{
+			FString Name;
+			FString ValuesText;
+			if (Entry.Split(TEXT("="), &Name, &ValuesText) == false)
+			{
+				UE_LOG(LogSkateTuning, Error, TEXT("Grid entry '%s' is not Name=Values"), *Entry);
+				return false;
+			}
+
+			FSBTuningParameter& Parameter = OutParameters.AddDefaulted_GetRef();
+			Parameter.Name = Name.TrimStartAndEnd();
+			Parameter.Property = FindFProperty<FNumericProperty>(USBCharacterMovementComponent::StaticClass(), *Parameter.Name);
+			if (Parameter.Property == nullptr)
+			{
+				Parameter.Property = FindFProperty<FNumericProperty>(ASBCharacter::StaticClass(), *Parameter.Name);
+				Parameter.bOnSkater = true;
+			}
+			if (Parameter.Property == nullptr || Parameter.Property->IsEnum())
+			{
+				UE_LOG(LogSkateTuning, Error, TEXT("'%s' is not a numeric property of the skate movement component or the skater"), *Parameter.Name);
+				return false;
+			}
+
+			TArray<FString> Range;
+			ValuesText.ParseIntoArray(Range, TEXT(":"));
+			if (Range.Num() == 3)
+			{
+				const double Min = FCString::Atod(*Range[0]);
+				const double Max = FCString::Atod(*Range[1]);
+				const int32 Steps = FMath::Max(1, FCString::Atoi(*Range[2]));
+				for (int32 Step = 0; Step < Steps; ++Step)
+				{
+					Parameter.Values.Add(Steps > 1 ? FMath::Lerp(Min, Max, static_cast<double>(Step) / (Steps - 1)) : Min);
+				}
+			}
+			else
+			{
+				TArray<FString> Values;
+				ValuesText.ParseIntoArray(Values, TEXT(","));
+				for (const FString& Value : Values)
+				{
+					Parameter.Values.Add(FCString::Atod(*Value));
+				}
+			}
+
+			if (Parameter.Values.Num() == 0)
+			{
+				UE_LOG(LogSkateTuning, Error, TEXT("Grid entry '%s' has no values"), *Entry);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int64 GetNumConfigs(const TArray<FSBTuningParameter>& Parameters)
+	{
+		int64 NumConfigs = 1;
+		for (const FSBTuningParameter& Parameter : Parameters)
+		{
+			NumConfigs *= Parameter.Values.Num();
+			if (NumConfigs > MaxConfigs)
+			{
+				break;
+			}
+		}
+		return NumConfigs;
+	}
+
+	/** Value of every parameter in a configuration, the last parameter changes fastest */
+	TArray<double, TInlineAllocator<8>> GetConfigValues(const TArray<FSBTuningParameter>& Parameters, int32 ConfigIndex)
+	{
+		TArray<double, TInlineAllocator<8>> Values;
+		Values.SetNum(Parameters.Num());
+		for (int32 Index = Parameters.Num() - 1; Index >= 0; --Index)
+		{
+			const int32 NumValues = Parameters[Index].Values.Num();
+			Values[Index] = Parameters[Index].Values[ConfigIndex % NumValues];
+			ConfigIndex /= NumValues;
+		}
+		return Values;
+	}
+
+	void ApplyConfig(ASBCharacter* Skater, const TArray<FSBTuningParameter>& Parameters, int32 ConfigIndex)
+	{
+		const TArray<double, TInlineAllocator<8>> Values = GetConfigValues(Parameters, ConfigIndex);
+		for (int32 Index = 0; Index < Parameters.Num(); ++Index)
+		{
+			const FSBTuningParameter& Parameter = Parameters[Index];
+			UObject* Target = Parameter.bOnSkater ? static_cast<UObject*>(Skater) : Skater->GetSkateMovementComponent();
+			void* Value = Parameter.Property->ContainerPtrToValuePtr<void>(Target);
+			if (Parameter.Property->IsFloatingPoint())
+			{
+				Parameter.Property->SetFloatingPointPropertyValue(Value, Values[Index]);
+			}
+			else
+			{
+				Parameter.Property->SetIntPropertyValue(Value, static_cast<int64>(FMath::RoundToDouble(Values[Index])));
+			}
+		}
+	}
+
+	/** Motion of one lane over a run, sampled once per frame */
+	struct FSBTuningMetrics
+	{
+		void Add(ASBCharacter* Skater, float DeltaTime)
+		{
+			if (bDiverged)
+			{
+				return;
+			}
+
+			const USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+			const FVector Location = Skater->GetActorLocation();
+			const FVector Velocity = MovementComponent->Velocity;
+			if (Location.ContainsNaN() || Velocity.ContainsNaN() || Location.Z < DivergedMinZ || Velocity.SizeSquared() > FMath::Square(DivergedSpeed))
+			{
+				bDiverged = true;
+				return;
+			}
+
+			TopSpeed = FMath::Max(TopSpeed, Velocity.Size());
+
+			const bool bGrounded = MovementComponent->GetIsGrounded();
+			if (bGrounded == false)
+			{
+				CurrentAirTime += DeltaTime;
+				AirTime += DeltaTime;
+				LongestAirTime = FMath::Max(LongestAirTime, CurrentAirTime);
+			}
+
+			if (bWasGrounded && bGrounded == false && bHasExit == false && Velocity.Z > 0.f)
+			{
+				// First time the board leaves the ground going up, the ramp lip in the Ramp scenario
+				ExitSpeed = Velocity.Size();
+				ExitVerticalSpeed = Velocity.Z;
+				bHasExit = true;
+			}
+			else if (bWasGrounded == false && bGrounded)
+			{
+				GroundFlickers += CurrentAirTime < FlickerAirTime ? 1 : 0;
+				CurrentAirTime = 0.f;
+			}
+
+			// Curved ramps turn the board smoothly, jitter is the change of the turn rate from one frame to the next
+			const FVector Up = Skater->GetActorUpVector();
+			if (bGrounded && bWasGrounded && bHasPreviousUp)
+			{
+				const float TurnRate = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Up.Dot(PreviousUp), -1.f, 1.f))) / DeltaTime;
+				if (bHasPreviousTurnRate)
+				{
+					JitterSquared += FMath::Square(TurnRate - PreviousTurnRate);
+					++JitterSamples;
+				}
+				PreviousTurnRate = TurnRate;
+				bHasPreviousTurnRate = true;
+			}
+			else
+			{
+				bHasPreviousTurnRate = false;
+			}
+
+			PreviousUp = Up;
+			bHasPreviousUp = true;
+			bWasGrounded = bGrounded;
+		}
+
+		float GetJitter() const
+		{
+			return JitterSamples > 0 ? FMath::Sqrt(JitterSquared / JitterSamples) : 0.f;
+		}
+
+		float TopSpeed = 0.f;
+		float AirTime = 0.f;
+		float LongestAirTime = 0.f;
+		float ExitSpeed = 0.f;
+		float ExitVerticalSpeed = 0.f;
+		int32 GroundFlickers = 0;
+		bool bDiverged = false;
+
+	private:
+		double JitterSquared = 0.0;
+		int32 JitterSamples = 0;
+		FVector PreviousUp = FVector::UpVector;
+		float PreviousTurnRate = 0.f;
+		float CurrentAirTime = 0.f;
+		bool bWasGrounded = true;
+		bool bHasPreviousUp = false;
+		bool bHasPreviousTurnRate = false;
+		bool bHasExit = false;
+	};
+
+	struct FSBTuningSettings
+	{
+		TArray<FSBTuningParameter> Parameters;
+		ESBSkateScenario Scenario = ESBSkateScenario::Ramp;
+		ESBTuningTrack Track = ESBTuningTrack::Mixed;
+		float Seconds = 20.f;
+		float DeltaTime = 1.f / 60.f;
+		float InitialSpeed = 600.f;
+		int32 LanesPerWorld = 32;
+	};
+
+	FString GetCsvHeader(const TArray<FSBTuningParameter>& Parameters)
+	{
+		FString Header = TEXT("Config");
+		for (const FSBTuningParameter& Parameter : Parameters)
+		{
+			Header += TEXT(",") + Parameter.Name;
+		}
+		return Header + TEXT(",TopSpeed,AirTime,LongestAirTime,ExitSpeed,ExitVerticalSpeed,GroundFlickers,JitterDegPerSecond,Diverged");
+	}
+
+	FString GetCsvRow(const TArray<FSBTuningParameter>& Parameters, int32 ConfigIndex, const FSBTuningMetrics& Metrics)
+	{
+		FString Row = FString::FromInt(ConfigIndex);
+		for (const double Value : GetConfigValues(Parameters, ConfigIndex))
+		{
+			Row += FString::Printf(TEXT(",%g"), Value);
+		}
+		return Row + FString::Printf(TEXT(",%.1f,%.3f,%.3f,%.1f,%.1f,%d,%.2f,%d"), Metrics.TopSpeed, Metrics.AirTime, Metrics.LongestAirTime,
+		                             Metrics.ExitSpeed, Metrics.ExitVerticalSpeed, Metrics.GroundFlickers, Metrics.GetJitter(), Metrics.bDiverged ? 1 : 0);
+	}
+
+	/** Runs every WorkerCount-th configuration starting at WorkerIndex, one lane per configuration */
+	bool RunConfigs(const FSBTuningSettings& Settings, int32 WorkerIndex, int32 WorkerCount, TArray<FString>& OutRows)
+	{
+		const int32 NumConfigs = static_cast<int32>(GetNumConfigs(Settings.Parameters));
+		TArray<int32> ConfigIndices;
+		for (int32 ConfigIndex = WorkerIndex; ConfigIndex < NumConfigs; ConfigIndex += WorkerCount)
+		{
+			ConfigIndices.Add(ConfigIndex);
+		}
+
+		const int32 Frames = FMath::CeilToInt32(Settings.Seconds / Settings.DeltaTime);
+		int32 NextConfig = 0;
+		bool bSentJump = false;
+		bool bAnyAirborne = false;
+		while (NextConfig < ConfigIndices.Num())
+		{
+			FSBSkateSimulationWorld SimulationWorld(Settings.Scenario);
+			SimulationWorld.Populate(FMath::Min(Settings.LanesPerWorld, ConfigIndices.Num() - NextConfig), FVector(Settings.InitialSpeed, 0.f, 0.f));
+
+			TArray<ASBCharacter*> Skaters = SimulationWorld.GetSkaters();
+			if (Skaters.Num() == 0)
+			{
+				UE_LOG(LogSkateTuning, Error, TEXT("No skater could be placed on the %s scenario"), LexToString(Settings.Scenario));
+				return false;
+			}
+
+			// Lanes are independent runs, skaters carving into the next lane don't bump into each other
+			for (int32 Lane = 0; Lane < Skaters.Num(); ++Lane)
+			{
+				Skaters[Lane]->GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
+				ApplyConfig(Skaters[Lane], Settings.Parameters, ConfigIndices[NextConfig + Lane]);
+			}
+
+			TArray<FSBTuningMetrics> Metrics;
+			Metrics.SetNum(Skaters.Num());
+			for (int32 Frame = 0; Frame < Frames; ++Frame)
+			{
+				const FSBTuningInput Input = SampleTrack(Settings.Track, Frame * Settings.DeltaTime, Settings.DeltaTime);
+				for (ASBCharacter* Skater : Skaters)
+				{
+					// Skaters have no controller, inputs go straight to the skate movement
+					USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+					MovementComponent->SetLeanInput(Input.Lean);
+					MovementComponent->SetWantsToPush(Input.bPush);
+					if (Input.bJump)
+					{
+						Skater->Jump();
+					}
+				}
+				bSentJump |= Input.bJump;
+
+				SimulationWorld.Tick(Settings.DeltaTime);
+
+				for (int32 Lane = 0; Lane < Skaters.Num(); ++Lane)
+				{
+					Metrics[Lane].Add(Skaters[Lane], Settings.DeltaTime);
+				}
+			}
+
+			for (int32 Lane = 0; Lane < Skaters.Num(); ++Lane)
+			{
+				OutRows.Add(GetCsvRow(Settings.Parameters, ConfigIndices[NextConfig + Lane], Metrics[Lane]));
+				bAnyAirborne |= Metrics[Lane].AirTime > 0.f;
+			}
+			NextConfig += Skaters.Num();
+
+			UE_LOG(LogSkateTuning, Display, TEXT("Worker %d: %d/%d configurations"), WorkerIndex, NextConfig, ConfigIndices.Num());
+		}
+
+		// Air time and exit speeds mean nothing if the jumps of the track never reached the skaters
+		if (Settings.Track == ESBTuningTrack::Mixed && bSentJump && bAnyAirborne == false)
+		{
+			UE_LOG(LogSkateTuning, Error, TEXT("Worker %d: no configuration left the ground on the Mixed track, the jumps were dropped"), WorkerIndex);
+			return false;
+		}
+		return true;
+	}
+
+	bool WriteCsv(const FString& Header, const TArray<FString>& Rows, const FString& OutputPath)
+	{
+		return FFileHelper::SaveStringToFile(Header + TEXT("\n") + FString::Join(Rows, TEXT("\n")) + TEXT("\n"), *OutputPath);
+	}
+
+	/** Starts the worker processes and merges their results ordered by configuration */
+	bool RunWorkers(const FString& Params, int32 WorkerCount, TArray<FString>& OutRows)
+	{
+		const FString Executable = FPlatformProcess::ExecutablePath();
+		const FString ProjectPath = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+		const FString WorkerDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("Tuning") / TEXT("Workers"));
+
+		TArray<FProcHandle> Processes;
+		TArray<FString> WorkerOutputs;
+		for (int32 WorkerIndex = 0; WorkerIndex < WorkerCount; ++WorkerIndex)
+		{
+			const FString WorkerOutput = WorkerDir / FString::Printf(TEXT("Worker%d.csv"), WorkerIndex);
+			const FString WorkerLog = WorkerDir / FString::Printf(TEXT("Worker%d.log"), WorkerIndex);
+			IFileManager::Get().Delete(*WorkerOutput, false, false, true);
+
+			// Workers get the sweep parameters as they are and write to their own file, the parent merges them
+			const FString WorkerParams = FString::Printf(TEXT("\"%s\" -run=SBSkateTuning %s -Worker -WorkerIndex=%d -WorkerCount=%d -WorkerOutput=\"%s\" -abslog=\"%s\" -nullrhi -unattended -nopause -nosplash"),
+			                                             *ProjectPath, *Params, WorkerIndex, WorkerCount, *WorkerOutput, *WorkerLog);
+
+			FProcHandle Process = FPlatformProcess::CreateProc(*Executable, *WorkerParams, false, true, true, nullptr, 0, nullptr, nullptr);
+			if (Process.IsValid() == false)
+			{
+				UE_LOG(LogSkateTuning, Error, TEXT("Failed to start tuning worker %d"), WorkerIndex);
+				for (FProcHandle& Started : Processes)
+				{
+					FPlatformProcess::TerminateProc(Started);
+					FPlatformProcess::CloseProc(Started);
+				}
+				return false;
+			}
+
+			Processes.Add(Process);
+			WorkerOutputs.Add(WorkerOutput);
+		}
+
+		UE_LOG(LogSkateTuning, Display, TEXT("Started %d tuning workers, logs in %s"), WorkerCount, *WorkerDir);
+
+		bool bSucceeded = true;
+		for (int32 WorkerIndex = 0; WorkerIndex < Processes.Num(); ++WorkerIndex)
+		{
+			FProcHandle& Process = Processes[WorkerIndex];
+			FPlatformProcess::WaitForProc(Process);
+
+			int32 ReturnCode = 0;
+			FPlatformProcess::GetProcReturnCode(Process, &ReturnCode);
+			FPlatformProcess::CloseProc(Process);
+
+			TArray<FString> Lines;
+			if (ReturnCode != 0 || FFileHelper::LoadFileToStringArray(Lines, *WorkerOutputs[WorkerIndex]) == false)
+			{
+				UE_LOG(LogSkateTuning, Error, TEXT("Tuning worker %d failed with code %d"), WorkerIndex, ReturnCode);
+				bSucceeded = false;
+				continue;
+			}
+
+			// First line is the header
+			for (int32 Line = 1; Line < Lines.Num(); ++Line)
+			{
+				if (Lines[Line].IsEmpty() == false)
+				{
+					OutRows.Add(MoveTemp(Lines[Line]));
+				}
+			}
+		}
+
+		OutRows.Sort([](const FString& A, const FString& B) { return FCString::Atoi(*A) < FCString::Atoi(*B); });
+		return bSucceeded;
+	}
+}
+
+USBSkateTuningCommandlet::USBSkateTuningCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 USBSkateTuningCommandlet::Main(const FString& Params)
+{
+	FSBTuningSettings Settings;
+
+	FString GridParam = TEXT("Friction=0.5,1,2;GroundGravity=500,1000,1500");
+	FParse::Value(*Params, TEXT("Grid="), GridParam, false);
+	if (ParseGrid(GridParam, Settings.Parameters) == false)
+	{
+		return 1;
+	}
+
+	FString ScenarioName = TEXT("Ramp");
+	FParse::Value(*Params, TEXT("Scenario="), ScenarioName);
+	if (LexFromString(Settings.Scenario, *ScenarioName) == false)
+	{
+		UE_LOG(LogSkateTuning, Error, TEXT("Unknown scenario '%s'"), *ScenarioName);
+		return 1;
+	}
+
+	FString TrackName = TEXT("Mixed");
+	FParse::Value(*Params, TEXT("Track="), TrackName);
+	if (LexFromString(Settings.Track, *TrackName) == false)
+	{
+		UE_LOG(LogSkateTuning, Error, TEXT("Unknown track '%s', expected Coast, Push or Mixed"), *TrackName);
+		return 1;
+	}
+
+	FParse::Value(*Params, TEXT("Seconds="), Settings.Seconds);
+	FParse::Value(*Params, TEXT("DeltaTime="), Settings.DeltaTime);
+	FParse::Value(*Params, TEXT("Speed="), Settings.InitialSpeed);
+	FParse::Value(*Params, TEXT("Lanes="), Settings.LanesPerWorld);
+	Settings.DeltaTime = FMath::Max(Settings.DeltaTime, 0.001f);
+	Settings.LanesPerWorld = FMath::Max(Settings.LanesPerWorld, 1);
+
+	const int64 NumConfigs = GetNumConfigs(Settings.Parameters);
+	if (NumConfigs > MaxConfigs)
+	{
+		UE_LOG(LogSkateTuning, Error, TEXT("Grid has more than %lld configurations"), MaxConfigs);
+		return 1;
+	}
+
+	const FString Header = GetCsvHeader(Settings.Parameters);
+	TArray<FString> Rows;
+
+	if (FParse::Param(*Params, TEXT("Worker")))
+	{
+		int32 WorkerIndex = 0;
+		int32 WorkerCount = 1;
+		FString WorkerOutput;
+		FParse::Value(*Params, TEXT("WorkerIndex="), WorkerIndex);
+		FParse::Value(*Params, TEXT("WorkerCount="), WorkerCount);
+		FParse::Value(*Params, TEXT("WorkerOutput="), WorkerOutput);
+
+		if (RunConfigs(Settings, WorkerIndex, FMath::Max(WorkerCount, 1), Rows) == false || WriteCsv(Header, Rows, WorkerOutput) == false)
+		{
+			return 1;
+		}
+		return 0;
+	}
+
+	// Worlds only tick on the game thread, so parallel runs are separate processes, each one a few lanes of configurations
+	int32 WorkerCount = FMath::Clamp(FPlatformMisc::NumberOfCores() - 1, 1, 16);
+	FParse::Value(*Params, TEXT("Workers="), WorkerCount);
+	WorkerCount = FMath::Clamp(WorkerCount, 1, static_cast<int32>(FMath::DivideAndRoundUp<int64>(NumConfigs, Settings.LanesPerWorld)));
+
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Tuning") / TEXT("SkateTuning.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	UE_LOG(LogSkateTuning, Display, TEXT("Sweeping %lld configurations on %s with the %s track, %d workers"), NumConfigs, LexToString(Settings.Scenario),
+	       *TrackName, WorkerCount);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bSucceeded = WorkerCount > 1 ? RunWorkers(Params, WorkerCount, Rows) : RunConfigs(Settings, 0, 1, Rows);
+	if (bSucceeded == false)
+	{
+		return 1;
+	}
+
+	if (WriteCsv(Header, Rows, OutputPath) == false)
+	{
+		UE_LOG(LogSkateTuning, Error, TEXT("Failed to write tuning results to %s"), *OutputPath);
+		return 1;
+	}
+
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogSkateTuning, Display, TEXT("%d configurations in %.1fs (%.1f per second), results written to %s"), Rows.Num(), Elapsed,
+	       Rows.Num() / FMath::Max(Elapsed, 0.001), *OutputPath);
+	return 0;
+}
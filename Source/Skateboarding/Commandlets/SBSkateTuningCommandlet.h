@@ -0,0 +1,27 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SBSkateTuningCommandlet.generated.h"
+
+/**
+ * Headless parameter sweep of the skate physics.
+ * Every configuration of the grid is one skater lane of a simulation world, driven by a scripted input track.
+ * The grid is split over worker processes running this commandlet, their results are merged into one CSV with
+ * top speed, air time, ramp exit velocity and stability metrics per configuration.
+ *
+ * Grid entries are numeric properties of the skate movement component or the skater, as a list or Min:Max:Steps:
+ * UnrealEditor-Cmd Skateboarding -run=SBSkateTuning -nullrhi -Grid="Friction=0.5,1,2;GroundGravity=500:1500:5;ImpulseForce=800,1000" -Scenario=Ramp -Track=Mixed -Seconds=20 -Workers=8
+ */
+UCLASS()
+class USBSkateTuningCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USBSkateTuningCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
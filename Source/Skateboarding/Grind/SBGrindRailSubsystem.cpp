@@ -0,0 +1,145 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBGrindRailSubsystem.h"
+
+#include "Components/SplineComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+const FName USBGrindRailSubsystem::GrindRailTag(TEXT("GrindRail"));
+
+void USBGrindRailSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	BuildRails();
+}
+
+void USBGrindRailSubsystem::Deinitialize()
+{
+	Rails.Reset();
+
+	Super::Deinitialize();
+}
+
+bool USBGrindRailSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USBGrindRailSubsystem::BuildRails()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	Rails.Reset();
+
+	TArray<TPair<FString, TArray<FVector>>> Sources;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		TInlineComponentArray<USceneComponent*> Components(*It);
+		for (USceneComponent* Component : Components)
+		{
+			if (const USplineComponent* Spline = Cast<USplineComponent>(Component))
+			{
+				if (Spline->ComponentHasTag(GrindRailTag) == false)
+				{
+					continue;
+				}
+
+				const float SplineLength = Spline->GetSplineLength();
+				const int32 NumSamples = FMath::Max(2, FMath::CeilToInt32(SplineLength / PointSpacing) + 1);
+				TArray<FVector>& Polyline = Sources.Emplace_GetRef(Spline->GetPathName(), TArray<FVector>()).Value;
+				for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+				{
+					Polyline.Add(Spline->GetLocationAtDistanceAlongSpline(SplineLength * Sample / (NumSamples - 1), ESplineCoordinateSpace::World));
+				}
+			}
+			else if (const UStaticMeshComponent* MeshComponent = Cast<UStaticMeshComponent>(Component))
+			{
+				if (IsGrindMesh(MeshComponent) == false)
+				{
+					continue;
+				}
+
+				TArray<TArray<FVector>> Polylines;
+				TraceMeshRails(MeshComponent, Polylines);
+				for (int32 Index = 0; Index < Polylines.Num(); ++Index)
+				{
+					Sources.Emplace(FString::Printf(TEXT("%s.%d"), *MeshComponent->GetPathName(), Index), MoveTemp(Polylines[Index]));
+				}
+			}
+		}
+	}
+
+	Sources.Sort([](const TPair<FString, TArray<FVector>>& A, const TPair<FString, TArray<FVector>>& B) { return A.Key < B.Key; });
+	for (const TPair<FString, TArray<FVector>>& Source : Sources)
+	{
+		Rails.AddRail(Source.Value, PointSpacing);
+	}
+	Rails.Build();
+
+	UE_CLOG(Rails.GetNumRails() > 0, LogSkateMovement, Log, TEXT("Built %d grind rails in %.1fms"), Rails.GetNumRails(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+bool USBGrindRailSubsystem::IsGrindMesh(const UStaticMeshComponent* Component) const
+{
+	const UStaticMesh* Mesh = Component->GetStaticMesh();
+	if (Mesh == nullptr || Component->IsQueryCollisionEnabled() == false)
+	{
+		return false;
+	}
+
+	if (Component->ComponentHasTag(GrindRailTag) || (Component->GetOwner() != nullptr && Component->GetOwner()->ActorHasTag(GrindRailTag)))
+	{
+		return true;
+	}
+
+	const FSoftObjectPath MeshPath(Mesh);
+	return GrindMeshes.ContainsByPredicate([&MeshPath](const TSoftObjectPtr<UStaticMesh>& GrindMesh) { return GrindMesh.ToSoftObjectPath() == MeshPath; });
+}
+
+void USBGrindRailSubsystem::TraceMeshRails(const UStaticMeshComponent* Component, TArray<TArray<FVector>>& OutPolylines) const
+{
+	const FBox LocalBounds = Component->GetStaticMesh()->GetBoundingBox();
+	const FVector Center = LocalBounds.GetCenter();
+	const FVector Extent = LocalBounds.GetExtent();
+	const FTransform& Transform = Component->GetComponentTransform();
+
+	// Rails run along the longest horizontal axis of the mesh, the traces follow its top along that axis
+	const bool bAlongX = Extent.X * Transform.GetScale3D().X >= Extent.Y * Transform.GetScale3D().Y;
+	const FVector Axis = bAlongX ? FVector::ForwardVector : FVector::RightVector;
+	const float HalfLength = bAlongX ? Extent.X : Extent.Y;
+	const float WorldLength = Transform.TransformVector(Axis * HalfLength * 2.f).Size();
+	const int32 NumTraces = FMath::Max(2, FMath::CeilToInt32(WorldLength / MeshTraceSpacing) + 1);
+
+	// Keep the end traces just inside the mesh so they don't miss its end caps
+	const float Inset = FMath::Min(1.f, HalfLength * 0.5f);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GrindRailBuild), true);
+
+	TArray<FVector>* Polyline = nullptr;
+	for (int32 Trace = 0; Trace < NumTraces; ++Trace)
+	{
+		const FVector Local = Center + Axis * FMath::Lerp(-HalfLength + Inset, HalfLength - Inset, static_cast<float>(Trace) / (NumTraces - 1));
+		const FVector Start = Transform.TransformPosition(FVector(Local.X, Local.Y, LocalBounds.Max.Z + 10.f));
+		const FVector End = Transform.TransformPosition(FVector(Local.X, Local.Y, LocalBounds.Min.Z - 10.f));
+
+		FHitResult Hit;
+		if (Component->LineTraceComponent(Hit, Start, End, QueryParams) == false)
+		{
+			// A gap splits the mesh into separate rails
+			Polyline = nullptr;
+			continue;
+		}
+
+		if (Polyline == nullptr)
+		{
+			Polyline = &OutPolylines.AddDefaulted_GetRef();
+		}
+		Polyline->Add(Hit.ImpactPoint);
+	}
+
+	OutPolylines.RemoveAll([](const TArray<FVector>& Points) { return Points.Num() < 2; });
+}
@@ -0,0 +1,53 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBGrindRails.h"
+#include "SBGrindRailSubsystem.generated.h"
+
+class UStaticMesh;
+class UStaticMeshComponent;
+
+/**
+ * Builds the grind rails of the world when it begins play. Spline components tagged GrindRail are rails as they are,
+ * static meshes listed in GrindMeshes (or tagged GrindRail) are traced once along their long axis to find their top edge.
+ * Rails are sorted by component path, so the server and its clients agree on the rail indices.
+ */
+UCLASS(Config = Game)
+class SKATEBOARDING_API USBGrindRailSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	const FSBGrindRails& GetRails() const { return Rails; }
+
+	static const FName GrindRailTag;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void BuildRails();
+	bool IsGrindMesh(const UStaticMeshComponent* Component) const;
+	/** Top edge of a mesh along its longest horizontal axis, one polyline per stretch the traces hit */
+	void TraceMeshRails(const UStaticMeshComponent* Component, TArray<TArray<FVector>>& OutPolylines) const;
+
+	/** Meshes that are rails wherever they are placed */
+	UPROPERTY(Config)
+	TArray<TSoftObjectPtr<UStaticMesh>> GrindMeshes;
+
+	/** Arc length between two points of the rail lookup tables */
+	UPROPERTY(Config)
+	float PointSpacing = 10.f;
+
+	/** Distance between the traces that find the top edge of a grind mesh */
+	UPROPERTY(Config)
+	float MeshTraceSpacing = 20.f;
+
+	FSBGrindRails Rails;
+};
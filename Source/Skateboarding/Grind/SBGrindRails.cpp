@@ -0,0 +1,192 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBGrindRails.h"
+
+namespace SBGrindRails
+{
+	constexpr int32 MaxLeafSegments = 4;
+}
+
+void FSBGrindRails::AddRail(TConstArrayView<FVector> Polyline, float PointSpacing)
+{
+	if (Polyline.Num() < 2 || PointSpacing <= 0.f)
+	{
+		return;
+	}
+
+	float Length = 0.f;
+	for (int32 Index = 1; Index < Polyline.Num(); ++Index)
+	{
+		Length += FVector::Dist(Polyline[Index - 1], Polyline[Index]);
+	}
+
+	if (Length <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	FSBGrindRail& Rail = Rails.AddDefaulted_GetRef();
+	const int32 RailIndex = Rails.Num() - 1;
+	const int32 NumSegments = FMath::Max(1, FMath::RoundToInt32(Length / PointSpacing));
+	Rail.FirstPoint = Points.Num();
+	Rail.NumPoints = NumSegments + 1;
+	Rail.Length = Length;
+	Rail.Spacing = Length / NumSegments;
+
+	// Walk the polyline once, emitting a point every Spacing of arc length
+	int32 PolylineSegment = 0;
+	float PolylineSegmentStart = 0.f;
+	float PolylineSegmentLength = FVector::Dist(Polyline[0], Polyline[1]);
+	for (int32 PointIndex = 0; PointIndex <= NumSegments; ++PointIndex)
+	{
+		const float Distance = PointIndex * Rail.Spacing;
+		while (Distance > PolylineSegmentStart + PolylineSegmentLength && PolylineSegment < Polyline.Num() - 2)
+		{
+			PolylineSegmentStart += PolylineSegmentLength;
+			++PolylineSegment;
+			PolylineSegmentLength = FVector::Dist(Polyline[PolylineSegment], Polyline[PolylineSegment + 1]);
+		}
+
+		const float Alpha = PolylineSegmentLength > UE_KINDA_SMALL_NUMBER ? FMath::Clamp((Distance - PolylineSegmentStart) / PolylineSegmentLength, 0.f, 1.f) : 0.f;
+		Points.Add(FVector3f(FMath::Lerp(Polyline[PolylineSegment], Polyline[PolylineSegment + 1], Alpha)));
+
+		if (PointIndex < NumSegments)
+		{
+			Segments.Add({RailIndex, Rail.FirstPoint + PointIndex});
+		}
+	}
+}
+
+void FSBGrindRails::Build()
+{
+	Nodes.Reset();
+	if (Segments.Num() > 0)
+	{
+		Nodes.Reserve(2 * FMath::DivideAndRoundUp(Segments.Num(), SBGrindRails::MaxLeafSegments));
+		BuildNode(0, Segments.Num());
+	}
+}
+
+void FSBGrindRails::Reset()
+{
+	Rails.Reset();
+	Points.Reset();
+	Segments.Reset();
+	Nodes.Reset();
+}
+
+FVector FSBGrindRails::GetLocation(int32 RailIndex, float Distance, FVector* OutTangent) const
+{
+	const FSBGrindRail& Rail = Rails[RailIndex];
+	const float Position = FMath::Clamp(Distance, 0.f, Rail.Length) / Rail.Spacing;
+	const int32 Segment = FMath::Min(FMath::FloorToInt32(Position), Rail.NumPoints - 2);
+	const FVector3f& Start = Points[Rail.FirstPoint + Segment];
+	const FVector3f& End = Points[Rail.FirstPoint + Segment + 1];
+
+	if (OutTangent != nullptr)
+	{
+		*OutTangent = FVector(End - Start).GetSafeNormal(UE_SMALL_NUMBER, FVector::ForwardVector);
+	}
+	return FVector(FMath::Lerp(Start, End, Position - Segment));
+}
+
+bool FSBGrindRails::FindClosestPoint(const FVector& Location, float Radius, FSBGrindRailPoint& OutPoint) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return false;
+	}
+
+	const FVector3f Query(Location);
+	float BestDistanceSquared = FMath::Square(Radius);
+	int32 BestSegment = INDEX_NONE;
+	float BestAlpha = 0.f;
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const int32 NodeIndex = Stack.Pop(false);
+		const FNode& Node = Nodes[NodeIndex];
+
+		const FVector3f Clamped(FMath::Clamp(Query.X, Node.Min.X, Node.Max.X), FMath::Clamp(Query.Y, Node.Min.Y, Node.Max.Y), FMath::Clamp(Query.Z, Node.Min.Z, Node.Max.Z));
+		if (FVector3f::DistSquared(Clamped, Query) > BestDistanceSquared)
+		{
+			continue;
+		}
+
+		if (Node.NumSegments == 0)
+		{
+			Stack.Add(Node.Index);
+			Stack.Add(NodeIndex + 1);
+			continue;
+		}
+
+		for (int32 SegmentIndex = Node.Index; SegmentIndex < Node.Index + Node.NumSegments; ++SegmentIndex)
+		{
+			const FVector3f& Start = Points[Segments[SegmentIndex].Point];
+			const FVector3f Direction = Points[Segments[SegmentIndex].Point + 1] - Start;
+			const float Alpha = FMath::Clamp((Query - Start).Dot(Direction) / FMath::Max(Direction.SizeSquared(), UE_SMALL_NUMBER), 0.f, 1.f);
+			const float DistanceSquared = FVector3f::DistSquared(Start + Direction * Alpha, Query);
+			if (DistanceSquared < BestDistanceSquared)
+			{
+				BestDistanceSquared = DistanceSquared;
+				BestSegment = SegmentIndex;
+				BestAlpha = Alpha;
+			}
+		}
+	}
+
+	if (BestSegment == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FSegment& Segment = Segments[BestSegment];
+	const FSBGrindRail& Rail = Rails[Segment.Rail];
+	OutPoint.Rail = Segment.Rail;
+	OutPoint.Distance = FMath::Min((Segment.Point - Rail.FirstPoint + BestAlpha) * Rail.Spacing, Rail.Length);
+	OutPoint.Location = GetLocation(Segment.Rail, OutPoint.Distance, &OutPoint.Tangent);
+	return true;
+}
+
+int32 FSBGrindRails::BuildNode(int32 Begin, int32 End)
+{
+	const int32 NodeIndex = Nodes.AddDefaulted();
+
+	FBox3f Bounds(ForceInit);
+	FBox3f CentroidBounds(ForceInit);
+	for (int32 Index = Begin; Index < End; ++Index)
+	{
+		const FVector3f& Start = Points[Segments[Index].Point];
+		const FVector3f& SegmentEnd = Points[Segments[Index].Point + 1];
+		Bounds += Start;
+		Bounds += SegmentEnd;
+		CentroidBounds += (Start + SegmentEnd) * 0.5f;
+	}
+	Nodes[NodeIndex].Min = Bounds.Min;
+	Nodes[NodeIndex].Max = Bounds.Max;
+
+	if (End - Begin <= SBGrindRails::MaxLeafSegments)
+	{
+		Nodes[NodeIndex].Index = Begin;
+		Nodes[NodeIndex].NumSegments = End - Begin;
+		return NodeIndex;
+	}
+
+	// Median split along the longest axis of the segment centers
+	const FVector3f CentroidExtent = CentroidBounds.GetSize();
+	const int32 Axis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z ? 0 : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+	MakeArrayView(Segments.GetData() + Begin, End - Begin).Sort([this, Axis](const FSegment& A, const FSegment& B)
+	{
+		return Points[A.Point][Axis] + Points[A.Point + 1][Axis] < Points[B.Point][Axis] + Points[B.Point + 1][Axis];
+	});
+
+	const int32 Middle = Begin + (End - Begin) / 2;
+	BuildNode(Begin, Middle);
+	const int32 SecondChild = BuildNode(Middle, End);
+	Nodes[NodeIndex].Index = SecondChild;
+	Nodes[NodeIndex].NumSegments = 0;
+	return NodeIndex;
+}
@@ -0,0 +1,74 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Rail resampled at a uniform arc length spacing, its points are a range of the rail set points */
+struct FSBGrindRail
+{
+	int32 FirstPoint = 0;
+	int32 NumPoints = 0;
+	float Length = 0.f;
+	/** Arc length between two consecutive points */
+	float Spacing = 0.f;
+};
+
+/** Closest point on a rail to a query location */
+struct FSBGrindRailPoint
+{
+	int32 Rail = INDEX_NONE;
+	/** Arc length from the start of the rail */
+	float Distance = 0.f;
+	FVector Location = FVector::ZeroVector;
+	FVector Tangent = FVector::ForwardVector;
+};
+
+/**
+ * Grind rails of a world as arc length lookup tables. Every rail segment is a leaf of a bounding volume hierarchy,
+ * so closest point queries only visit the nodes around the query. Following a rail is a table lookup.
+ * Built once, queries are const and can run on any thread.
+ */
+class SKATEBOARDING_API FSBGrindRails
+{
+public:
+	/** Resamples a polyline to the arc length spacing closest to PointSpacing and adds it as a rail */
+	void AddRail(TConstArrayView<FVector> Polyline, float PointSpacing);
+
+	/** Builds the hierarchy, call after the last rail was added */
+	void Build();
+	void Reset();
+
+	int32 GetNumRails() const { return Rails.Num(); }
+	const FSBGrindRail& GetRail(int32 Rail) const { return Rails[Rail]; }
+
+	/** Location and travel direction at an arc length, clamped to the rail */
+	FVector GetLocation(int32 Rail, float Distance, FVector* OutTangent = nullptr) const;
+
+	/** Closest point on any rail within Radius of Location, false if no rail is that close */
+	bool FindClosestPoint(const FVector& Location, float Radius, FSBGrindRailPoint& OutPoint) const;
+
+private:
+	struct FNode
+	{
+		FVector3f Min;
+		FVector3f Max;
+		/** Leaves index the segments, inner nodes their second child, the first child follows the node */
+		int32 Index = 0;
+		int32 NumSegments = 0;
+	};
+
+	/** Segment from a point of the point array to the next one */
+	struct FSegment
+	{
+		int32 Rail = 0;
+		int32 Point = 0;
+	};
+
+	int32 BuildNode(int32 Begin, int32 End);
+
+	TArray<FSBGrindRail> Rails;
+	TArray<FVector3f> Points;
+	TArray<FSegment> Segments;
+	TArray<FNode> Nodes;
+};
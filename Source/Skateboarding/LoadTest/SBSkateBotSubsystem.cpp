@@ -0,0 +1,197 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateBotSubsystem.h"
+
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/CommandLine.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+namespace
+{
+	FAutoConsoleCommandWithWorldAndArgs SetBotsCommand(
+		TEXT("sb.Bots"),
+		TEXT("Launches or stops load test bot processes up to a count, this process included. Usage: sb.Bots <Count>"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance = World != nullptr ? World->GetGameInstance() : nullptr;
+			USBSkateBotSubsystem* BotSubsystem = GameInstance != nullptr ? GameInstance->GetSubsystem<USBSkateBotSubsystem>() : nullptr;
+			if (BotSubsystem != nullptr && Args.Num() > 0)
+			{
+				BotSubsystem->SetNumBots(FCString::Atoi(*Args[0]));
+			}
+		}));
+
+	/** Whether Time is within the first Duration seconds of a Period */
+	bool IsPulse(float Time, float Period, float Duration)
+	{
+		return FMath::Fmod(Time, Period) < Duration;
+	}
+}
+
+void USBSkateBotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Launched bots only drive their own skater, the first bot launches the others
+	int32 BotIndex = 0;
+	int32 Count = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SkateBotIndex="), BotIndex))
+	{
+		bIsBot = true;
+		Bot.Pattern = static_cast<ESBSkateBotPattern>(BotIndex % static_cast<int32>(ESBSkateBotPattern::Num));
+		Bot.TimeOffset = BotIndex * 1.37f;
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("SkateBots="), Count))
+	{
+		SetNumBots(Count);
+	}
+}
+
+void USBSkateBotSubsystem::Deinitialize()
+{
+	for (FProcHandle& Process : BotProcesses)
+	{
+		FPlatformProcess::TerminateProc(Process, true);
+		FPlatformProcess::CloseProc(Process);
+	}
+	BotProcesses.Reset();
+
+	Super::Deinitialize();
+}
+
+void USBSkateBotSubsystem::Tick(float DeltaTime)
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	if (APlayerController* PlayerController = GameInstance->GetFirstLocalPlayerController(GameInstance->GetWorld()))
+	{
+		UpdateBot(PlayerController, DeltaTime);
+	}
+}
+
+ETickableTickType USBSkateBotSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USBSkateBotSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBSkateBotSubsystem, STATGROUP_Tickables);
+}
+
+void USBSkateBotSubsystem::SetNumBots(int32 Count)
+{
+	Count = FMath::Max(0, Count);
+	bIsBot = Count > 0;
+
+	if (BotParams.IsEmpty())
+	{
+		// Same map, server and options as this process, minus the switch that launches more bots
+		BotParams = FCommandLine::GetOriginal();
+		const int32 SwitchStart = BotParams.Find(TEXT("-SkateBots="));
+		if (SwitchStart != INDEX_NONE)
+		{
+			const int32 SwitchEnd = BotParams.Find(TEXT(" "), ESearchCase::CaseSensitive, ESearchDir::FromStart, SwitchStart);
+			BotParams.RemoveAt(SwitchStart, (SwitchEnd != INDEX_NONE ? SwitchEnd : BotParams.Len()) - SwitchStart);
+		}
+	}
+
+	for (int32 Index = BotProcesses.Num() - 1; Index >= 0; --Index)
+	{
+		if (FPlatformProcess::IsProcRunning(BotProcesses[Index]) == false)
+		{
+			FPlatformProcess::CloseProc(BotProcesses[Index]);
+			BotProcesses.RemoveAt(Index);
+		}
+	}
+
+	// This process is the first bot
+	const int32 NumProcesses = FMath::Max(0, Count - 1);
+	while (BotProcesses.Num() > NumProcesses)
+	{
+		FProcHandle Process = BotProcesses.Pop();
+		FPlatformProcess::TerminateProc(Process, true);
+		FPlatformProcess::CloseProc(Process);
+	}
+
+	while (BotProcesses.Num() < NumProcesses)
+	{
+		if (LaunchBot(BotProcesses.Num() + 1) == false)
+		{
+			break;
+		}
+	}
+}
+
+bool USBSkateBotSubsystem::LaunchBot(int32 BotIndex)
+{
+	const FString Params = FString::Printf(TEXT("%s -SkateBotIndex=%d"), *BotParams, BotIndex);
+	FProcHandle Process = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Params, false, true, true, nullptr, 0, nullptr, nullptr);
+	if (Process.IsValid() == false)
+	{
+		UE_LOG(LogSkateMovement, Warning, TEXT("Stopped launching skate bots at %d, failed to start a bot process"), BotIndex);
+		return false;
+	}
+
+	BotProcesses.Add(Process);
+	return true;
+}
+
+void USBSkateBotSubsystem::UpdateBot(APlayerController* PlayerController, float DeltaTime)
+{
+	ASBCharacter* Skater = Cast<ASBCharacter>(PlayerController->GetPawn());
+	if (Skater == nullptr)
+	{
+		return;
+	}
+
+	Bot.Time += DeltaTime;
+	const float Time = Bot.Time + Bot.TimeOffset;
+
+	float Lean = 0.f;
+	bool bPush = false;
+	bool bBrake = false;
+	bool bJump = false;
+	switch (Bot.Pattern)
+	{
+	case ESBSkateBotPattern::Cruise:
+		bPush = IsPulse(Time, 2.f, 0.2f);
+		break;
+	case ESBSkateBotPattern::Slalom:
+		Lean = FMath::Sin(Time * 1.5f);
+		bPush = IsPulse(Time, 3.f, 0.2f);
+		break;
+	case ESBSkateBotPattern::Jumps:
+		bPush = IsPulse(Time, 2.f, 0.2f);
+		bJump = IsPulse(Time, 4.f, 0.1f);
+		break;
+	case ESBSkateBotPattern::Mixed:
+		Lean = FMath::Sin(Time * 0.7f) * 0.6f;
+		bPush = IsPulse(Time, 2.5f, 0.2f);
+		bBrake = IsPulse(Time + 5.f, 10.f, 0.5f);
+		bJump = IsPulse(Time, 5.f, 0.1f);
+		break;
+	default:
+		break;
+	}
+
+	// Skate movement keeps only the sign of the lean
+	Skater->SetSkateInput(FMath::RoundToFloat(Lean), bPush, bBrake);
+
+	if (bJump != Bot.bJumping)
+	{
+		Bot.bJumping = bJump;
+		if (bJump)
+		{
+			Skater->Jump();
+		}
+		else
+		{
+			Skater->StopJumping();
+		}
+	}
+}
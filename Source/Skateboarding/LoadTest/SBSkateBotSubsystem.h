@@ -0,0 +1,70 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "SBSkateBotSubsystem.generated.h"
+
+class APlayerController;
+
+/** Scripted input a bot repeats, bots are assigned patterns in order */
+enum class ESBSkateBotPattern : uint8
+{
+	/** Pushes to speed and rolls straight */
+	Cruise,
+	/** Leans from side to side while pushing */
+	Slalom,
+	/** Ollies at a steady pace */
+	Jumps,
+	/** Leans, brakes and jumps out of step with each other */
+	Mixed,
+
+	Num
+};
+
+/**
+ * Turns a client into a load test bot that drives its skater with a scripted pattern.
+ * Every bot is its own process with its own connection to the server, so the server sees one connection per skater.
+ * -SkateBots=<N> makes this process the first bot and launches N - 1 more with the same command line:
+ * Skateboarding 127.0.0.1 -game -nullrhi -SkateBots=8
+ */
+UCLASS()
+class SKATEBOARDING_API USBSkateBotSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return bIsBot; }
+	virtual TStatId GetStatId() const override;
+
+	/** Launches or stops bot processes until there are Count bots, this process included */
+	void SetNumBots(int32 Count);
+
+private:
+	struct FBotState
+	{
+		ESBSkateBotPattern Pattern = ESBSkateBotPattern::Cruise;
+		/** Desynchronizes the bots running the same pattern */
+		float TimeOffset = 0.f;
+		float Time = 0.f;
+		bool bJumping = false;
+	};
+
+	void UpdateBot(APlayerController* PlayerController, float DeltaTime);
+	bool LaunchBot(int32 BotIndex);
+
+	bool bIsBot = false;
+	FBotState Bot;
+
+	/** Bots launched by this process, terminated with it */
+	TArray<FProcHandle> BotProcesses;
+	/** Command line of the launched bots, the one of this process without -SkateBots */
+	FString BotParams;
+};
@@ -0,0 +1,187 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateLoadReportSubsystem.h"
+
+#include "Engine/ChildConnection.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+namespace
+{
+	TAutoConsoleVariable<float> CVarLoadTestReportInterval(
+		TEXT("sb.LoadTest.ReportInterval"),
+		0.f,
+		TEXT("Seconds between server load test reports, 0 disables them"));
+}
+
+void USBSkateLoadReportSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	float Interval = 0.f;
+	if (FParse::Value(FCommandLine::Get(), TEXT("SkateLoadReport="), Interval))
+	{
+		CVarLoadTestReportInterval->Set(Interval, ECVF_SetByCommandline);
+	}
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &USBSkateLoadReportSubsystem::OnWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &USBSkateLoadReportSubsystem::OnWorldPostActorTick);
+}
+
+void USBSkateLoadReportSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::Deinitialize();
+}
+
+void USBSkateLoadReportSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const float Interval = CVarLoadTestReportInterval.GetValueOnGameThread();
+	if (Interval <= 0.f || GetWorld()->GetNetMode() == NM_Client || GetWorld()->GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	ReportAccumulator += DeltaTime;
+	if (ReportAccumulator >= Interval)
+	{
+		ReportAccumulator = 0.f;
+		WriteReport();
+	}
+}
+
+TStatId USBSkateLoadReportSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBSkateLoadReportSubsystem, STATGROUP_Tickables);
+}
+
+bool USBSkateLoadReportSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USBSkateLoadReportSubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaTime)
+{
+	if (InWorld == GetWorld())
+	{
+		TickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void USBSkateLoadReportSubsystem::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaTime)
+{
+	if (InWorld == GetWorld() && TickStartTime > 0.0)
+	{
+		const double TickTime = FPlatformTime::Seconds() - TickStartTime;
+		TickTimeSum += TickTime;
+		TickTimeMax = FMath::Max(TickTimeMax, TickTime);
+		++NumTicks;
+	}
+}
+
+void USBSkateLoadReportSubsystem::WriteReport()
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (NetDriver == nullptr)
+	{
+		return;
+	}
+
+	if (ReportFilename.IsEmpty())
+	{
+		StartTime = FPlatformTime::Seconds();
+		ReportFilename = FPaths::ProjectSavedDir() / TEXT("LoadTest") / FString::Printf(TEXT("Server_%s.csv"), *FDateTime::Now().ToString());
+		FFileHelper::SaveStringToFile(TEXT("Time,TickAvgMs,TickMaxMs,Connection,Skaters,InBytesPerSecond,OutBytesPerSecond,Corrections\n"), *ReportFilename);
+	}
+
+	const double Time = FPlatformTime::Seconds() - StartTime;
+	const double TickAvgMs = NumTicks > 0 ? TickTimeSum * 1000.0 / NumTicks : 0.0;
+	const double TickMaxMs = TickTimeMax * 1000.0;
+	TickTimeSum = 0.0;
+	TickTimeMax = 0.0;
+	NumTicks = 0;
+
+	FString Csv;
+	int32 TotalSkaters = 0;
+	int64 TotalOutBytesPerSecond = 0;
+	uint32 TotalCorrections = 0;
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection == nullptr)
+		{
+			continue;
+		}
+
+		int32 Skaters = 0;
+		uint32 Corrections = 0;
+		GetConnectionSkaters(Connection, Skaters, Corrections);
+
+		// Counters only grow, report what the connection got since the last report
+		uint32& LastConnectionCorrections = LastCorrections.FindOrAdd(Connection);
+		const uint32 NewCorrections = Corrections - FMath::Min(Corrections, LastConnectionCorrections);
+		LastConnectionCorrections = Corrections;
+
+		Csv += FString::Printf(TEXT("%.1f,%.3f,%.3f,%s,%d,%d,%d,%u\n"), Time, TickAvgMs, TickMaxMs, *Connection->LowLevelGetRemoteAddress(true), Skaters,
+		                       Connection->InBytesPerSecond, Connection->OutBytesPerSecond, NewCorrections);
+
+		TotalSkaters += Skaters;
+		TotalOutBytesPerSecond += Connection->OutBytesPerSecond;
+		TotalCorrections += NewCorrections;
+	}
+
+	for (auto It = LastCorrections.CreateIterator(); It; ++It)
+	{
+		if (It.Key().IsValid() == false)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (Csv.IsEmpty() == false)
+	{
+		FFileHelper::SaveStringToFile(Csv, *ReportFilename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+	}
+
+	const int32 NumConnections = NetDriver->ClientConnections.Num();
+	UE_LOG(LogSkateMovement, Display, TEXT("Load test: tick avg %.2fms max %.2fms | %d connections, %d skaters | out %.1f KB/s total, %.1f KB/s per connection | %u corrections"),
+	       TickAvgMs, TickMaxMs, NumConnections, TotalSkaters, TotalOutBytesPerSecond / 1024.0,
+	       NumConnections > 0 ? TotalOutBytesPerSecond / 1024.0 / NumConnections : 0.0, TotalCorrections);
+}
+
+void USBSkateLoadReportSubsystem::GetConnectionSkaters(UNetConnection* Connection, int32& OutSkaters, uint32& OutCorrections) const
+{
+	OutSkaters = 0;
+	OutCorrections = 0;
+
+	auto AddController = [&OutSkaters, &OutCorrections](const APlayerController* PlayerController)
+	{
+		ASBCharacter* Skater = PlayerController != nullptr ? Cast<ASBCharacter>(PlayerController->GetPawn()) : nullptr;
+		if (Skater != nullptr)
+		{
+			++OutSkaters;
+			OutCorrections += Skater->GetSkateMovementComponent()->GetNumClientCorrections();
+		}
+	};
+
+	AddController(Connection->PlayerController);
+	for (const UChildConnection* Child : Connection->Children)
+	{
+		if (Child != nullptr)
+		{
+			AddController(Child->PlayerController);
+		}
+	}
+}
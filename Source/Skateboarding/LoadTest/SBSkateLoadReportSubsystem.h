@@ -0,0 +1,53 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBSkateLoadReportSubsystem.generated.h"
+
+class UNetConnection;
+
+/**
+ * Server side of the load test. Every sb.LoadTest.ReportInterval seconds it logs the world tick time and, per client
+ * connection, the bandwidth, skaters and skate corrections sent, and appends them to Saved/LoadTest.
+ */
+UCLASS()
+class SKATEBOARDING_API USBSkateLoadReportSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaTime);
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaTime);
+
+	void WriteReport();
+	/** Skaters of a connection and its split screen children, and the corrections sent to them */
+	void GetConnectionSkaters(UNetConnection* Connection, int32& OutSkaters, uint32& OutCorrections) const;
+
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle PostActorTickHandle;
+
+	double TickStartTime = 0.0;
+	/** World tick work since the last report, without the wait for the next frame */
+	double TickTimeSum = 0.0;
+	double TickTimeMax = 0.0;
+	int32 NumTicks = 0;
+
+	float ReportAccumulator = 0.f;
+	double StartTime = 0.0;
+	FString ReportFilename;
+
+	/** Corrections of each connection at the last report */
+	TMap<TWeakObjectPtr<UNetConnection>, uint32> LastCorrections;
+};
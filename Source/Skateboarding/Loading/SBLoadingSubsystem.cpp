@@ -0,0 +1,185 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBLoadingSubsystem.h"
+
+#include "CoreGlobals.h"
+#include "Engine/AssetManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "TimerManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogSkateLoading, Log, All);
+
+const FName USBLoadingSubsystem::GameBundle(TEXT("Game"));
+
+namespace
+{
+	TAutoConsoleVariable<float> CVarStartupBudget(
+		TEXT("sb.Startup.Budget"),
+		20.f,
+		TEXT("Seconds from process start or map travel to the first controllable frame before the load is reported over budget"));
+}
+
+void USBLoadingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Process start is the beginning of the first load
+	LoadStartTime = GStartTime;
+	MarkPhase(TEXT("GameInstance"));
+
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &USBLoadingSubsystem::OnPreLoadMap);
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &USBLoadingSubsystem::OnPostLoadMap);
+
+	if (PreloadAssets.Num() > 0 && UAssetManager::IsInitialized())
+	{
+		LoadPrimaryAssets(PreloadAssets, TEXT("Preload"), FSimpleDelegate());
+	}
+}
+
+void USBLoadingSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	Handles.Reset();
+
+	Super::Deinitialize();
+}
+
+void USBLoadingSubsystem::LoadPrimaryAssets(const TArray<FPrimaryAssetId>& AssetIds, FName Phase, FSimpleDelegate OnLoaded)
+{
+	UAssetManager& AssetManager = UAssetManager::Get();
+
+	TArray<FPrimaryAssetId> KnownIds;
+	for (const FPrimaryAssetId& AssetId : AssetIds)
+	{
+		if (AssetId.IsValid() == false)
+		{
+			continue;
+		}
+
+		if (AssetManager.GetPrimaryAssetPath(AssetId).IsValid())
+		{
+			KnownIds.Add(AssetId);
+		}
+		else
+		{
+			UE_LOG(LogSkateLoading, Log, TEXT("%s: no primary asset %s, loading without it"), *Phase.ToString(), *AssetId.ToString());
+		}
+	}
+
+	if (KnownIds.Num() == 0)
+	{
+		OnLoaded.ExecuteIfBound();
+		return;
+	}
+
+	// Assets that are already loaded may complete without a handle, the callback runs once either way
+	const TSharedRef<bool> bCompleted = MakeShared<bool>(false);
+	const FStreamableDelegate OnHandleLoaded = FStreamableDelegate::CreateWeakLambda(this, [this, Phase, OnLoaded, bCompleted]()
+	{
+		if (*bCompleted == false)
+		{
+			*bCompleted = true;
+			MarkPhase(Phase);
+			OnLoaded.ExecuteIfBound();
+		}
+	});
+
+	const TSharedPtr<FStreamableHandle> Handle = AssetManager.LoadPrimaryAssets(KnownIds, {GameBundle}, OnHandleLoaded, FStreamableManager::AsyncLoadHighPriority);
+	if (Handle.IsValid() == false)
+	{
+		OnHandleLoaded.Execute();
+		return;
+	}
+
+	for (const FPrimaryAssetId& AssetId : KnownIds)
+	{
+		Handles.Add(AssetId, Handle);
+	}
+}
+
+void USBLoadingSubsystem::MarkPhase(FName Phase)
+{
+	if (bReportPending)
+	{
+		Phases.Add({Phase, FPlatformTime::Seconds() - LoadStartTime});
+	}
+}
+
+void USBLoadingSubsystem::NotifyControllable(APlayerController* PlayerController)
+{
+	if (bReportPending == false || PlayerController == nullptr || PlayerController->GetWorld() == nullptr)
+	{
+		return;
+	}
+
+	MarkPhase(TEXT("Possessed"));
+	PlayerController->GetWorld()->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(this, [this]()
+	{
+		MarkPhase(TEXT("FirstControllableFrame"));
+		WriteReport();
+	}));
+}
+
+void USBLoadingSubsystem::OnPreLoadMap(const FString& MapName)
+{
+	// The first map load belongs to the startup
+	if (bStartup == false)
+	{
+		LoadStartTime = FPlatformTime::Seconds();
+		Phases.Reset();
+	}
+	LoadMapName = FPackageName::GetShortName(MapName);
+	bReportPending = true;
+}
+
+void USBLoadingSubsystem::OnPostLoadMap(UWorld* World)
+{
+	MarkPhase(TEXT("MapLoaded"));
+}
+
+void USBLoadingSubsystem::WriteReport()
+{
+	if (bReportPending == false || Phases.Num() == 0)
+	{
+		return;
+	}
+	bReportPending = false;
+
+	const TCHAR* Kind = bStartup ? TEXT("Startup") : TEXT("MapLoad");
+	const double Total = Phases.Last().Time;
+	const float Budget = CVarStartupBudget.GetValueOnGameThread();
+	bStartup = false;
+
+	FString PhaseText;
+	FString Csv;
+	const FString Date = FDateTime::Now().ToString();
+	for (const FSBLoadingPhase& Phase : Phases)
+	{
+		PhaseText += FString::Printf(TEXT(" %s %.2fs"), *Phase.Name.ToString(), Phase.Time);
+		Csv += FString::Printf(TEXT("%s,%s,%s,%s,%.3f\n"), *Date, *LoadMapName, Kind, *Phase.Name.ToString(), Phase.Time);
+	}
+
+	if (Total > Budget)
+	{
+		UE_LOG(LogSkateLoading, Warning, TEXT("%s of %s took %.2fs, over the %.1fs budget:%s"), Kind, *LoadMapName, Total, Budget, *PhaseText);
+	}
+	else
+	{
+		UE_LOG(LogSkateLoading, Display, TEXT("%s of %s took %.2fs:%s"), Kind, *LoadMapName, Total, *PhaseText);
+	}
+
+	// One row per phase, appended so kiosks keep a history across runs
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("Startup") / TEXT("StartupTimings.csv");
+	if (IFileManager::Get().FileExists(*Filename) == false)
+	{
+		Csv = TEXT("Date,Map,Kind,Phase,Seconds\n") + Csv;
+	}
+	FFileHelper::SaveStringToFile(Csv, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
@@ -0,0 +1,66 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "SBLoadingSubsystem.generated.h"
+
+class APlayerController;
+struct FStreamableHandle;
+
+/** Time of a startup or map load phase, in seconds since the load started */
+struct FSBLoadingPhase
+{
+	FName Name;
+	double Time = 0.0;
+};
+
+/**
+ * Loads primary assets with the Game bundle and keeps them loaded for the lifetime of the game instance,
+ * so a map reload finds the skater and park content in memory. PreloadAssets start loading with the game instance,
+ * alongside the first map.
+ *
+ * Also times every load, from process start or the map travel to the first frame a local player controls a pawn,
+ * and reports it against sb.Startup.Budget to the log and Saved/Startup/StartupTimings.csv.
+ */
+UCLASS(Config = Game)
+class SKATEBOARDING_API USBLoadingSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Loads the Game bundle of the assets and marks Phase when done, OnLoaded runs right away for loaded or unknown assets */
+	void LoadPrimaryAssets(const TArray<FPrimaryAssetId>& AssetIds, FName Phase, FSimpleDelegate OnLoaded);
+
+	/** Records a phase of the current load */
+	void MarkPhase(FName Phase);
+	/** Reports the current load on the next frame, the first frame a local player acts on its pawn */
+	void NotifyControllable(APlayerController* PlayerController);
+
+	static const FName GameBundle;
+
+private:
+	void OnPreLoadMap(const FString& MapName);
+	void OnPostLoadMap(UWorld* World);
+	void WriteReport();
+
+	/** Loaded as soon as the game instance starts */
+	UPROPERTY(Config)
+	TArray<FPrimaryAssetId> PreloadAssets;
+
+	TMap<FPrimaryAssetId, TSharedPtr<FStreamableHandle>> Handles;
+
+	/** FPlatformTime::Seconds of the start of the current load, GStartTime for the first map */
+	double LoadStartTime = 0.0;
+	FString LoadMapName;
+	bool bStartup = true;
+	bool bReportPending = true;
+	TArray<FSBLoadingPhase> Phases;
+
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle PostLoadMapHandle;
+};
@@ -0,0 +1,20 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBParkDefinition.h"
+
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+
+const FPrimaryAssetType USBParkDefinition::PrimaryAssetType(TEXT("ParkDefinition"));
+
+FPrimaryAssetId USBParkDefinition::GetPrimaryAssetId() const
+{
+	const FString MapName = Map.IsNull() ? GetName() : Map.GetAssetName();
+	return GetParkId(MapName);
+}
+
+FPrimaryAssetId USBParkDefinition::GetParkId(const FString& MapName)
+{
+	return FPrimaryAssetId(PrimaryAssetType, FName(FPackageName::GetShortName(UWorld::RemovePIEPrefix(MapName))));
+}
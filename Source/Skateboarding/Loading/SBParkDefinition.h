@@ -0,0 +1,32 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SBParkDefinition.generated.h"
+
+/**
+ * Content a park map needs before anyone can skate it, loaded with the Game bundle while the map is loading.
+ * The asset is named after its map, the game mode finds the definition of the current map by that name.
+ */
+UCLASS(BlueprintType)
+class SKATEBOARDING_API USBParkDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Park")
+	TSoftObjectPtr<UWorld> Map;
+
+	/** Surface table, obstacles and anything else spawned or looked up at runtime instead of placed in the map */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Park", meta = (AssetBundles = "Game"))
+	TArray<TSoftObjectPtr<UObject>> Content;
+
+	/** Definition of a map, whether or not an asset exists for it */
+	static FPrimaryAssetId GetParkId(const FString& MapName);
+
+	static const FPrimaryAssetType PrimaryAssetType;
+};
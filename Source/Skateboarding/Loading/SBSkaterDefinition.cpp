@@ -0,0 +1,11 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkaterDefinition.h"
+
+const FPrimaryAssetType USBSkaterDefinition::PrimaryAssetType(TEXT("SkaterDefinition"));
+
+FPrimaryAssetId USBSkaterDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
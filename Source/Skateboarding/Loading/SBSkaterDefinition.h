@@ -0,0 +1,37 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SBSkaterDefinition.generated.h"
+
+class APawn;
+class UInputMappingContext;
+class UStaticMesh;
+
+/**
+ * A skater the players can spawn as: its pawn, board and controls. Everything is referenced softly and loaded
+ * with the Game bundle during the loading phase, so nothing of the skater is pulled in by the game mode class.
+ */
+UCLASS(BlueprintType)
+class SKATEBOARDING_API USBSkaterDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Skater", meta = (AssetBundles = "Game"))
+	TSoftClassPtr<APawn> PawnClass;
+
+	/** Replaces the board of the pawn class when set */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Skater", meta = (AssetBundles = "Game"))
+	TSoftObjectPtr<UStaticMesh> SkateboardMesh;
+
+	/** Replaces the mapping context of the pawn class when set */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Skater", meta = (AssetBundles = "Game"))
+	TSoftObjectPtr<UInputMappingContext> MappingContext;
+
+	static const FPrimaryAssetType PrimaryAssetType;
+};
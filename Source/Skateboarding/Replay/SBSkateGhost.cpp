@@ -0,0 +1,83 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateGhost.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Skateboarding/SBCharacter.h"
+
+ASBSkateGhost::ASBSkateGhost()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	Mesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("Mesh"));
+	Mesh->SetupAttachment(RootComponent);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetGenerateOverlapEvents(false);
+	Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+
+	SkateboardMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("SkateboardMesh"));
+	SkateboardMesh->SetupAttachment(RootComponent);
+	SkateboardMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SkateboardMesh->SetGenerateOverlapEvents(false);
+}
+
+void ASBSkateGhost::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	PlaybackTime += DeltaSeconds * PlaybackRate;
+	if (bLoop && PlaybackTime > GetDuration())
+	{
+		PlaybackTime = 0.f;
+	}
+
+	ApplyFrame();
+}
+
+bool ASBSkateGhost::Play(const FString& Filename, float StartTime, const ASBCharacter* Appearance)
+{
+	if (Reader.Open(Filename) == false)
+	{
+		SetActorTickEnabled(false);
+		return false;
+	}
+
+	// Recorded transforms are the capsule ones, keep the mesh offsets of the skater relative to its capsule
+	if (Appearance != nullptr)
+	{
+		Mesh->SetSkeletalMesh(Appearance->GetMesh()->GetSkeletalMeshAsset());
+		Mesh->SetRelativeTransform(Appearance->GetMesh()->GetRelativeTransform());
+		// Ghost has no skate movement to read, the skater anim blueprint falls back to its idle skating pose instead of the ref pose
+		if (UClass* AnimClass = Appearance->GetMesh()->GetAnimClass())
+		{
+			Mesh->SetAnimInstanceClass(AnimClass);
+		}
+
+		SkateboardMesh->SetStaticMesh(Appearance->SkateboardStaticMesh->GetStaticMesh());
+		SkateboardMesh->SetRelativeTransform(Appearance->SkateboardStaticMesh->GetRelativeTransform());
+	}
+
+	Seek(StartTime);
+	SetActorTickEnabled(true);
+	return true;
+}
+
+void ASBSkateGhost::Seek(float Time)
+{
+	PlaybackTime = FMath::Clamp(Time, 0.f, GetDuration());
+	ApplyFrame();
+}
+
+void ASBSkateGhost::ApplyFrame()
+{
+	FSBSkateReplayFrame Frame;
+	if (Reader.Sample(PlaybackTime, Frame))
+	{
+		SetActorLocationAndRotation(Frame.Location, Frame.Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+}
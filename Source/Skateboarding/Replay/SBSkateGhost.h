@@ -0,0 +1,51 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SBSkateReplay.h"
+#include "SBSkateGhost.generated.h"
+
+class ASBCharacter;
+class USkeletalMeshComponent;
+class UStaticMeshComponent;
+
+/**
+ * Plays a skate replay back by interpolating the recorded frames, nothing is simulated and nothing collides
+ */
+UCLASS(NotPlaceable)
+class SKATEBOARDING_API ASBSkateGhost : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ASBSkateGhost();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	/** Starts playing a replay file, the ghost copies the meshes of the appearance skater if one is given */
+	bool Play(const FString& Filename, float StartTime = 0.f, const ASBCharacter* Appearance = nullptr);
+	void Seek(float Time);
+
+	float GetPlaybackTime() const { return PlaybackTime; }
+	float GetDuration() const { return Reader.GetDuration(); }
+
+	UPROPERTY(EditAnywhere, Category = "Replay")
+	float PlaybackRate = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Replay")
+	bool bLoop = true;
+
+private:
+	void ApplyFrame();
+
+	UPROPERTY(VisibleAnywhere, Category = "Replay")
+	USkeletalMeshComponent* Mesh;
+
+	UPROPERTY(VisibleAnywhere, Category = "Replay")
+	UStaticMeshComponent* SkateboardMesh;
+
+	FSBSkateReplayReader Reader;
+	float PlaybackTime = 0.f;
+};
@@ -0,0 +1,488 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateReplay.h"
+
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/FileHelper.h"
+
+namespace SBSkateReplay
+{
+	/** Quarter centimeter locations, centimeter per second velocities and 16 bit angles */
+	constexpr float LocationScale = 4.f;
+	constexpr float VelocityScale = 1.f;
+	constexpr float AngleScale = 65536.f / 360.f;
+
+	enum EChannel
+	{
+		Channel_LocationX,
+		Channel_LocationY,
+		Channel_LocationZ,
+		Channel_Yaw,
+		Channel_Pitch,
+		Channel_Roll,
+		Channel_VelocityX,
+		Channel_VelocityY,
+		Channel_VelocityZ,
+		Channel_Flags,
+	};
+
+	enum EFlags
+	{
+		Flag_LeanLeft = 1 << 0,
+		Flag_LeanRight = 1 << 1,
+		Flag_Push = 1 << 2,
+		Flag_Brake = 1 << 3,
+		Flag_Grounded = 1 << 4,
+	};
+
+	/** Locations and velocities change smoothly and are predicted linearly, angles and flags from the previous frame */
+	bool IsLinearChannel(int32 Channel)
+	{
+		return Channel <= Channel_LocationZ || (Channel >= Channel_VelocityX && Channel <= Channel_VelocityZ);
+	}
+
+	bool IsAngleChannel(int32 Channel)
+	{
+		return Channel >= Channel_Yaw && Channel <= Channel_Roll;
+	}
+
+	FQuantizedFrame Quantize(const FSBSkateReplayFrame& Frame)
+	{
+		FQuantizedFrame Quantized;
+		Quantized[Channel_LocationX] = FMath::RoundToInt32(Frame.Location.X * LocationScale);
+		Quantized[Channel_LocationY] = FMath::RoundToInt32(Frame.Location.Y * LocationScale);
+		Quantized[Channel_LocationZ] = FMath::RoundToInt32(Frame.Location.Z * LocationScale);
+		Quantized[Channel_Yaw] = FMath::RoundToInt32(FRotator::ClampAxis(Frame.Rotation.Yaw) * AngleScale) & 0xFFFF;
+		Quantized[Channel_Pitch] = FMath::RoundToInt32(FRotator::ClampAxis(Frame.Rotation.Pitch) * AngleScale) & 0xFFFF;
+		Quantized[Channel_Roll] = FMath::RoundToInt32(FRotator::ClampAxis(Frame.Rotation.Roll) * AngleScale) & 0xFFFF;
+		Quantized[Channel_VelocityX] = FMath::RoundToInt32(Frame.Velocity.X * VelocityScale);
+		Quantized[Channel_VelocityY] = FMath::RoundToInt32(Frame.Velocity.Y * VelocityScale);
+		Quantized[Channel_VelocityZ] = FMath::RoundToInt32(Frame.Velocity.Z * VelocityScale);
+		Quantized[Channel_Flags] = (Frame.LeanDirection < 0 ? Flag_LeanLeft : 0)
+			| (Frame.LeanDirection > 0 ? Flag_LeanRight : 0)
+			| (Frame.bWantsToPush ? Flag_Push : 0)
+			| (Frame.bWantsToBrake ? Flag_Brake : 0)
+			| (Frame.bGrounded ? Flag_Grounded : 0);
+		return Quantized;
+	}
+
+	FSBSkateReplayFrame Dequantize(const FQuantizedFrame& Quantized)
+	{
+		FSBSkateReplayFrame Frame;
+		Frame.Location = FVector(Quantized[Channel_LocationX], Quantized[Channel_LocationY], Quantized[Channel_LocationZ]) / LocationScale;
+		Frame.Rotation = FRotator(Quantized[Channel_Pitch], Quantized[Channel_Yaw], Quantized[Channel_Roll]) * (1.f / AngleScale);
+		Frame.Velocity = FVector(Quantized[Channel_VelocityX], Quantized[Channel_VelocityY], Quantized[Channel_VelocityZ]) / VelocityScale;
+
+		const int32 Flags = Quantized[Channel_Flags];
+		Frame.LeanDirection = (Flags & Flag_LeanRight) != 0 ? 1 : ((Flags & Flag_LeanLeft) != 0 ? -1 : 0);
+		Frame.bWantsToPush = (Flags & Flag_Push) != 0;
+		Frame.bWantsToBrake = (Flags & Flag_Brake) != 0;
+		Frame.bGrounded = (Flags & Flag_Grounded) != 0;
+		return Frame;
+	}
+
+	/** Prediction of a channel from the previous frames of the block, wraps like the residuals do */
+	int32 Predict(int32 Channel, int32 FrameInBlock, const FQuantizedFrame& Previous, const FQuantizedFrame& PreviousPrevious)
+	{
+		if (FrameInBlock == 0)
+		{
+			return 0;
+		}
+
+		if (FrameInBlock >= 2 && IsLinearChannel(Channel))
+		{
+			return static_cast<int32>(2u * static_cast<uint32>(Previous[Channel]) - static_cast<uint32>(PreviousPrevious[Channel]));
+		}
+		return Previous[Channel];
+	}
+
+	int32 GetResidual(int32 Channel, int32 Value, int32 Prediction)
+	{
+		const int32 Residual = static_cast<int32>(static_cast<uint32>(Value) - static_cast<uint32>(Prediction));
+		return IsAngleChannel(Channel) ? static_cast<int16>(Residual) : Residual;
+	}
+
+	int32 ApplyResidual(int32 Channel, int32 Prediction, int32 Residual)
+	{
+		const int32 Value = static_cast<int32>(static_cast<uint32>(Prediction) + static_cast<uint32>(Residual));
+		return IsAngleChannel(Channel) ? Value & 0xFFFF : Value;
+	}
+
+	/** Zigzag varint, small residuals of either sign take a single byte */
+	void WriteVarInt(TArray<uint8>& Out, int32 Value)
+	{
+		uint32 Zigzag = (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+		while (Zigzag >= 0x80)
+		{
+			Out.Add(static_cast<uint8>(Zigzag | 0x80));
+			Zigzag >>= 7;
+		}
+		Out.Add(static_cast<uint8>(Zigzag));
+	}
+
+	bool ReadVarInt(const uint8*& Cursor, const uint8* End, int32& OutValue)
+	{
+		uint32 Zigzag = 0;
+		for (int32 Shift = 0; Shift < 35 && Cursor < End; Shift += 7)
+		{
+			const uint8 Byte = *Cursor++;
+			Zigzag |= static_cast<uint32>(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				OutValue = static_cast<int32>(Zigzag >> 1) ^ -static_cast<int32>(Zigzag & 1);
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+FSBSkateReplayWriter::~FSBSkateReplayWriter()
+{
+	Close();
+}
+
+bool FSBSkateReplayWriter::Open(const FString& InFilename, float SampleInterval)
+{
+	Close();
+
+	Filename = InFilename;
+	Archive.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (Archive.IsValid() == false)
+	{
+		return false;
+	}
+
+	Header = FSBSkateReplayHeader();
+	Header.SampleInterval = SampleInterval;
+	Archive->Serialize(&Header, sizeof(FSBSkateReplayHeader));
+
+	CurrentBlock.Reset();
+	CurrentBlockFrames = 0;
+	NumFrames = 0;
+	BlockIndex.Reset();
+	bStopping = false;
+
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("SkateReplayWriter"), 0, TPri_BelowNormal);
+	return Thread != nullptr;
+}
+
+void FSBSkateReplayWriter::AddFrame(const FSBSkateReplayFrame& Frame)
+{
+	using namespace SBSkateReplay;
+
+	if (IsOpen() == false)
+	{
+		return;
+	}
+
+	if (CurrentBlockFrames == 0)
+	{
+		CurrentBlock.Reset();
+		CurrentBlock.AddZeroed(sizeof(FSBSkateReplayBlockHeader));
+	}
+
+	const FQuantizedFrame Quantized = Quantize(Frame);
+	for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+	{
+		const int32 Prediction = Predict(Channel, CurrentBlockFrames, PreviousFrame, PreviousPreviousFrame);
+		WriteVarInt(CurrentBlock, GetResidual(Channel, Quantized[Channel], Prediction));
+	}
+
+	PreviousPreviousFrame = PreviousFrame;
+	PreviousFrame = Quantized;
+	++CurrentBlockFrames;
+	++NumFrames;
+
+	if (CurrentBlockFrames >= Header.FramesPerBlock)
+	{
+		FlushBlock();
+	}
+}
+
+void FSBSkateReplayWriter::Close()
+{
+	if (Thread == nullptr)
+	{
+		return;
+	}
+
+	FlushBlock();
+
+	bStopping = true;
+	WorkEvent->Trigger();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+
+	Archive.Reset();
+}
+
+uint32 FSBSkateReplayWriter::Run()
+{
+	while (true)
+	{
+		const bool bStopRequested = bStopping;
+
+		TArray<uint8> Block;
+		while (PendingBlocks.Dequeue(Block))
+		{
+			const FSBSkateReplayBlockHeader* BlockHeader = reinterpret_cast<const FSBSkateReplayBlockHeader*>(Block.GetData());
+
+			FSBSkateReplayBlockInfo& Info = BlockIndex.AddDefaulted_GetRef();
+			Info.Offset = Archive->Tell();
+			Info.FirstFrame = BlockHeader->FirstFrame;
+			Info.NumFrames = BlockHeader->NumFrames;
+
+			Archive->Serialize(Block.GetData(), Block.Num());
+		}
+
+		// Keep the file readable up to the last block if the session ends in a crash
+		Archive->Flush();
+
+		if (bStopRequested)
+		{
+			break;
+		}
+		WorkEvent->Wait(1000);
+	}
+
+	FSBSkateReplayFooter Footer;
+	Footer.IndexOffset = Archive->Tell();
+	Footer.NumBlocks = BlockIndex.Num();
+	Archive->Serialize(BlockIndex.GetData(), BlockIndex.Num() * sizeof(FSBSkateReplayBlockInfo));
+	Archive->Serialize(&Footer, sizeof(FSBSkateReplayFooter));
+	Archive->Close();
+	return 0;
+}
+
+void FSBSkateReplayWriter::Stop()
+{
+	bStopping = true;
+	if (WorkEvent != nullptr)
+	{
+		WorkEvent->Trigger();
+	}
+}
+
+void FSBSkateReplayWriter::FlushBlock()
+{
+	if (CurrentBlockFrames == 0)
+	{
+		return;
+	}
+
+	FSBSkateReplayBlockHeader* BlockHeader = reinterpret_cast<FSBSkateReplayBlockHeader*>(CurrentBlock.GetData());
+	BlockHeader->FirstFrame = NumFrames - CurrentBlockFrames;
+	BlockHeader->NumFrames = CurrentBlockFrames;
+	BlockHeader->PayloadSize = CurrentBlock.Num() - sizeof(FSBSkateReplayBlockHeader);
+
+	PendingBlocks.Enqueue(MoveTemp(CurrentBlock));
+	CurrentBlock = TArray<uint8>();
+	CurrentBlockFrames = 0;
+	WorkEvent->Trigger();
+}
+
+FSBSkateReplayReader::~FSBSkateReplayReader()
+{
+	// Region has to be unmapped before its file handle is closed
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+bool FSBSkateReplayReader::Open(const FString& Filename)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (MappedFile.IsValid())
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if (MappedRegion.IsValid())
+		{
+			return SetData(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+		}
+	}
+
+	MappedRegion.Reset();
+	MappedFile.Reset();
+
+	if (FFileHelper::LoadFileToArray(LoadedData, *Filename, FILEREAD_Silent) == false)
+	{
+		return false;
+	}
+	return SetData(LoadedData.GetData(), LoadedData.Num());
+}
+
+bool FSBSkateReplayReader::Sample(float Time, FSBSkateReplayFrame& OutFrame)
+{
+	if (NumFrames == 0)
+	{
+		return false;
+	}
+
+	const float FrameTime = FMath::Clamp(Time / Header.SampleInterval, 0.f, static_cast<float>(NumFrames - 1));
+	const int32 FrameIndex = FMath::FloorToInt32(FrameTime);
+	const float Alpha = FrameTime - FrameIndex;
+
+	FSBSkateReplayFrame NextFrame;
+	if (GetFrame(FrameIndex, OutFrame) == false || GetFrame(FMath::Min(FrameIndex + 1, NumFrames - 1), NextFrame) == false)
+	{
+		return false;
+	}
+
+	OutFrame.Location = FMath::Lerp(OutFrame.Location, NextFrame.Location, Alpha);
+	OutFrame.Rotation = FQuat::Slerp(OutFrame.Rotation.Quaternion(), NextFrame.Rotation.Quaternion(), Alpha).Rotator();
+	OutFrame.Velocity = FMath::Lerp(OutFrame.Velocity, NextFrame.Velocity, Alpha);
+	return true;
+}
+
+bool FSBSkateReplayReader::SetData(const uint8* InData, int64 InSize)
+{
+	Data = InData;
+	Size = InSize;
+	Blocks.Reset();
+	NumFrames = 0;
+	DecodedBlock = INDEX_NONE;
+
+	if (Data == nullptr || Size < static_cast<int64>(sizeof(FSBSkateReplayHeader)))
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&Header, Data, sizeof(FSBSkateReplayHeader));
+	if (Header.Magic != FSBSkateReplayHeader::ExpectedMagic || Header.Version != FSBSkateReplayHeader::ExpectedVersion
+		|| Header.SampleInterval <= 0.f || Header.FramesPerBlock <= 0)
+	{
+		return false;
+	}
+
+	FSBSkateReplayFooter Footer;
+	const int64 FooterOffset = Size - sizeof(FSBSkateReplayFooter);
+	if (FooterOffset >= static_cast<int64>(sizeof(FSBSkateReplayHeader)))
+	{
+		FMemory::Memcpy(&Footer, Data + FooterOffset, sizeof(FSBSkateReplayFooter));
+	}
+
+	const bool bHasIndex = FooterOffset >= static_cast<int64>(sizeof(FSBSkateReplayHeader))
+		&& Footer.Magic == FSBSkateReplayFooter::ExpectedMagic && Footer.NumBlocks >= 0 && Footer.IndexOffset >= 0
+		&& Footer.IndexOffset + Footer.NumBlocks * static_cast<int64>(sizeof(FSBSkateReplayBlockInfo)) == FooterOffset;
+	if (bHasIndex == false)
+	{
+		return ScanBlocks();
+	}
+
+	Blocks.SetNumUninitialized(Footer.NumBlocks);
+	FMemory::Memcpy(Blocks.GetData(), Data + Footer.IndexOffset, Footer.NumBlocks * sizeof(FSBSkateReplayBlockInfo));
+	for (const FSBSkateReplayBlockInfo& Block : Blocks)
+	{
+		NumFrames = FMath::Max(NumFrames, Block.FirstFrame + Block.NumFrames);
+	}
+	return true;
+}
+
+bool FSBSkateReplayReader::ScanBlocks()
+{
+	int64 Offset = sizeof(FSBSkateReplayHeader);
+	while (Offset + static_cast<int64>(sizeof(FSBSkateReplayBlockHeader)) <= Size)
+	{
+		FSBSkateReplayBlockHeader BlockHeader;
+		FMemory::Memcpy(&BlockHeader, Data + Offset, sizeof(FSBSkateReplayBlockHeader));
+
+		// Last block may have been cut off mid write
+		const int64 BlockEnd = Offset + sizeof(FSBSkateReplayBlockHeader) + BlockHeader.PayloadSize;
+		if (BlockHeader.FirstFrame != NumFrames || BlockHeader.NumFrames <= 0 || BlockHeader.PayloadSize <= 0 || BlockEnd > Size)
+		{
+			break;
+		}
+
+		FSBSkateReplayBlockInfo& Info = Blocks.AddDefaulted_GetRef();
+		Info.Offset = Offset;
+		Info.FirstFrame = BlockHeader.FirstFrame;
+		Info.NumFrames = BlockHeader.NumFrames;
+
+		NumFrames += BlockHeader.NumFrames;
+		Offset = BlockEnd;
+	}
+	return Blocks.Num() > 0;
+}
+
+bool FSBSkateReplayReader::GetFrame(int32 FrameIndex, FSBSkateReplayFrame& OutFrame)
+{
+	// Blocks are sorted by their first frame
+	const int32 BlockIndex = Algo::UpperBoundBy(Blocks, FrameIndex, &FSBSkateReplayBlockInfo::FirstFrame) - 1;
+	if (Blocks.IsValidIndex(BlockIndex) == false || DecodeBlock(BlockIndex) == false)
+	{
+		return false;
+	}
+
+	const int32 FrameInBlock = FrameIndex - Blocks[BlockIndex].FirstFrame;
+	if (DecodedFrames.IsValidIndex(FrameInBlock) == false)
+	{
+		return false;
+	}
+
+	OutFrame = DecodedFrames[FrameInBlock];
+	return true;
+}
+
+bool FSBSkateReplayReader::DecodeBlock(int32 BlockIndex)
+{
+	using namespace SBSkateReplay;
+
+	if (DecodedBlock == BlockIndex)
+	{
+		return true;
+	}
+
+	DecodedBlock = INDEX_NONE;
+	DecodedFrames.Reset();
+
+	const FSBSkateReplayBlockInfo& Block = Blocks[BlockIndex];
+	if (Block.Offset < 0 || Block.Offset + static_cast<int64>(sizeof(FSBSkateReplayBlockHeader)) > Size)
+	{
+		return false;
+	}
+
+	FSBSkateReplayBlockHeader BlockHeader;
+	FMemory::Memcpy(&BlockHeader, Data + Block.Offset, sizeof(FSBSkateReplayBlockHeader));
+
+	const uint8* Cursor = Data + Block.Offset + sizeof(FSBSkateReplayBlockHeader);
+	const uint8* End = Cursor + BlockHeader.PayloadSize;
+	if (BlockHeader.PayloadSize < 0 || End > Data + Size)
+	{
+		return false;
+	}
+
+	FQuantizedFrame Previous;
+	FQuantizedFrame PreviousPrevious;
+	for (int32 FrameInBlock = 0; FrameInBlock < BlockHeader.NumFrames; ++FrameInBlock)
+	{
+		FQuantizedFrame Quantized;
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			int32 Residual;
+			if (ReadVarInt(Cursor, End, Residual) == false)
+			{
+				return false;
+			}
+			Quantized[Channel] = ApplyResidual(Channel, Predict(Channel, FrameInBlock, Previous, PreviousPrevious), Residual);
+		}
+
+		DecodedFrames.Add(Dequantize(Quantized));
+		PreviousPrevious = Previous;
+		Previous = Quantized;
+	}
+
+	DecodedBlock = BlockIndex;
+	return true;
+}
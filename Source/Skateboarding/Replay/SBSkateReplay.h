@@ -0,0 +1,160 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Containers/StaticArray.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FArchive;
+class FEvent;
+class FRunnableThread;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace SBSkateReplay
+{
+	/** Location, rotation, velocity and input flags of a frame after quantization */
+	constexpr int32 NumChannels = 10;
+	using FQuantizedFrame = TStaticArray<int32, NumChannels>;
+}
+
+/** Skate state at one replay sample */
+struct FSBSkateReplayFrame
+{
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FVector Velocity = FVector::ZeroVector;
+	int8 LeanDirection = 0;
+	bool bWantsToPush = false;
+	bool bWantsToBrake = false;
+	bool bGrounded = false;
+};
+
+/**
+ * Replay file layout, all blocks can be decoded on their own so seeking only decodes one block:
+ * FSBSkateReplayHeader | blocks (FSBSkateReplayBlockHeader + encoded frames) | block index | FSBSkateReplayFooter
+ * The first frame of a block is a keyframe, the other frames are varint residuals against a prediction from the previous frames.
+ */
+struct FSBSkateReplayHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x50524253; // "SBRP"
+	static constexpr uint32 ExpectedVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = ExpectedVersion;
+	float SampleInterval = 1.f / 30.f;
+	int32 FramesPerBlock = 60;
+};
+
+struct FSBSkateReplayBlockHeader
+{
+	int32 FirstFrame = 0;
+	int32 NumFrames = 0;
+	int32 PayloadSize = 0;
+};
+
+struct FSBSkateReplayBlockInfo
+{
+	int64 Offset = 0;
+	int32 FirstFrame = 0;
+	int32 NumFrames = 0;
+};
+
+struct FSBSkateReplayFooter
+{
+	static constexpr uint32 ExpectedMagic = 0x58444953; // "SIDX"
+
+	int64 IndexOffset = 0;
+	int32 NumBlocks = 0;
+	uint32 Magic = ExpectedMagic;
+};
+
+/**
+ * Records skate frames to a replay file. Frames are quantized and encoded on the calling thread,
+ * finished blocks are written by a background thread so recording never waits on disk I/O.
+ */
+class FSBSkateReplayWriter : public FRunnable
+{
+public:
+	FSBSkateReplayWriter() = default;
+	virtual ~FSBSkateReplayWriter() override;
+
+	bool Open(const FString& InFilename, float SampleInterval);
+	void AddFrame(const FSBSkateReplayFrame& Frame);
+	/** Writes the pending frames and the block index, blocks until the file is closed */
+	void Close();
+
+	bool IsOpen() const { return Thread != nullptr; }
+	float GetSampleInterval() const { return Header.SampleInterval; }
+	const FString& GetFilename() const { return Filename; }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	void FlushBlock();
+
+	FSBSkateReplayHeader Header;
+	FString Filename;
+	TUniquePtr<FArchive> Archive;
+	FRunnableThread* Thread = nullptr;
+	FEvent* WorkEvent = nullptr;
+	std::atomic<bool> bStopping = false;
+
+	/** Encoded blocks waiting to be written */
+	TQueue<TArray<uint8>, EQueueMode::Spsc> PendingBlocks;
+
+	/** Block being encoded and the last two quantized frames the next frame is predicted from */
+	TArray<uint8> CurrentBlock;
+	int32 CurrentBlockFrames = 0;
+	int32 NumFrames = 0;
+	SBSkateReplay::FQuantizedFrame PreviousFrame;
+	SBSkateReplay::FQuantizedFrame PreviousPreviousFrame;
+
+	/** Only touched by the writer thread */
+	TArray<FSBSkateReplayBlockInfo> BlockIndex;
+};
+
+/** Reads a replay file, memory mapped when the platform allows it */
+class FSBSkateReplayReader
+{
+public:
+	FSBSkateReplayReader() = default;
+	~FSBSkateReplayReader();
+
+	FSBSkateReplayReader(const FSBSkateReplayReader&) = delete;
+	FSBSkateReplayReader& operator=(const FSBSkateReplayReader&) = delete;
+
+	bool Open(const FString& Filename);
+
+	int32 GetNumFrames() const { return NumFrames; }
+	float GetDuration() const { return FMath::Max(0, NumFrames - 1) * Header.SampleInterval; }
+
+	/** State at a time of the replay, interpolated between the two closest frames */
+	bool Sample(float Time, FSBSkateReplayFrame& OutFrame);
+
+private:
+	bool SetData(const uint8* InData, int64 InSize);
+	/** Rebuilds the block index of a replay that was not closed, e.g. after a crash */
+	bool ScanBlocks();
+	bool GetFrame(int32 FrameIndex, FSBSkateReplayFrame& OutFrame);
+	bool DecodeBlock(int32 BlockIndex);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray64<uint8> LoadedData;
+
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+	FSBSkateReplayHeader Header;
+	TArray<FSBSkateReplayBlockInfo> Blocks;
+	int32 NumFrames = 0;
+
+	/** Frames of the last decoded block, playback mostly samples the same block over and over */
+	int32 DecodedBlock = INDEX_NONE;
+	TArray<FSBSkateReplayFrame> DecodedFrames;
+};
@@ -0,0 +1,200 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateReplaySubsystem.h"
+
+#include "SBSkateGhost.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarRecordReplays(
+		TEXT("sb.Replay.Record"),
+		false,
+		TEXT("Records a skate replay of every locally controlled skater to Saved/Replays"));
+
+	TAutoConsoleVariable<float> CVarReplaySampleRate(
+		TEXT("sb.Replay.SampleRate"),
+		30.f,
+		TEXT("Frames per second recorded in new skate replays"));
+
+	FAutoConsoleCommandWithWorldAndArgs SpawnGhostCommand(
+		TEXT("sb.Replay.Ghost"),
+		TEXT("Spawns a ghost playing a skate replay. Usage: sb.Replay.Ghost <File> [StartTime]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			USBSkateReplaySubsystem* ReplaySubsystem = World != nullptr ? World->GetSubsystem<USBSkateReplaySubsystem>() : nullptr;
+			if (ReplaySubsystem == nullptr || Args.Num() == 0)
+			{
+				return;
+			}
+
+			const float StartTime = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 0.f;
+			if (ReplaySubsystem->SpawnGhost(Args[0], StartTime) == nullptr)
+			{
+				UE_LOG(LogSkateMovement, Warning, TEXT("Failed to play skate replay %s"), *Args[0]);
+			}
+		}));
+
+	FAutoConsoleCommandWithWorldAndArgs SeekGhostsCommand(
+		TEXT("sb.Replay.Seek"),
+		TEXT("Moves every ghost to a time of its replay. Usage: sb.Replay.Seek <Time>"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			USBSkateReplaySubsystem* ReplaySubsystem = World != nullptr ? World->GetSubsystem<USBSkateReplaySubsystem>() : nullptr;
+			if (ReplaySubsystem == nullptr || Args.Num() == 0)
+			{
+				return;
+			}
+
+			for (const TWeakObjectPtr<ASBSkateGhost>& Ghost : ReplaySubsystem->GetGhosts())
+			{
+				if (Ghost.IsValid())
+				{
+					Ghost->Seek(FCString::Atof(*Args[0]));
+				}
+			}
+		}));
+}
+
+void USBSkateReplaySubsystem::Deinitialize()
+{
+	// Closing waits for the writer threads, the replays are complete once the world is gone
+	Recordings.Reset();
+	Ghosts.Reset();
+
+	Super::Deinitialize();
+}
+
+void USBSkateReplaySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	for (auto It = Recordings.CreateIterator(); It; ++It)
+	{
+		if (It.Key().IsValid() == false || CVarRecordReplays.GetValueOnGameThread() == false)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (CVarRecordReplays.GetValueOnGameThread() == false)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController == nullptr)
+		{
+			continue;
+		}
+
+		ASBCharacter* Skater = Cast<ASBCharacter>(PlayerController->GetPawn());
+		if (Skater != nullptr && Skater->IsLocallyControlled() && Recordings.Contains(Skater) == false)
+		{
+			StartRecording(Skater);
+		}
+	}
+
+	if (Recordings.Num() == 0)
+	{
+		return;
+	}
+
+	// Fixed sample rate, frames carry no time stamp and the replay stays seekable by frame index
+	const float SampleInterval = 1.f / FMath::Max(1.f, CVarReplaySampleRate.GetValueOnGameThread());
+	SampleAccumulator += DeltaTime;
+	while (SampleAccumulator >= SampleInterval)
+	{
+		SampleAccumulator -= SampleInterval;
+		for (TPair<TWeakObjectPtr<ASBCharacter>, TUniquePtr<FSBSkateReplayWriter>>& Recording : Recordings)
+		{
+			RecordFrame(Recording.Key.Get(), *Recording.Value);
+		}
+	}
+}
+
+TStatId USBSkateReplaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBSkateReplaySubsystem, STATGROUP_Tickables);
+}
+
+ASBSkateGhost* USBSkateReplaySubsystem::SpawnGhost(const FString& Filename, float StartTime)
+{
+	const FString ReplayPath = FPaths::IsRelative(Filename) ? GetReplayDir() / Filename : Filename;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	ASBSkateGhost* Ghost = GetWorld()->SpawnActor<ASBSkateGhost>(ASBSkateGhost::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (Ghost == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Ghost looks like the first local skater, replays don't store the appearance
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const ASBCharacter* Appearance = PlayerController != nullptr ? Cast<ASBCharacter>(PlayerController->GetPawn()) : nullptr;
+	if (Ghost->Play(ReplayPath, StartTime, Appearance) == false)
+	{
+		Ghost->Destroy();
+		return nullptr;
+	}
+
+	Ghosts.RemoveAll([](const TWeakObjectPtr<ASBSkateGhost>& Existing) { return Existing.IsValid() == false; });
+	Ghosts.Add(Ghost);
+	return Ghost;
+}
+
+FString USBSkateReplaySubsystem::GetReplayId(ASBCharacter* Skater) const
+{
+	const TUniquePtr<FSBSkateReplayWriter>* Recording = Recordings.Find(Skater);
+	return Recording != nullptr ? FPaths::GetCleanFilename((*Recording)->GetFilename()) : FString();
+}
+
+FString USBSkateReplaySubsystem::GetReplayDir()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Replays");
+}
+
+bool USBSkateReplaySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USBSkateReplaySubsystem::StartRecording(ASBCharacter* Skater)
+{
+	const FString MapName = FPackageName::GetShortName(UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName()));
+	const FString Filename = GetReplayDir() / FString::Printf(TEXT("%s_%s_%s.sbreplay"), *MapName, *FDateTime::Now().ToString(), *Skater->GetName());
+
+	TUniquePtr<FSBSkateReplayWriter> Writer = MakeUnique<FSBSkateReplayWriter>();
+	if (Writer->Open(Filename, 1.f / FMath::Max(1.f, CVarReplaySampleRate.GetValueOnGameThread())) == false)
+	{
+		UE_LOG(LogSkateMovement, Warning, TEXT("Failed to record skate replay to %s"), *Filename);
+		return;
+	}
+
+	RecordFrame(Skater, *Writer);
+	Recordings.Add(Skater, MoveTemp(Writer));
+}
+
+void USBSkateReplaySubsystem::RecordFrame(ASBCharacter* Skater, FSBSkateReplayWriter& Writer)
+{
+	USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+
+	FSBSkateReplayFrame Frame;
+	Frame.Location = Skater->GetActorLocation();
+	Frame.Rotation = Skater->GetActorRotation();
+	Frame.Velocity = MovementComponent->Velocity;
+	Frame.LeanDirection = MovementComponent->GetLeanDirection();
+	Frame.bWantsToPush = MovementComponent->GetWantsToPush();
+	Frame.bWantsToBrake = MovementComponent->GetWantsToBrake();
+	Frame.bGrounded = MovementComponent->GetIsGrounded();
+	Writer.AddFrame(Frame);
+}
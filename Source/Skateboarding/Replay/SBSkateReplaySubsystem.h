@@ -0,0 +1,50 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBSkateReplay.h"
+#include "SBSkateReplaySubsystem.generated.h"
+
+class ASBCharacter;
+class ASBSkateGhost;
+
+/**
+ * Records a skate replay for every locally controlled skater while sb.Replay.Record is enabled,
+ * and spawns ghosts playing recorded replays back.
+ */
+UCLASS()
+class SKATEBOARDING_API USBSkateReplaySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Spawns a ghost playing a replay file, relative paths are looked up in the replay directory */
+	ASBSkateGhost* SpawnGhost(const FString& Filename, float StartTime = 0.f);
+
+	const TArray<TWeakObjectPtr<ASBSkateGhost>>& GetGhosts() const { return Ghosts; }
+
+	/** File name of the replay being recorded for a skater, empty if the skater isn't recorded */
+	FString GetReplayId(ASBCharacter* Skater) const;
+
+	static FString GetReplayDir();
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void StartRecording(ASBCharacter* Skater);
+	void RecordFrame(ASBCharacter* Skater, FSBSkateReplayWriter& Writer);
+
+	TMap<TWeakObjectPtr<ASBCharacter>, TUniquePtr<FSBSkateReplayWriter>> Recordings;
+	/** Time since the last recorded frame, all recordings are sampled on the same frames */
+	float SampleAccumulator = 0.f;
+
+	TArray<TWeakObjectPtr<ASBSkateGhost>> Ghosts;
+};
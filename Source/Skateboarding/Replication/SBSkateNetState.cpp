@@ -0,0 +1,296 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateNetState.h"
+
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+namespace SBSkateNetState
+{
+	enum EChannel
+	{
+		Channel_LocationX,
+		Channel_LocationY,
+		Channel_LocationZ,
+		Channel_VelocityX,
+		Channel_VelocityY,
+		Channel_VelocityZ,
+		Channel_Pitch,
+		Channel_Yaw,
+		Channel_Roll,
+		Channel_Lean,
+		Channel_FrictionMultiplier
+	};
+
+	/** Half centimeters, twice the precision of the stock replicated movement */
+	constexpr float LocationScale = 2.f;
+	/** Centimeters per second */
+	constexpr float VelocityScale = 1.f;
+	constexpr float LeanScale = 127.f;
+	constexpr float FrictionScale = 16.f;
+
+	constexpr uint8 FLAG_Pushing = 0x01;
+	constexpr uint8 FLAG_Braking = 0x02;
+	constexpr uint8 FLAG_Grounded = 0x04;
+	constexpr uint32 NumFlagBits = 3;
+
+	bool IsRotationChannel(int32 Channel)
+	{
+		return Channel >= Channel_Pitch && Channel <= Channel_Roll;
+	}
+
+	/** Rotations are 16 bit angles, their deltas wrap around so a turn through 0 stays small */
+	int32 GetDelta(int32 Channel, int32 Value, int32 Base)
+	{
+		return IsRotationChannel(Channel) ? static_cast<int16>(static_cast<uint16>(Value - Base)) : Value - Base;
+	}
+
+	int32 ApplyDelta(int32 Channel, int32 Base, int32 Delta)
+	{
+		return IsRotationChannel(Channel) ? static_cast<uint16>(Base + Delta) : Base + Delta;
+	}
+
+	/** Unchanged channels take one bit, changed ones a 5 bit width and the zigzag encoded delta */
+	void WriteDelta(FBitWriter& Writer, int32 Delta)
+	{
+		uint32 Zigzag = (static_cast<uint32>(Delta) << 1) ^ static_cast<uint32>(Delta >> 31);
+		Writer.WriteBit(Zigzag != 0);
+		if (Zigzag != 0)
+		{
+			const uint32 NumBits = FMath::FloorLog2(Zigzag) + 1;
+			Writer.WriteIntWrapped(NumBits - 1, 32);
+			Writer.SerializeBits(&Zigzag, NumBits);
+		}
+	}
+
+	int32 ReadDelta(FBitReader& Reader)
+	{
+		if (Reader.ReadBit() == 0)
+		{
+			return 0;
+		}
+
+		const uint32 NumBits = Reader.ReadInt(32) + 1;
+		uint32 Zigzag = 0;
+		Reader.SerializeBits(&Zigzag, NumBits);
+		return static_cast<int32>(Zigzag >> 1) ^ -static_cast<int32>(Zigzag & 1);
+	}
+
+	TAutoConsoleVariable<bool> CVarMeasureMovementBaseline(
+		TEXT("sb.Net.MeasureMovementBaseline"),
+		false,
+		TEXT("Serializes the stock replicated movement of every replicated skater so sb.Net.SkateStats can compare against it"));
+
+	FAutoConsoleCommandWithWorldAndArgs SkateStatsCommand(
+		TEXT("sb.Net.SkateStats"),
+		TEXT("Logs the bandwidth of the replicated skate state. Usage: sb.Net.SkateStats [reset]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			FSBSkateNetStats& Stats = FSBSkateNetState::GetStats();
+			if (Args.Num() > 0 && Args[0].Equals(TEXT("reset"), ESearchCase::IgnoreCase))
+			{
+				Stats = FSBSkateNetStats();
+				Stats.StartTime = FPlatformTime::Seconds();
+				return;
+			}
+
+			int32 NumSkaters = 0;
+			if (World != nullptr)
+			{
+				for (TActorIterator<ASBCharacter> It(World); It; ++It)
+				{
+					NumSkaters += It->HasAuthority() ? 1 : 0;
+				}
+			}
+
+			const double Elapsed = FMath::Max(FPlatformTime::Seconds() - Stats.StartTime, UE_DOUBLE_SMALL_NUMBER);
+			const double Updates = FMath::Max<double>(Stats.Updates, 1.0);
+			UE_LOG(LogSkateMovement, Display, TEXT("Skate state: %lld updates in %.1fs, %.1f bits per update, %.0f bits/s per skater, %.1f%% full updates"),
+			       Stats.Updates, Elapsed, Stats.Bits / Updates, Stats.Bits / Elapsed / FMath::Max(NumSkaters, 1), Stats.FullUpdates * 100.0 / Updates);
+
+			if (Stats.MeasuredUpdates > 0)
+			{
+				const double MovementBitsPerUpdate = static_cast<double>(Stats.MovementBits) / Stats.MeasuredUpdates;
+				UE_LOG(LogSkateMovement, Display, TEXT("Stock replicated movement: %.1f bits per update, skate state takes %.1f%% of it"),
+				       MovementBitsPerUpdate, Stats.Bits / Updates * 100.0 / FMath::Max(MovementBitsPerUpdate, 1.0));
+			}
+
+			UE_LOG(LogSkateMovement, Display, TEXT("Received %lld updates, dropped %lld deltas against missing bases"), Stats.ReceivedUpdates, Stats.DroppedUpdates);
+		}));
+}
+
+/** Quantized state a connection was sent, the base of the next delta once the packet is acknowledged */
+class FSBSkateNetDeltaState : public INetDeltaBaseState
+{
+public:
+	explicit FSBSkateNetDeltaState(const FSBSkateQuantizedState& InState)
+		: State(InState)
+	{
+	}
+
+	virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+	{
+		return State == static_cast<FSBSkateNetDeltaState*>(OtherState)->State;
+	}
+
+	FSBSkateQuantizedState State;
+};
+
+void FSBSkateNetState::Quantize(int32 MovementBits)
+{
+	using namespace SBSkateNetState;
+
+	FSBSkateQuantizedState NewState;
+	NewState.Channels[Channel_LocationX] = FMath::RoundToInt32(Location.X * LocationScale);
+	NewState.Channels[Channel_LocationY] = FMath::RoundToInt32(Location.Y * LocationScale);
+	NewState.Channels[Channel_LocationZ] = FMath::RoundToInt32(Location.Z * LocationScale);
+	NewState.Channels[Channel_VelocityX] = FMath::RoundToInt32(Velocity.X * VelocityScale);
+	NewState.Channels[Channel_VelocityY] = FMath::RoundToInt32(Velocity.Y * VelocityScale);
+	NewState.Channels[Channel_VelocityZ] = FMath::RoundToInt32(Velocity.Z * VelocityScale);
+	NewState.Channels[Channel_Pitch] = FRotator::CompressAxisToShort(Rotation.Pitch);
+	NewState.Channels[Channel_Yaw] = FRotator::CompressAxisToShort(Rotation.Yaw);
+	NewState.Channels[Channel_Roll] = FRotator::CompressAxisToShort(Rotation.Roll);
+	NewState.Channels[Channel_Lean] = FMath::Clamp(FMath::RoundToInt32(Lean * LeanScale), -127, 127);
+	NewState.Channels[Channel_FrictionMultiplier] = FMath::Clamp(FMath::RoundToInt32(FrictionMultiplier * FrictionScale), 0, 255);
+	NewState.Flags = (bPushing ? FLAG_Pushing : 0) | (bBraking ? FLAG_Braking : 0) | (bGrounded ? FLAG_Grounded : 0);
+
+	// Unchanged values keep their sequence, so connections that already have them send nothing
+	if (NewState.Flags != Quantized.Flags || NewState.Channels != Quantized.Channels)
+	{
+		NewState.Sequence = Quantized.Sequence + 1;
+		Quantized = NewState;
+	}
+
+	QuantizedMovementBits = MovementBits;
+}
+
+bool FSBSkateNetState::ConsumeReceivedUpdate()
+{
+	const bool bReceived = bReceivedUpdate;
+	bReceivedUpdate = false;
+	return bReceived;
+}
+
+bool FSBSkateNetState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	using namespace SBSkateNetState;
+
+	FSBSkateNetStats& Stats = GetStats();
+	if (DeltaParms.Writer != nullptr)
+	{
+		const FSBSkateNetDeltaState* OldState = static_cast<const FSBSkateNetDeltaState*>(DeltaParms.OldState);
+		if (OldState != nullptr && OldState->State == Quantized)
+		{
+			return false;
+		}
+
+		*DeltaParms.NewState = MakeShared<FSBSkateNetDeltaState>(Quantized);
+
+		// Connections without an acknowledged state get the full state, encoded as a delta against zero
+		const FSBSkateQuantizedState Base = OldState != nullptr ? OldState->State : FSBSkateQuantizedState();
+
+		FBitWriter& Writer = *DeltaParms.Writer;
+		const int64 StartBits = Writer.GetNumBits();
+		Writer.WriteIntWrapped(Quantized.Sequence, 256);
+		Writer.WriteBit(OldState != nullptr);
+		if (OldState != nullptr)
+		{
+			Writer.WriteIntWrapped(Base.Sequence, 256);
+		}
+		Writer.WriteIntWrapped(Quantized.Flags, 1 << NumFlagBits);
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			WriteDelta(Writer, GetDelta(Channel, Quantized.Channels[Channel], Base.Channels[Channel]));
+		}
+
+		++Stats.Updates;
+		Stats.FullUpdates += OldState == nullptr ? 1 : 0;
+		Stats.Bits += Writer.GetNumBits() - StartBits;
+		if (QuantizedMovementBits > 0)
+		{
+			Stats.MovementBits += QuantizedMovementBits;
+			++Stats.MeasuredUpdates;
+		}
+		return true;
+	}
+
+	if (DeltaParms.Reader != nullptr)
+	{
+		FBitReader& Reader = *DeltaParms.Reader;
+
+		FSBSkateQuantizedState NewState;
+		NewState.Sequence = static_cast<uint8>(Reader.ReadInt(256));
+		const bool bHasBase = Reader.ReadBit() != 0;
+		const uint8 BaseSequence = bHasBase ? static_cast<uint8>(Reader.ReadInt(256)) : 0;
+		NewState.Flags = static_cast<uint8>(Reader.ReadInt(1 << NumFlagBits));
+
+		// The delta is read in full either way so the rest of the bunch stays aligned
+		const int32 BaseSlot = BaseSequence % HistorySize;
+		const bool bBaseFound = bHasBase == false || ((ReceivedSlots & (1u << BaseSlot)) != 0 && ReceivedStates[BaseSlot].Sequence == BaseSequence);
+		const FSBSkateQuantizedState Base = bHasBase && bBaseFound ? ReceivedStates[BaseSlot] : FSBSkateQuantizedState();
+		for (int32 Channel = 0; Channel < NumChannels; ++Channel)
+		{
+			NewState.Channels[Channel] = ApplyDelta(Channel, Base.Channels[Channel], ReadDelta(Reader));
+		}
+
+		if (Reader.IsError())
+		{
+			return false;
+		}
+
+		if (bBaseFound == false)
+		{
+			// Based on a state lost in flight, the server falls back to an acknowledged base once it learns about the loss
+			++Stats.DroppedUpdates;
+			return true;
+		}
+
+		const int32 Slot = NewState.Sequence % HistorySize;
+		ReceivedStates[Slot] = NewState;
+		ReceivedSlots |= 1u << Slot;
+		Quantized = NewState;
+		Dequantize();
+
+		bReceivedUpdate = true;
+		++Stats.ReceivedUpdates;
+		return true;
+	}
+
+	// No object references to map
+	return true;
+}
+
+FSBSkateNetStats& FSBSkateNetState::GetStats()
+{
+	static FSBSkateNetStats Stats = []
+	{
+		FSBSkateNetStats InitialStats;
+		InitialStats.StartTime = FPlatformTime::Seconds();
+		return InitialStats;
+	}();
+	return Stats;
+}
+
+bool FSBSkateNetState::IsMeasuringMovementBaseline()
+{
+	return SBSkateNetState::CVarMeasureMovementBaseline.GetValueOnGameThread();
+}
+
+void FSBSkateNetState::Dequantize()
+{
+	using namespace SBSkateNetState;
+
+	const TStaticArray<int32, NumChannels>& Channels = Quantized.Channels;
+	Location = FVector(Channels[Channel_LocationX], Channels[Channel_LocationY], Channels[Channel_LocationZ]) / LocationScale;
+	Velocity = FVector(Channels[Channel_VelocityX], Channels[Channel_VelocityY], Channels[Channel_VelocityZ]) / VelocityScale;
+	Rotation = FRotator(FRotator::DecompressAxisFromShort(Channels[Channel_Pitch]), FRotator::DecompressAxisFromShort(Channels[Channel_Yaw]),
+	                    FRotator::DecompressAxisFromShort(Channels[Channel_Roll]));
+	Lean = Channels[Channel_Lean] / LeanScale;
+	FrictionMultiplier = Channels[Channel_FrictionMultiplier] / FrictionScale;
+	bPushing = (Quantized.Flags & FLAG_Pushing) != 0;
+	bBraking = (Quantized.Flags & FLAG_Braking) != 0;
+	bGrounded = (Quantized.Flags & FLAG_Grounded) != 0;
+}
@@ -0,0 +1,101 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "Engine/NetSerialization.h"
+#include "SBSkateNetState.generated.h"
+
+namespace SBSkateNetState
+{
+	/** Location xyz, velocity xyz, pitch, yaw, roll, lean and friction multiplier */
+	constexpr int32 NumChannels = 11;
+
+	/** Received states kept as bases for the deltas still in flight */
+	constexpr int32 HistorySize = 16;
+}
+
+/** Skate state at the precision it is sent with */
+struct FSBSkateQuantizedState
+{
+	TStaticArray<int32, SBSkateNetState::NumChannels> Channels{InPlace, 0};
+	uint8 Flags = 0;
+	/** Bumped by the server every time the values change, clients find the base of a delta by it */
+	uint8 Sequence = 0;
+
+	bool operator==(const FSBSkateQuantizedState& Other) const
+	{
+		return Sequence == Other.Sequence && Flags == Other.Flags && Channels == Other.Channels;
+	}
+};
+
+/** Bandwidth of the skate state since the last reset, summed over every skater and connection */
+struct FSBSkateNetStats
+{
+	int64 Updates = 0;
+	int64 FullUpdates = 0;
+	int64 Bits = 0;
+	/** Bits the stock replicated movement takes for the same updates, only measured while sb.Net.MeasureMovementBaseline is on */
+	int64 MovementBits = 0;
+	int64 MeasuredUpdates = 0;
+	int64 ReceivedUpdates = 0;
+	/** Deltas against a base the client never received, skipped until a delta against an acknowledged base arrives */
+	int64 DroppedUpdates = 0;
+	double StartTime = 0.0;
+};
+
+/**
+ * Skate state replicated to simulated proxies in place of the replicated movement.
+ * Values are quantized and sent as deltas against the last state the connection acknowledged, unchanged channels take a single bit.
+ */
+USTRUCT()
+struct FSBSkateNetState
+{
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	/** -1 leaning left, 1 leaning right */
+	float Lean = 0.f;
+	float FrictionMultiplier = 1.f;
+	bool bPushing = false;
+	bool bBraking = false;
+	bool bGrounded = true;
+
+	/**
+	 * Quantizes the values above into the state sent to the clients, called by the server before replicating.
+	 * MovementBits is the size of the stock replicated movement for the bandwidth stats, 0 if it wasn't measured.
+	 */
+	void Quantize(int32 MovementBits);
+
+	/** True once for every update received from the server */
+	bool ConsumeReceivedUpdate();
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+	static FSBSkateNetStats& GetStats();
+	/** Whether the server should serialize the stock replicated movement of every update for the stats */
+	static bool IsMeasuringMovementBaseline();
+
+private:
+	void Dequantize();
+
+	FSBSkateQuantizedState Quantized;
+	int32 QuantizedMovementBits = 0;
+
+	TStaticArray<FSBSkateQuantizedState, SBSkateNetState::HistorySize> ReceivedStates;
+	/** Bit per history slot holding a received state */
+	uint32 ReceivedSlots = 0;
+	bool bReceivedUpdate = false;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSBSkateNetState> : public TStructOpsTypeTraitsBase2<FSBSkateNetState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
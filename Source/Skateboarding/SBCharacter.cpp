@@ -4,20 +4,29 @@
 #include "Engine/LocalPlayer.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GameFramework/Controller.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StaticMesh.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
+#include "Net/UnrealNetwork.h"
 #include "SBCharacterMovementComponent.h"
+#include "Loading/SBLoadingSubsystem.h"
+#include "Loading/SBSkaterDefinition.h"
+#include "Significance/SBSkateSignificanceSubsystem.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
 //////////////////////////////////////////////////////////////////////////
 // ASkateboardingCharacter
 
-ASBCharacter::ASBCharacter()
+ASBCharacter::ASBCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USBCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -40,6 +49,9 @@ ASBCharacter::ASBCharacter()
 	GetCharacterMovement()->BrakingDecelerationWalking = 2000.f;
 	GetCharacterMovement()->BrakingDecelerationFalling = 1500.0f;
 
+	// Nothing to do per frame, the skate camera manager frames the boom
+	PrimaryActorTick.bCanEverTick = false;
+
 	// Create a camera boom (pulls in towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(RootComponent);
@@ -56,6 +68,9 @@ ASBCharacter::ASBCharacter()
 	SkateboardStaticMesh->SetupAttachment(RootComponent);
 	SkateboardStaticMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 
+	// Significance buckets turn the optimizations off for close skaters, they can only be turned on if enabled at registration
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+
 	SkateboardSocket = CreateDefaultSubobject<USceneComponent>(TEXT("SkateboardSocket"));
 	SkateboardSocket->SetupAttachment(RootComponent);
 
@@ -69,46 +84,216 @@ void ASBCharacter::BeginPlay()
 	Super::BeginPlay();
 
 	//Add Input Mapping Context
-	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
+	AddMappingContext();
+
+	WalkingNetUpdateFrequency = NetUpdateFrequency;
+
+	// Visuals follow the interpolated transform between fixed skate steps
+	GetSkateMovementComponent()->AddInterpolatedVisualComponent(GetMesh());
+	GetSkateMovementComponent()->AddInterpolatedVisualComponent(SkateboardSocket);
+
+	StartSkating();
+
+	if (USBSkateSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<USBSkateSignificanceSubsystem>())
 	{
-		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<
-			UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
-		{
-			Subsystem->AddMappingContext(DefaultMappingContext, 0);
-		}
+		SignificanceSubsystem->RegisterSkater(this);
 	}
+}
 
-	StartSkating();
+void ASBCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USBSkateSignificanceSubsystem* SignificanceSubsystem = GetWorld()->GetSubsystem<USBSkateSignificanceSubsystem>())
+	{
+		SignificanceSubsystem->UnregisterSkater(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASBCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Autonomous proxies predict their own skating and get corrections through the character movement
+	DOREPLIFETIME_CONDITION(ASBCharacter, SkateNetState, COND_SimulatedOnly);
+	DOREPLIFETIME_CONDITION(ASBCharacter, SkaterDefinition, COND_InitialOnly);
+}
+
+void ASBCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	const bool bReplicateSkateNetState = ShouldReplicateSkateNetState();
+	if (bReplicateSkateNetState)
+	{
+		CaptureSkateNetState();
+		UpdateSkateNetUpdateFrequency();
+	}
+	else if (WalkingNetUpdateFrequency > 0.f)
+	{
+		NetUpdateFrequency = WalkingNetUpdateFrequency;
+	}
+
+	DOREPLIFETIME_ACTIVE_OVERRIDE_FAST(ASBCharacter, SkateNetState, bReplicateSkateNetState);
+	DOREPLIFETIME_ACTIVE_OVERRIDE_PRIVATE_PROPERTY(AActor, ReplicatedMovement, IsReplicatingMovement() && bReplicateSkateNetState == false);
+}
+
+bool ASBCharacter::ShouldReplicateSkateNetState()
+{
+	// Moves on a moving base and root motion are replicated relative to their source by the character, keep those on the stock path
+	const USBCharacterMovementComponent* MovementComponent = GetSkateMovementComponent();
+	return IsReplicatingMovement() && MovementComponent->MovementMode == MOVE_Custom && MovementComponent->CustomMovementMode == CMOVE_Skate
+		&& GetBasedMovement().HasRelativeLocation() == false && MovementComponent->CurrentRootMotion.HasActiveRootMotionSources() == false
+		&& IsPlayingNetworkedRootMotionMontage() == false;
+}
+
+void ASBCharacter::CaptureSkateNetState()
+{
+	USBCharacterMovementComponent* MovementComponent = GetSkateMovementComponent();
+	SkateNetState.Location = FRepMovement::RebaseOntoZeroOrigin(GetActorLocation(), this);
+	SkateNetState.Velocity = GetVelocity();
+	SkateNetState.Rotation = GetActorRotation();
+	SkateNetState.Lean = MovementComponent->GetLeanDirection();
+	SkateNetState.FrictionMultiplier = MovementComponent->GetFrictionMultiplier();
+	SkateNetState.bPushing = MovementComponent->GetWantsToPush();
+	SkateNetState.bBraking = MovementComponent->GetWantsToBrake();
+	SkateNetState.bGrounded = MovementComponent->GetIsGrounded();
+
+	int32 MovementBits = 0;
+	if (FSBSkateNetState::IsMeasuringMovementBaseline())
+	{
+		FRepMovement Movement = GetReplicatedMovement();
+		FBitWriter MovementWriter(0, true);
+		bool bSuccess = false;
+		Movement.NetSerialize(MovementWriter, nullptr, bSuccess);
+		MovementBits = MovementWriter.GetNumBits();
+	}
+
+	SkateNetState.Quantize(MovementBits);
 }
 
-void ASBCharacter::HandleCameraRotationWhileSkating(float DeltaSeconds)
+void ASBCharacter::UpdateSkateNetUpdateFrequency()
 {
-	if (GetSkateMovementComponent()->MovementMode == MOVE_Walking)
+	if (GetSkateMovementComponent()->GetIsGrounded() == false)
 	{
-		UE_LOG(LogTemplateCharacter, Log, TEXT("MOVE_Walking - dont move camera"));
+		NetUpdateFrequency = MaxSkateNetUpdateFrequency;
 		return;
 	}
 
-	if(CurrentCameraMode == ECameraMode::CameraMode_SkateFreeLook)
+	const float SpeedAlpha = FMath::Clamp(GetVelocity().Size() / SkateNetFullRateSpeed, 0.f, 1.f);
+	NetUpdateFrequency = FMath::Lerp(MinSkateNetUpdateFrequency, MaxSkateNetUpdateFrequency, SpeedAlpha);
+}
+
+void ASBCharacter::OnRep_SkateNetState()
+{
+	if (SkateNetState.ConsumeReceivedUpdate() == false)
 	{
-		UE_LOG(LogTemplateCharacter, Log, TEXT("CameraMode_SkateFreeLook - dont move camera"));
 		return;
 	}
 
-	FVector Vector = (GetActorLocation() - LastPosition) / DeltaSeconds;
-	FVector NormalizedVector = Vector.GetSafeNormal();
-	float Yaw = FMath::RadiansToDegrees(FMath::Atan2(NormalizedVector.Y, NormalizedVector.X));
+	// Proxies keep the stock movement smoothing, fed from the skate state since the replicated movement isn't sent while skating
+	FRepMovement& Movement = GetReplicatedMovement_Mutable();
+	Movement.Location = SkateNetState.Location;
+	Movement.Rotation = SkateNetState.Rotation;
+	Movement.LinearVelocity = SkateNetState.Velocity;
+	Movement.bRepPhysics = false;
+	OnRep_ReplicatedMovement();
+
+	LeanDirection = SkateNetState.Lean;
+	bIsAccelerating = SkateNetState.bPushing;
+	GetSkateMovementComponent()->ApplySkateNetState(SkateNetState);
+}
 
-	CameraBoom->SetRelativeRotation(FRotator(0.f, Yaw, 0.f));
-	LastPosition = GetActorLocation();
+void ASBCharacter::SetSkateInput(float InLean, bool bPush, bool bBrake)
+{
+	USBCharacterMovementComponent* MovementComponent = GetSkateMovementComponent();
+	if (Controller == nullptr || MovementComponent->MovementMode != MOVE_Custom || MovementComponent->CustomMovementMode != CMOVE_Skate)
+	{
+		return;
+	}
+
+	// Queued inputs only change on edges, like the input actions
+	if (InLean != LeanDirection)
+	{
+		LeanDirection = InLean;
+		MovementComponent->SetLeanInput(LeanDirection);
+	}
+	if (bPush != bIsAccelerating)
+	{
+		bIsAccelerating = bPush;
+		MovementComponent->SetWantsToPush(bPush);
+	}
+	if (bBrake != MovementComponent->GetWantsToBrake())
+	{
+		MovementComponent->SetWantsToBrake(bBrake);
+	}
 }
 
+void ASBCharacter::SetSkaterDefinition(const FPrimaryAssetId& InSkaterDefinition)
+{
+	SkaterDefinition = InSkaterDefinition;
+	ApplySkaterDefinition();
+}
 
-void ASBCharacter::Tick(float DeltaSeconds)
+void ASBCharacter::OnRep_SkaterDefinition()
 {
-	Super::Tick(DeltaSeconds);
+	ApplySkaterDefinition();
+}
+
+void ASBCharacter::ApplySkaterDefinition()
+{
+	const USBSkaterDefinition* Definition = UAssetManager::Get().GetPrimaryAssetObject<USBSkaterDefinition>(SkaterDefinition);
+	if (Definition == nullptr)
+	{
+		// Clients load the definition when they first see a skater using it
+		USBLoadingSubsystem* LoadingSubsystem = GetGameInstance() != nullptr ? GetGameInstance()->GetSubsystem<USBLoadingSubsystem>() : nullptr;
+		if (LoadingSubsystem != nullptr && SkaterDefinition.IsValid())
+		{
+			LoadingSubsystem->LoadPrimaryAssets({SkaterDefinition}, TEXT("SkaterLoaded"), FSimpleDelegate::CreateWeakLambda(this, [this]()
+			{
+				if (UAssetManager::Get().GetPrimaryAssetObject(SkaterDefinition) != nullptr)
+				{
+					ApplySkaterDefinition();
+				}
+			}));
+		}
+		return;
+	}
 
-	HandleCameraRotationWhileSkating(DeltaSeconds);
+	if (UStaticMesh* SkateboardMesh = Definition->SkateboardMesh.Get())
+	{
+		SkateboardStaticMesh->SetStaticMesh(SkateboardMesh);
+	}
+
+	UInputMappingContext* MappingContext = Definition->MappingContext.Get();
+	if (MappingContext != nullptr && MappingContext != DefaultMappingContext)
+	{
+		const APlayerController* PlayerController = Cast<APlayerController>(Controller);
+		UEnhancedInputLocalPlayerSubsystem* Subsystem = PlayerController != nullptr
+			? ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()) : nullptr;
+		if (Subsystem != nullptr && DefaultMappingContext != nullptr)
+		{
+			Subsystem->RemoveMappingContext(DefaultMappingContext);
+		}
+
+		DefaultMappingContext = MappingContext;
+		if (HasActorBegunPlay())
+		{
+			AddMappingContext();
+		}
+	}
+}
+
+void ASBCharacter::AddMappingContext()
+{
+	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
+	{
+		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<
+			UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
+		{
+			Subsystem->AddMappingContext(DefaultMappingContext, 0);
+		}
+	}
 }
 
 USBCharacterMovementComponent* ASBCharacter::GetSkateMovementComponent()
@@ -121,12 +306,12 @@ USBCharacterMovementComponent* ASBCharacter::GetSkateMovementComponent()
 	return SkateMovementComponent;
 }
 
-float ASBCharacter::GetLean()
+float ASBCharacter::GetLean() const
 {
 	return LeanDirection;
 }
 
-bool ASBCharacter::GetIsAccelerating()
+bool ASBCharacter::GetIsAccelerating() const
 {
 	return bIsAccelerating;
 }
@@ -152,6 +337,8 @@ void ASBCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompone
 		EnhancedInputComponent->BindAction(AccelerateAction, ETriggerEvent::Completed, this, &ASBCharacter::AccelerateCompleted);
 		EnhancedInputComponent->BindAction(BreakAction, ETriggerEvent::Started, this, &ASBCharacter::BreakStarted);
 		EnhancedInputComponent->BindAction(BreakAction, ETriggerEvent::Completed, this, &ASBCharacter::BreakCompleted);
+		EnhancedInputComponent->BindAction(ManualAction, ETriggerEvent::Started, this, &ASBCharacter::ManualStarted);
+		EnhancedInputComponent->BindAction(ManualAction, ETriggerEvent::Completed, this, &ASBCharacter::ManualCompleted);
 
 		///Walking inputs///
 		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &ASBCharacter::Move);
@@ -193,18 +380,11 @@ void ASBCharacter::ToggleMovementMode()
 
 void ASBCharacter::Jump()
 {
-	if (Controller != nullptr)
+	// Skaters simulated without a controller, like the ones of the headless tools, can jump too
+	if (Controller != nullptr || GetCharacterMovement()->bRunPhysicsWithNoController)
 	{
-		if (GetSkateMovementComponent()->MovementMode == MOVE_Custom
-			&& GetSkateMovementComponent()->CustomMovementMode == CMOVE_Skate
-			&& GetSkateMovementComponent()->GetIsGrounded() == true)
-		{
-			GetSkateMovementComponent()->AddImpulse(GetCapsuleComponent()->GetUpVector() * ImpulseForce, true);
-		}
-		else
-		{
-			Super::Jump();
-		}
+		// While skating the movement turns the jump flag into an ollie before the move clears it, see UpdateCharacterStateBeforeMovement
+		Super::Jump();
 	}
 }
 
@@ -221,31 +401,36 @@ void ASBCharacter::Accelerate()
 		return;
 	}
 
-	const int64 CurrentTicks = FTimespan::FromSeconds(GetWorld()->GetTimeSeconds()).GetTicks();
-	if (FDateTime(CurrentTicks - LastAccelerationTimeTicks).GetSecond() < AccelerationDelay)
-	{
-		return;
-	}
-	//@todo Test with add movement input later
-	GetSkateMovementComponent()->AddImpulse(GetCapsuleComponent()->GetForwardVector() * ImpulseForce, true);
-	LastAccelerationTimeTicks = FTimespan::FromSeconds(GetWorld()->GetTimeSeconds()).GetTicks();
+	// Push cooldown is handled by the skate movement so it can be predicted
+	GetSkateMovementComponent()->SetWantsToPush(true);
 	bIsAccelerating = true;
 }
 
 void ASBCharacter::AccelerateCompleted()
 {
+	GetSkateMovementComponent()->SetWantsToPush(false);
 	bIsAccelerating = false;
 }
 
 void ASBCharacter::BreakStarted()
 {
 	BreakFrictionScalar = 7.f;
-	GetSkateMovementComponent()->SetFrictionMultiplier(BreakFrictionScalar);
+	GetSkateMovementComponent()->SetWantsToBrake(true);
 }
 
 void ASBCharacter::BreakCompleted()
 {
-	GetSkateMovementComponent()->SetFrictionMultiplier(1.f);
+	GetSkateMovementComponent()->SetWantsToBrake(false);
+}
+
+void ASBCharacter::ManualStarted()
+{
+	GetSkateMovementComponent()->SetWantsToManual(true);
+}
+
+void ASBCharacter::ManualCompleted()
+{
+	GetSkateMovementComponent()->SetWantsToManual(false);
 }
 
 void ASBCharacter::Lean(const FInputActionValue& Value)
@@ -258,7 +443,7 @@ void ASBCharacter::Lean(const FInputActionValue& Value)
 		{
 			// input is a float
 			LeanDirection = Value.Get<float>();
-			GetSkateMovementComponent()->AddForce(GetCapsuleComponent()->GetRightVector() * (LeanDirection * LeanRate));
+			GetSkateMovementComponent()->SetLeanInput(LeanDirection);
 		}
 	}
 }
@@ -266,6 +451,7 @@ void ASBCharacter::Lean(const FInputActionValue& Value)
 void ASBCharacter::LeanCompleted()
 {
 	LeanDirection = 0.f;
+	GetSkateMovementComponent()->SetLeanInput(0.f);
 }
 
 void ASBCharacter::Move(const FInputActionValue& Value)
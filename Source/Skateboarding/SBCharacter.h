@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "Replication/SBSkateNetState.h"
 #include "SBCharacter.generated.h"
 
 class USBCharacterMovementComponent;
@@ -29,7 +30,7 @@ class ASBCharacter : public ACharacter
 	GENERATED_BODY()
 
 public:
-	ASBCharacter();
+	ASBCharacter(const FObjectInitializer& ObjectInitializer);
 	
 	/** Camera boom positioning the camera behind the character */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
@@ -63,6 +64,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* BreakAction;
 
+	/** Manual Input Action, held to ride on the back wheels */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	UInputAction* ManualAction;
+
 	/** Lean Input Action */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* LeanAction;
@@ -92,6 +97,26 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Skate")
 	float AccelerationDelay = 1.f; 
 	
+	/** Update rate of a skater standing still, rises with the speed up to MaxSkateNetUpdateFrequency */
+	UPROPERTY(EditAnywhere, Category = "Skate|Replication", meta = (ClampMin = "1"))
+	float MinSkateNetUpdateFrequency = 10.f;
+	/** Update rate at SkateNetFullRateSpeed and in the air, where spins and flips change the pose faster than the speed shows */
+	UPROPERTY(EditAnywhere, Category = "Skate|Replication", meta = (ClampMin = "1"))
+	float MaxSkateNetUpdateFrequency = 30.f;
+	UPROPERTY(EditAnywhere, Category = "Skate|Replication", meta = (ClampMin = "1"))
+	float SkateNetFullRateSpeed = 1500.f;
+
+	/** Sent to simulated proxies instead of the replicated movement while skating */
+	UPROPERTY(ReplicatedUsing = OnRep_SkateNetState)
+	FSBSkateNetState SkateNetState;
+
+	/** Skater definition the game mode spawned this pawn from, its board and controls replace the defaults once loaded */
+	UPROPERTY(ReplicatedUsing = OnRep_SkaterDefinition)
+	FPrimaryAssetId SkaterDefinition;
+
+	/** Net update frequency outside of the skate movement mode */
+	float WalkingNetUpdateFrequency = 0.f;
+
 	/** Socket to attach the skateboard while walking */
 	UPROPERTY(EditAnywhere, Category = "Socket")
 	FName WalkingSkateboardSocket = "hand_r";
@@ -103,13 +128,9 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Socket")
 	FName SkatingSkateboardSocket = "foot_r";
 	
-	FVector LastPosition;
-
 	float LeanDirection;
 	bool bIsAccelerating;
 
-	int64 LastAccelerationTimeTicks;
-
 	ECameraMode CurrentCameraMode = ECameraMode::CameraMode_SkateFreeLook;
 
 	USBCharacterMovementComponent* SkateMovementComponent;
@@ -123,13 +144,28 @@ public:
 	
 	virtual void Jump() override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 	USBCharacterMovementComponent* GetSkateMovementComponent();
 
+	FORCEINLINE float GetImpulseForce() const { return ImpulseForce; }
+	FORCEINLINE float GetBreakFrictionScalar() const { return BreakFrictionScalar; }
+	FORCEINLINE double GetLeanRate() const { return LeanRate; }
+	FORCEINLINE float GetAccelerationDelay() const { return AccelerationDelay; }
+	FORCEINLINE ECameraMode GetCameraMode() const { return CurrentCameraMode; }
+
+	/** Skate input from outside the input actions, e.g. the load test bots. Ignored unless controlled and skating */
+	void SetSkateInput(float InLean, bool bPush, bool bBrake);
+
+	/** Server only, replicated to the clients */
+	void SetSkaterDefinition(const FPrimaryAssetId& InSkaterDefinition);
+
 	UFUNCTION(BlueprintCallable, BlueprintPure)
-	float GetLean();
+	float GetLean() const;
 
 	UFUNCTION(BlueprintCallable, BlueprintPure)
-	bool GetIsAccelerating();
+	bool GetIsAccelerating() const;
 	
 protected:
 	// APawn interface
@@ -137,10 +173,7 @@ protected:
 
 	// To add mapping context
 	virtual void BeginPlay();
-	virtual void Tick(float DeltaSeconds) override;
-
-	/** Make the camera face forward direction if the camera mode desires it */
-	void HandleCameraRotationWhileSkating(float DeltaSeconds);
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	/** Toggles between free look and fixed camera mode while skateboarding */
 	void ToggleCameraMode();
 	/** Called for lean right and left on a skateboard */
@@ -157,6 +190,9 @@ protected:
 	void BreakStarted();
 	/** Resets the friction of the skate physics, stop breaking */
 	void BreakCompleted();
+	/** Pitches the board up on its back wheels while held */
+	void ManualStarted();
+	void ManualCompleted();
 
 	/** Called for movement input while walking */
 	void Move(const FInputActionValue& Value);
@@ -166,4 +202,19 @@ protected:
 	void StartWalking();
 	void StartSkating();
 	void UpdateSkateCameraControlRotation();
+
+	/** Whether the skate state replaces the replicated movement in this update */
+	bool ShouldReplicateSkateNetState();
+	void CaptureSkateNetState();
+	/** Lowers the update rate of slow skaters, their proxies extrapolate well between updates */
+	void UpdateSkateNetUpdateFrequency();
+
+	UFUNCTION()
+	void OnRep_SkateNetState();
+
+	UFUNCTION()
+	void OnRep_SkaterDefinition();
+	/** Loads the Game bundle of the skater definition if needed and applies its board and mapping context */
+	void ApplySkaterDefinition();
+	void AddMappingContext();
 };
\ No newline at end of file
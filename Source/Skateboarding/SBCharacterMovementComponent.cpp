@@ -3,12 +3,113 @@
 
 #include "SBCharacterMovementComponent.h"
 
+#include "SBCharacter.h"
+#include "SBSkateMovementManager.h"
+#include "SBSkateStats.h"
 #include "Components/CapsuleComponent.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/OverlapResult.h"
+#include "Replication/SBSkateNetState.h"
+#include "Engine/GameInstance.h"
 #include "GameFramework/Character.h"
+#include "Score/SBScoreSubsystem.h"
+#include "Grind/SBGrindRailSubsystem.h"
+#include "Surface/SBSurfaceFieldSubsystem.h"
+#include "Surface/SBSurfaceMaterialSubsystem.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY(LogSkateMovement);
+
+namespace
+{
+	/** Adds the cycles spent in its scope to the target counter, does nothing without a target */
+	struct FSBScopedStageTimer
+	{
+		explicit FSBScopedStageTimer(uint64* InTarget)
+			: Target(InTarget)
+			, StartCycles(InTarget != nullptr ? FPlatformTime::Cycles64() : 0)
+		{
+		}
+
+		~FSBScopedStageTimer()
+		{
+			if (Target != nullptr)
+			{
+				*Target += FPlatformTime::Cycles64() - StartCycles;
+			}
+		}
+
+		uint64* Target;
+		uint64 StartCycles;
+	};
+
+	TAutoConsoleVariable<bool> CVarDrawWheelContacts(
+		TEXT("sb.Skate.DrawWheelContacts"),
+		false,
+		TEXT("Draws the wheel probes of every skater and the board plane fitted to their contacts"));
+
+	FAutoConsoleCommandWithWorld DumpContactCacheStatsCommand(
+		TEXT("sb.Skate.ContactCacheStats"),
+		TEXT("Logs how many surface queries the contact cache answered for every skater in the world"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			for (TObjectIterator<USBCharacterMovementComponent> It; It; ++It)
+			{
+				if (It->GetWorld() != World)
+				{
+					continue;
+				}
+
+				const FSBSurfaceContactCacheStats& Stats = It->GetContactCacheStats();
+				UE_LOG(LogSkateMovement, Display, TEXT("%s: %lld cache hits, %lld traces, %.1f%% hit rate"), *GetNameSafe(It->GetOwner()),
+				       Stats.Hits, Stats.Misses, It->GetContactCacheHitRate() * 100.f);
+			}
+		}));
+}
+
+USBCharacterMovementComponent::USBCharacterMovementComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	SetNetworkMoveDataContainer(SkateMoveDataContainer);
+}
 
 void USBCharacterMovementComponent::InitializeComponent()
 {
 	Super::InitializeComponent();
+
+	SkateCharacterOwner = Cast<ASBCharacter>(CharacterOwner);
+
+	if (const USBSurfaceFieldSubsystem* SurfaceFieldSubsystem = GetWorld()->GetSubsystem<USBSurfaceFieldSubsystem>())
+	{
+		SurfaceField = SurfaceFieldSubsystem->GetField();
+	}
+	SurfaceMaterials = GetWorld()->GetSubsystem<USBSurfaceMaterialSubsystem>();
+
+	ScoreSubsystem = UGameInstance::GetSubsystem<USBScoreSubsystem>(GetWorld()->GetGameInstance());
+}
+
+void USBCharacterMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SkateMovementManager = GetWorld()->GetSubsystem<USBSkateMovementManager>();
+	if (SkateMovementManager != nullptr)
+	{
+		SkateMovementManager->RegisterSkater(this);
+	}
+
+	GrindRailSubsystem = GetWorld()->GetSubsystem<USBGrindRailSubsystem>();
+}
+
+void USBCharacterMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (SkateMovementManager != nullptr)
+	{
+		SkateMovementManager->UnregisterSkater(this);
+		SkateMovementManager = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void USBCharacterMovementComponent::PhysCustom(float DeltaTime, int32 Iterations)
@@ -19,129 +120,1346 @@ void USBCharacterMovementComponent::PhysCustom(float DeltaTime, int32 Iterations
 	{
 	case CMOVE_Skate:
 		{
-			PhysSkate(DeltaTime, Iterations);
+			GrindState.Cooldown = FMath::Max(0.f, GrindState.Cooldown - DeltaTime);
+
+			if (CanBatchSkateMovement())
+			{
+				// Steps run later this frame in the skate movement manager, together with the other skaters
+				AccumulateSkateTime(DeltaTime);
+				bSkateStepsDeferred = true;
+			}
+			else if (bUseFixedSkateStep)
+			{
+				PhysSkateFixedStep(DeltaTime, Iterations);
+			}
+			else
+			{
+				PhysSkate(DeltaTime, Iterations);
+				FinishSkateInputMove();
+			}
 			break;
 		}
 	default: ;
 	}
 }
 
-void USBCharacterMovementComponent::SetFrictionMultiplier(float Value)
+void USBCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	if (MovementMode == MOVE_Custom && CustomMovementMode == CMOVE_Skate)
+	{
+		ApplyOllie();
+	}
+}
+
+void USBCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToPush = (Flags & FSavedMove_Skate::FLAG_Push) != 0;
+	bWantsToBrake = (Flags & FSavedMove_Skate::FLAG_Brake) != 0;
+	LeanDirection = (Flags & FSavedMove_Skate::FLAG_LeanRight) != 0 ? 1 : ((Flags & FSavedMove_Skate::FLAG_LeanLeft) != 0 ? -1 : 0);
+
+	// Only set while the server processes a received move, replays keep the input PrepMoveFor restored
+	if (const FSBSkateNetworkMoveData* MoveData = static_cast<const FSBSkateNetworkMoveData*>(GetCurrentNetworkMoveData()))
+	{
+		bWantsToManual = MoveData->bWantsToManual;
+	}
+}
+
+FNetworkPredictionData_Client* USBCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		USBCharacterMovementComponent* MutableThis = const_cast<USBCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Skate(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void USBCharacterMovementComponent::SendClientAdjustment()
+{
+	// A pending adjustment that doesn't acknowledge a good move is a correction of the client position
+	const FNetworkPredictionData_Server_Character* ServerData = HasPredictionData_Server() ? GetPredictionData_Server_Character() : nullptr;
+	if (ServerData != nullptr && ServerData->PendingAdjustment.TimeStamp > 0.f && ServerData->PendingAdjustment.bAckGoodMove == false)
+	{
+		++NumClientCorrections;
+		SB_SKATE_COUNT(ClientCorrections, 1);
+	}
+
+	Super::SendClientAdjustment();
+}
+
+void USBCharacterMovementComponent::SetWantsToPush(bool bValue)
+{
+	FSBSkateInputSample Input = GetQueuedSkateInput();
+	Input.bPush = bValue;
+	QueueSkateInput(Input);
+}
+
+void USBCharacterMovementComponent::SetWantsToBrake(bool bValue)
+{
+	FSBSkateInputSample Input = GetQueuedSkateInput();
+	Input.bBrake = bValue;
+	QueueSkateInput(Input);
+}
+
+void USBCharacterMovementComponent::SetLeanInput(float Value)
+{
+	FSBSkateInputSample Input = GetQueuedSkateInput();
+	Input.Lean = FMath::Abs(Value) < 0.5f ? 0 : static_cast<int8>(FMath::Sign(Value));
+	QueueSkateInput(Input);
+}
+
+void USBCharacterMovementComponent::SetWantsToManual(bool bValue)
+{
+	FSBSkateInputSample Input = GetQueuedSkateInput();
+	Input.bManual = bValue;
+	QueueSkateInput(Input);
+}
+
+FSBSkateInputSample USBCharacterMovementComponent::GetQueuedSkateInput() const
+{
+	if (const FSBSkateInputSample* Newest = SkateInputQueue.GetNewest())
+	{
+		return *Newest;
+	}
+
+	FSBSkateInputSample Input;
+	Input.Lean = LeanDirection;
+	Input.bPush = bWantsToPush;
+	Input.bBrake = bWantsToBrake;
+	Input.bManual = bWantsToManual;
+	return Input;
+}
+
+void USBCharacterMovementComponent::QueueSkateInput(const FSBSkateInputSample& Input)
+{
+	// Triggered input events repeat every frame while held, only changes are queued
+	const FSBSkateInputSample Previous = GetQueuedSkateInput();
+	if (Input.HasSameInput(Previous) == false)
+	{
+		// Steps already accumulated are ahead of the simulation, the input applies from the end of the accumulated time on
+		SkateInputQueue.Add(SkateClock + SkateStepAccumulator, Input, Previous);
+	}
+}
+
+FSBSkateInputSample USBCharacterMovementComponent::GetMoveSkateInput() const
+{
+	FSBSkateInputSample Input;
+	Input.Lean = LeanDirection;
+	Input.bPush = bWantsToPush;
+	Input.bBrake = bWantsToBrake;
+	Input.bManual = bWantsToManual;
+
+	const bool bPushPressed = SkateInputQueue.Peek(Input);
+	Input.bPush |= bPushPressed || bPushLatched;
+	return Input;
+}
+
+void USBCharacterMovementComponent::ConsumeSkateInput(float DeltaTime)
+{
+	// Replayed moves run with the input saved in the move, the queue only feeds new moves
+	if (bClientUpdating == false)
+	{
+		FSBSkateInputSample Input;
+		Input.Lean = LeanDirection;
+		Input.bPush = bWantsToPush;
+		Input.bBrake = bWantsToBrake;
+		Input.bManual = bWantsToManual;
+		bPushLatched |= SkateInputQueue.Consume(SkateClock + DeltaTime, Input);
+		LeanDirection = Input.Lean;
+		bWantsToPush = Input.bPush;
+		bWantsToBrake = Input.bBrake;
+		bWantsToManual = Input.bManual;
+
+		SkateClock += DeltaTime;
+		bSkateStepRanThisMove = true;
+	}
+
+	PushCooldownRemaining = FMath::Max(0.f, PushCooldownRemaining - DeltaTime);
+
+	const bool bPush = bWantsToPush || (bPushLatched && bClientUpdating == false);
+	if (bPush && bIsGrounded && GrindState.IsGrinding() == false && PushCooldownRemaining <= 0.f && SkateCharacterOwner != nullptr)
+	{
+		Velocity += UpdatedComponent->GetForwardVector() * SkateCharacterOwner->GetImpulseForce();
+		PushCooldownRemaining = SkateCharacterOwner->GetAccelerationDelay();
+	}
+}
+
+float USBCharacterMovementComponent::GetSkateHeadingYaw() const
+{
+	return Velocity.ToOrientationRotator().Yaw + AirSpinYaw;
+}
+
+void USBCharacterMovementComponent::FinishSkateInputMove()
+{
+	// A move without a step keeps the latch, so the next move still pushes on both the client and the server
+	if (bSkateStepRanThisMove)
+	{
+		bPushLatched = false;
+		bSkateStepRanThisMove = false;
+	}
+}
+
+void USBCharacterMovementComponent::ApplySkateNetState(const FSBSkateNetState& State)
+{
+	bWantsToPush = State.bPushing;
+	bWantsToBrake = State.bBraking;
+	LeanDirection = FMath::Abs(State.Lean) < 0.5f ? 0 : static_cast<int8>(FMath::Sign(State.Lean));
+	FrictionMultiplier = State.FrictionMultiplier;
+	bIsGrounded = State.bGrounded;
+}
+
+void USBCharacterMovementComponent::AddInterpolatedVisualComponent(USceneComponent* Component)
+{
+	if (Component == nullptr || Component == UpdatedComponent)
+	{
+		return;
+	}
+
+	InterpolatedVisualComponents.Emplace(Component, Component->GetRelativeTransform());
+}
+
+void USBCharacterMovementComponent::SetRecordStageTimings(bool bRecord)
+{
+	bRecordStageTimings = bRecord;
+}
+
+void USBCharacterMovementComponent::SetReducedSkate(bool bReduced)
+{
+	if (bReducedSkate != bReduced)
+	{
+		bReducedSkate = bReduced;
+		ReducedSkateHit = FHitResult();
+		ReducedSkateSteps = 0;
+	}
+}
+
+void USBCharacterMovementComponent::ResetStageTimings()
+{
+	StageTimings = FSBSkateStageTimings();
+}
+
+float USBCharacterMovementComponent::GetContactCacheHitRate() const
 {
-	FrictionMultiplier = Value;
+	const int64 Queries = ContactCacheStats.Hits + ContactCacheStats.Misses;
+	return Queries > 0 ? static_cast<float>(static_cast<double>(ContactCacheStats.Hits) / Queries) : 0.f;
 }
 
-bool USBCharacterMovementComponent::GetIsGrounded()
+bool USBCharacterMovementComponent::GetIsGrounded() const
 {
 	return bIsGrounded;
 }
 
-bool USBCharacterMovementComponent::GetIsSkateInAir()
+bool USBCharacterMovementComponent::GetIsSkateInAir() const
 {
-	bool b = (CustomMovementMode == CMOVE_Skate && GetIsGrounded() == false);
-	FText boolean = b ? FText::FromString("true") : FText::FromString("false");
 	return CustomMovementMode == CMOVE_Skate && GetIsGrounded() == false;
 }
 
+void USBCharacterMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	const bool bWasSkating = PreviousMovementMode == MOVE_Custom && PreviousCustomMode == CMOVE_Skate;
+	const bool bIsSkating = MovementMode == MOVE_Custom && CustomMovementMode == CMOVE_Skate;
+	if (bWasSkating == bIsSkating)
+	{
+		return;
+	}
+
+	SBSkateTrace::OutputSkateMode(CharacterOwner, bIsSkating);
+	if (bIsSkating)
+	{
+		EnterSkate();
+	}
+	else
+	{
+		ExitSkate();
+	}
+}
+
+void USBCharacterMovementComponent::EnterSkate()
+{
+	SkateStepAccumulator = 0.f;
+	AirSpinYaw = 0.f;
+	ContactCache.bValid = false;
+	GrindState = FSBGrindState();
+	bPushLatched = false;
+	TrickRecognizer.Reset();
+	if (UpdatedComponent != nullptr)
+	{
+		PreviousSkateStepTransform = UpdatedComponent->GetComponentTransform();
+		CurrentSkateStepTransform = PreviousSkateStepTransform;
+	}
+}
+
+void USBCharacterMovementComponent::ExitSkate()
+{
+	SkateStepAccumulator = 0.f;
+	bSkateStepsDeferred = false;
+	GrindState = FSBGrindState();
+	bPushLatched = false;
+	bSkateStepRanThisMove = false;
+
+	// Simulated proxies never run the fixed step, their mesh offset belongs to network smoothing
+	if (CharacterOwner != nullptr && CharacterOwner->GetLocalRole() != ROLE_SimulatedProxy)
+	{
+		ResetInterpolatedVisuals();
+	}
+}
+
+void USBCharacterMovementComponent::ApplyOllie()
+{
+	if (SkateCharacterOwner == nullptr || bIsGrounded == false)
+	{
+		return;
+	}
+
+	// Jump input comes through the regular jump flag, the character never jumps by itself in a custom movement mode.
+	// PerformMovement clears the flag before the physics run, so it has to be read before the move.
+	if (CharacterOwner->bPressedJump)
+	{
+		StopGrind();
+		Velocity += UpdatedComponent->GetUpVector() * SkateCharacterOwner->GetImpulseForce();
+	}
+}
+
+void USBCharacterMovementComponent::PhysSkateFixedStep(float DeltaTime, int32 Iterations)
+{
+	AccumulateSkateTime(DeltaTime);
+
+	while (HasPendingSkateStep())
+	{
+		BeginFixedSkateStep();
+		PhysSkate(FixedSkateStep, Iterations);
+		if (EndFixedSkateStep(Iterations) == false)
+		{
+			return;
+		}
+	}
+
+	FinishFixedSkateSteps();
+}
+
+void USBCharacterMovementComponent::AccumulateSkateTime(float DeltaTime)
+{
+	// Time above the substep budget is dropped, so a hitch slows the skater down instead of launching it off a ramp
+	SkateStepAccumulator = FMath::Min(SkateStepAccumulator + DeltaTime, FixedSkateStep * MaxSkateSubsteps);
+}
+
+bool USBCharacterMovementComponent::HasPendingSkateStep() const
+{
+	return SkateStepAccumulator >= FixedSkateStep;
+}
+
+void USBCharacterMovementComponent::BeginFixedSkateStep()
+{
+	SkateStepAccumulator -= FixedSkateStep;
+	RemainingSkateStepTime = SkateStepAccumulator;
+	PreviousSkateStepTransform = UpdatedComponent->GetComponentTransform();
+}
+
+bool USBCharacterMovementComponent::EndFixedSkateStep(int32 Iterations)
+{
+	if (MovementMode != MOVE_Custom || CustomMovementMode != CMOVE_Skate)
+	{
+		// Movement mode changed mid step, hand the remaining time to the new mode. Exiting skate cleared the accumulator
+		StartNewPhysics(RemainingSkateStepTime, Iterations);
+		return false;
+	}
+
+	if (bJustTeleported)
+	{
+		PreviousSkateStepTransform = UpdatedComponent->GetComponentTransform();
+	}
+	return true;
+}
+
+bool USBCharacterMovementComponent::CanBatchSkateMovement() const
+{
+	// Server moves of remote clients have to be simulated when they are received, replays of corrections right away
+	return bUseBatchedSkateMovement && bUseFixedSkateStep && bClientUpdating == false
+		&& USBSkateMovementManager::IsBatchingEnabled()
+		&& CharacterOwner->GetLocalRole() == ROLE_Authority && CharacterOwner->GetRemoteRole() != ROLE_AutonomousProxy
+		&& HasAnimRootMotion() == false && CurrentRootMotion.HasActiveRootMotionSources() == false
+		&& SkateMovementManager != nullptr;
+}
+
+void USBCharacterMovementComponent::FinishFixedSkateSteps()
+{
+	CurrentSkateStepTransform = UpdatedComponent->GetComponentTransform();
+	FinishSkateInputMove();
+
+	UpdateInterpolatedVisuals(SkateStepAccumulator / FixedSkateStep);
+}
+
+void USBCharacterMovementComponent::UpdateInterpolatedVisuals(float Alpha)
+{
+	FTransform RenderTransform;
+	RenderTransform.Blend(PreviousSkateStepTransform, CurrentSkateStepTransform, Alpha);
+	const FTransform Offset = RenderTransform.GetRelativeTransform(CurrentSkateStepTransform);
+
+	for (const TPair<TWeakObjectPtr<USceneComponent>, FTransform>& Visual : InterpolatedVisualComponents)
+	{
+		if (USceneComponent* Component = Visual.Key.Get())
+		{
+			Component->SetRelativeTransform(Visual.Value * Offset);
+		}
+	}
+}
+
+void USBCharacterMovementComponent::ResetInterpolatedVisuals()
+{
+	for (const TPair<TWeakObjectPtr<USceneComponent>, FTransform>& Visual : InterpolatedVisualComponents)
+	{
+		if (USceneComponent* Component = Visual.Key.Get())
+		{
+			Component->SetRelativeTransform(Visual.Value);
+		}
+	}
+}
+
 void USBCharacterMovementComponent::PhysSkate(float DeltaTime, int32 Iterations)
 {
-	if(DeltaTime < MIN_TICK_TIME)
+	SB_SKATE_SCOPE(PhysSkate);
+	FSBScopedStageTimer PhysSkateTimer(bRecordStageTimings ? &StageTimings.PhysSkateCycles : nullptr);
+
+	FSBSkateStep Step;
+	if (GatherSkateStep(DeltaTime, Step) == false)
 	{
 		return;
 	}
 
+	// Same kernel as the batched skate movement, run on a batch of one
+	ScalarKernelBatch.SetNum(1);
+	WriteSkateKernelInput(ScalarKernelBatch, 0, Step);
+	SBSkateKernel::IntegrateForces(ScalarKernelBatch, 0, 1);
+	ReadSkateKernelOutput(ScalarKernelBatch, 0);
+	FinishSkateIntegration(Step);
+
+	ResolveSkateStep(Step, Iterations);
+}
+
+bool USBCharacterMovementComponent::GatherSkateStep(float DeltaTime, FSBSkateStep& OutStep)
+{
+	if(DeltaTime < MIN_TICK_TIME)
+	{
+		return false;
+	}
+
+	StageTimings.Steps += bRecordStageTimings ? 1 : 0;
+	OutStep.DeltaTime = DeltaTime;
+
 	RestorePreAdditiveRootMotionVelocity();
 
-	FHitResult Hit;
-	//Hit a ground surface
-	if (GetSurface(Hit) == true)
+	ConsumeSkateInput(DeltaTime);
+
+	// Brake is continuous, applied every step so the result doesn't depend on the input event rate
+	if (SkateCharacterOwner != nullptr)
+	{
+		FrictionMultiplier = bWantsToBrake ? SkateCharacterOwner->GetBreakFrictionScalar() : 1.f;
+	}
+
+	// Rail is the surface while grinding, there is nothing to query
+	if (GrindState.IsGrinding())
 	{
+		OutStep.bGrinding = true;
+		OutStep.bHasSurface = true;
+		OutStep.Hit.Normal = FVector::UpVector;
+		OutStep.Hit.ImpactNormal = FVector::UpVector;
 		bIsGrounded = true;
-		
-		/// On flat surfaces, DotProduct will be 1.f
-		///    	               \                    |                  /           
-		///   __⬆__  Dot: 1     \ ↗  Dot: 0.7       |➡  Dot: 0       /↘  Dot: -0.7 
-		///	                     \                  |                /
-		
-		const float UpDotProduct = Hit.Normal.Dot(FVector::UpVector);
-
-		//Debugging		
-		// const float RightDotProduct = Hit.Normal.Dot(FVector::RightVector);
-		// const float DownDotProduct = Hit.Normal.Dot(FVector::DownVector);
-		//DrawDebugString(GetWorld(), Hit.Location, FString::Printf(TEXT("Dot(Normal, UpVector): %f"), UpDotProduct), nullptr, FColor::Emerald, DeltaTime, true);
-		//DrawDebugDirectionalArrow(GetWorld(), Hit.Location, Hit.Location + Hit.Normal * 50.f, 100.f, FColor::Green, false, 2.f);
-		
-		// Calculate the parallel acceleration using the magnitude of the parallel gravity force
-		float ScaledMassRelativeToSlope = UpDotProduct / Mass;
-		Velocity += Hit.Normal * GroundGravity * SlopeGravityScale * ScaledMassRelativeToSlope * DeltaTime;
-		
-		//Apply gravity 
-		Velocity += GroundGravity * FVector::DownVector * DeltaTime;
-
-		// Check if we have acceleration along the right vector of the component, and project it onto the right axis (only accelerate right or left)
-		if(FMath::Abs(FVector::DotProduct(Acceleration.GetSafeNormal(), UpdatedComponent->GetRightVector()))> .5f)
-		{
-			//Not sure if this changes much as we are adding force to right/left input
-			Acceleration = Acceleration.ProjectOnTo(UpdatedComponent->GetRightVector());
-		}
-		else
-		{
-			Acceleration = FVector::ZeroVector;
-		} 
-		
-	}// Mid air
-	else
+		SurfaceNormal = FVector::UpVector;
+		return true;
+	}
+
 	{
-		bIsGrounded = false;
-		//Turning not possible mid air
-		Acceleration = FVector::ZeroVector;
-	
-		// Apply skate air gravity 
-		Velocity += AirGravity * FVector::DownVector * DeltaTime;
+		FSBScopedStageTimer SurfaceTimer(bRecordStageTimings ? &StageTimings.GetSurfaceCycles : nullptr);
+		OutStep.bHasSurface = GetSurface(OutStep.Hit);
 	}
 
-	//Calculating Velocity
-	if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	if (OutStep.bHasSurface && SurfaceMaterials != nullptr)
 	{
-		CalcVelocity(DeltaTime, Friction * FrictionMultiplier, true, GetMaxBrakingDeceleration());
+		OutStep.SurfaceResponse = SurfaceMaterials->GetResponse(OutStep.Hit);
 	}
-	ApplyRootMotionToVelocity(DeltaTime);
 
-	Iterations++;
-	bJustTeleported = false;
-	FVector OldLocation = UpdatedComponent->GetComponentLocation();
-	FVector Adjusted = Velocity * DeltaTime;
-	
-	// FQuat NewRotation = UpdatedComponent->GetComponentRotation().Quaternion();
-	// FVector VelocityPlaneDirection = FVector::VectorPlaneProject(Velocity, Hit.Normal).GetSafeNormal();
-	// FQuat NewRotation = FRotationMatrix::MakeFromZX(VelocityPlaneDirection, Hit.Normal).ToQuat();
+	bIsGrounded = OutStep.bHasSurface;
+	SurfaceNormal = OutStep.bHasSurface ? OutStep.Hit.Normal : FVector::UpVector;
+	return true;
+}
 
-	//Rotate player to slope if grounded
-	FRotator GroundAlignment = FRotationMatrix::MakeFromZX(Hit.Normal, UpdatedComponent->GetForwardVector()).Rotator();
-	FRotator DirectionOfMovement = FRotator(GroundAlignment.Euler().X, GroundAlignment.Euler().X, Velocity.ToOrientationRotator().Yaw);
-	GroundAlignment.Yaw = Velocity.ToOrientationRotator().Yaw;
-	FQuat NewRotation = FMath::RInterpTo(UpdatedComponent->GetComponentRotation(), GroundAlignment, DeltaTime, 15.f).Quaternion();
+void USBCharacterMovementComponent::WriteSkateKernelInput(FSBSkateKernelBatch& Batch, int32 Index, const FSBSkateStep& Step) const
+{
+	const FVector Right = UpdatedComponent->GetRightVector();
+	const FVector Normal = Step.bHasSurface ? Step.Hit.Normal : FVector::ZeroVector;
 
-	FHitResult InTime(1.f);
-	SafeMoveUpdatedComponent(Adjusted, NewRotation, true, InTime);
+	Batch.DeltaTime[Index] = Step.DeltaTime;
+	Batch.VelocityX[Index] = Velocity.X;
+	Batch.VelocityY[Index] = Velocity.Y;
+	Batch.VelocityZ[Index] = Velocity.Z;
+	Batch.AccelerationX[Index] = Acceleration.X;
+	Batch.AccelerationY[Index] = Acceleration.Y;
+	Batch.AccelerationZ[Index] = Acceleration.Z;
+	Batch.RightX[Index] = Right.X;
+	Batch.RightY[Index] = Right.Y;
+	Batch.RightZ[Index] = Right.Z;
+	Batch.NormalX[Index] = Normal.X;
+	Batch.NormalY[Index] = Normal.Y;
+	Batch.NormalZ[Index] = Normal.Z;
+	Batch.Surface[Index] = Step.bHasSurface ? 1.f : 0.f;
+	Batch.LeanAcceleration[Index] = SkateCharacterOwner != nullptr ? LeanDirection * SkateCharacterOwner->GetLeanRate() * Step.SurfaceResponse.Grip / Mass : 0.f;
+	Batch.SlopeAcceleration[Index] = GroundGravity * SlopeGravityScale * Step.SurfaceResponse.SlopeResponse / Mass;
+	Batch.GroundGravity[Index] = GroundGravity;
+	Batch.AirGravity[Index] = AirGravity;
+}
+
+void USBCharacterMovementComponent::ReadSkateKernelOutput(const FSBSkateKernelBatch& Batch, int32 Index)
+{
+	Velocity = FVector(Batch.VelocityX[Index], Batch.VelocityY[Index], Batch.VelocityZ[Index]);
+	Acceleration = FVector(Batch.AccelerationX[Index], Batch.AccelerationY[Index], Batch.AccelerationZ[Index]);
+}
+
+void USBCharacterMovementComponent::FinishSkateIntegration(FSBSkateStep& Step)
+{
+	// Lean spins the board in the air, spins end on landing
+	AirSpinYaw = Step.bHasSurface ? 0.f : AirSpinYaw + LeanDirection * AirSpinRate * Step.DeltaTime;
 
-	if (Hit.Time < 1.f)
+	if (Step.bGrinding)
 	{
-		HandleImpact(Hit, DeltaTime, Adjusted);
-		SlideAlongSurface(Adjusted, (1.f - InTime.Time), InTime.Normal, InTime, true);
+		IntegrateGrind(Step);
+		return;
 	}
 
-	if (!bJustTeleported && !HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	//Calculating Velocity
+	if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
 	{
-		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / DeltaTime;
+		CalcVelocity(Step.DeltaTime, Friction * FrictionMultiplier * Step.SurfaceResponse.RollingFriction, true, GetMaxBrakingDeceleration());
 	}
-}
+	ApplyRootMotionToVelocity(Step.DeltaTime);
 
-bool USBCharacterMovementComponent::GetSurface(FHitResult& Hit) const
-{
-	FVector Start = UpdatedComponent->GetComponentLocation();
-	FVector End = Start + CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() * (-1 * CharacterOwner->GetActorUpVector()) * 1.5f;
-	
+	if (bReducedSkate)
+	{
+		// Reduced skaters keep their pitch and roll, only the heading follows the velocity
+		FRotator Rotation = UpdatedComponent->GetComponentRotation();
+		Rotation.Yaw = GetSkateHeadingYaw();
+		Step.NewRotation = Rotation.Quaternion();
+		return;
+	}
+
+	// FVector VelocityPlaneDirection = FVector::VectorPlaneProject(Velocity, Hit.Normal).GetSafeNormal();
+	// FQuat NewRotation = FRotationMatrix::MakeFromZX(VelocityPlaneDirection, Hit.Normal).ToQuat();
+
+	//Rotate player to slope if grounded
+	FSBScopedStageTimer RotationTimer(bRecordStageTimings ? &StageTimings.RotationCycles : nullptr);
+	FRotator GroundAlignment = FRotationMatrix::MakeFromZX(Step.Hit.Normal, UpdatedComponent->GetForwardVector()).Rotator();
+	GroundAlignment.Yaw = GetSkateHeadingYaw();
+	if (bWantsToManual && Step.bHasSurface)
+	{
+		// Nose up on the back wheels, pitched against the ground rather than the world
+		GroundAlignment = (GroundAlignment.Quaternion() * FRotator(ManualPitch, 0.f, 0.f).Quaternion()).Rotator();
+	}
+	Step.NewRotation = FMath::RInterpTo(UpdatedComponent->GetComponentRotation(), GroundAlignment, Step.DeltaTime, 15.f).Quaternion();
+}
+
+void USBCharacterMovementComponent::ResolveSkateStep(const FSBSkateStep& Step, int32 Iterations)
+{
+	if (Step.bGrinding)
+	{
+		ResolveGrindStep(Step);
+		return;
+	}
+
+	const float DeltaTime = Step.DeltaTime;
+
+	Iterations++;
+	bJustTeleported = false;
+	FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	FVector Adjusted = Velocity * DeltaTime;
+
+	FHitResult InTime(1.f);
+	{
+		FSBScopedStageTimer MoveTimer(bRecordStageTimings ? &StageTimings.MoveCycles : nullptr);
+		SafeMoveUpdatedComponent(Adjusted, Step.NewRotation, true, InTime);
+	}
+
+	// Impacts come from what the move ran into, not from the ground under the board
+	if (InTime.bBlockingHit)
+	{
+		HandleImpact(InTime, DeltaTime, Adjusted);
+		SlideAlongSurface(Adjusted, (1.f - InTime.Time), InTime.Normal, InTime, true);
+	}
+
+	if (!bJustTeleported && !HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	{
+		Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / DeltaTime;
+	}
+
+	TryStartGrind();
+	RecordTrickSample(DeltaTime, Step.bHasSurface, Step.Hit);
+}
+
+void USBCharacterMovementComponent::IntegrateGrind(FSBSkateStep& Step)
+{
+	const FSBGrindRails& Rails = GrindRailSubsystem->GetRails();
+	const float DeltaTime = Step.DeltaTime;
+
+	// Gravity pulls along downhill rails, the rail brakes the board like the ground does
+	FVector Tangent;
+	Rails.GetLocation(GrindState.Rail, GrindState.Distance, &Tangent);
+	float Speed = GrindState.Speed - GrindGravity * Tangent.Z * DeltaTime;
+	Speed = FMath::Sign(Speed) * FMath::Max(0.f, FMath::Abs(Speed) - GrindFriction * FrictionMultiplier * DeltaTime);
+
+	GrindState.Speed = Speed;
+	GrindState.Distance += Speed * DeltaTime;
+	Step.bLeftRail = GrindState.Distance < 0.f || GrindState.Distance > Rails.GetRail(GrindState.Rail).Length || FMath::Abs(Speed) < MinGrindSpeed * 0.5f;
+
+	const float HalfHeight = CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	Step.GrindLocation = Rails.GetLocation(GrindState.Rail, GrindState.Distance, &Tangent) + FVector::UpVector * HalfHeight;
+	Velocity = Tangent * Speed;
+
+	FSBScopedStageTimer RotationTimer(bRecordStageTimings ? &StageTimings.RotationCycles : nullptr);
+	const FRotator RailAlignment = FRotationMatrix::MakeFromXZ(Tangent * (Speed < 0.f ? -1.f : 1.f), FVector::UpVector).Rotator();
+	Step.NewRotation = FMath::RInterpTo(UpdatedComponent->GetComponentRotation(), RailAlignment, DeltaTime, 15.f).Quaternion();
+}
+
+void USBCharacterMovementComponent::ResolveGrindStep(const FSBSkateStep& Step)
+{
+	bJustTeleported = false;
+	{
+		// Rail is baked collision, the board rides on it without sweeping
+		FSBScopedStageTimer MoveTimer(bRecordStageTimings ? &StageTimings.MoveCycles : nullptr);
+		MoveUpdatedComponent(Step.GrindLocation - UpdatedComponent->GetComponentLocation(), Step.NewRotation, false);
+	}
+
+	if (Step.bLeftRail)
+	{
+		StopGrind();
+	}
+
+	RecordTrickSample(Step.DeltaTime, Step.bHasSurface, Step.Hit);
+}
+
+void USBCharacterMovementComponent::TryStartGrind()
+{
+	if (bCanGrind == false || GrindRailSubsystem == nullptr || GrindState.IsGrinding() || GrindState.Cooldown > 0.f)
+	{
+		return;
+	}
+
+	// Rails are landed on, a skater rising past one keeps flying
+	if (bIsGrounded == false && Velocity.Z > 0.f)
+	{
+		return;
+	}
+
+	const float HalfHeight = CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+	const FVector Board = UpdatedComponent->GetComponentLocation() - FVector::UpVector * HalfHeight;
+
+	FSBGrindRailPoint RailPoint;
+	if (GrindRailSubsystem->GetRails().FindClosestPoint(Board, GrindSnapRadius, RailPoint) == false
+		|| Board.Z < RailPoint.Location.Z - GrindSnapRadius * 0.5f)
+	{
+		return;
+	}
+
+	const float Speed = Velocity.Dot(RailPoint.Tangent);
+	if (FMath::Abs(Speed) < MinGrindSpeed || FMath::Abs(Speed) < Velocity.Size() * MinGrindAlignment)
+	{
+		return;
+	}
+
+	GrindState.Rail = RailPoint.Rail;
+	GrindState.Distance = RailPoint.Distance;
+	GrindState.Speed = Speed;
+}
+
+void USBCharacterMovementComponent::StopGrind()
+{
+	if (GrindState.IsGrinding())
+	{
+		GrindState.Rail = INDEX_NONE;
+		GrindState.Cooldown = GrindExitCooldown;
+	}
+}
+
+void USBCharacterMovementComponent::RecordTrickSample(float DeltaTime, bool bHasSurface, const FHitResult& Hit)
+{
+	// Replayed moves were already recorded when they were first simulated
+	if (bClientUpdating)
+	{
+		return;
+	}
+
+	SB_SKATE_SCOPE(TrickRecognition);
+
+	const FVector Forward = UpdatedComponent->GetForwardVector();
+	const float Pitch = bHasSurface ? FMath::RadiansToDegrees(FMath::Asin(FMath::Clamp(Forward.Dot(Hit.Normal), -1.f, 1.f))) : 0.f;
+	const bool bOnWall = bHasSurface && Hit.Normal.Z < TrickSettings.WallRideMaxNormalZ;
+
+	// Heading rather than the capsule yaw, the capsule only follows the air spin through interpolation
+	FSBTrickEvent Trick;
+	if (TrickRecognizer.AddSample(DeltaTime, GetSkateHeadingYaw(), Pitch, bHasSurface, bOnWall, GrindState.IsGrinding(), TrickSettings, Trick) == false)
+	{
+		return;
+	}
+
+	SB_SKATE_COUNT(Tricks, 1);
+	SBSkateTrace::OutputTrick(CharacterOwner, static_cast<uint8>(Trick.Trick), Trick.Score);
+
+	APlayerState* PlayerState = CharacterOwner->GetPlayerState();
+	if (ScoreSubsystem != nullptr && PlayerState != nullptr)
+	{
+		ScoreSubsystem->AddTrickScore(PlayerState, Trick);
+	}
+
+	OnTrick.Broadcast(Trick);
+}
+
+bool USBCharacterMovementComponent::GetSurface(FHitResult& Hit)
+{
+	SB_SKATE_SCOPE(GetSurface);
+
+	bool bFieldHasSurface;
+	if (bUseSurfaceField && GetFieldSurface(Hit, bFieldHasSurface))
+	{
+		return bFieldHasSurface;
+	}
+
+	if (bReducedSkate == false)
+	{
+		return GetSceneSurface(Hit);
+	}
+
+	// Every other reduced step slides along the last queried surface
+	if ((ReducedSkateSteps++ & 1) != 0 && ReducedSkateHit.bBlockingHit && IntersectSurfacePlane(ReducedSkateHit, Hit))
+	{
+		return true;
+	}
+
+	const bool bHasSurface = GetSceneSurface(Hit);
+	ReducedSkateHit = bHasSurface ? Hit : FHitResult();
+	return bHasSurface;
+}
+
+bool USBCharacterMovementComponent::GetSceneSurface(FHitResult& Hit)
+{
+	if (bUseAsyncSurfaceProbes)
+	{
+		return GetAsyncSurface(Hit);
+	}
+
+	if (bUseSurfaceContactCache == false)
+	{
+		bool bSinglePlane;
+		return bUseWheelContacts ? TraceWheelSurface(Hit, bSinglePlane) : TraceSurface(Hit);
+	}
+
+	if (QueryContactCache(Hit))
+	{
+		++ContactCacheStats.Hits;
+		return true;
+	}
+
+	++ContactCacheStats.Misses;
+	bool bSinglePlane = true;
+	const bool bHasSurface = bUseWheelContacts ? TraceWheelSurface(Hit, bSinglePlane) : TraceSurface(Hit);
+	UpdateContactCache(bHasSurface && bSinglePlane, Hit);
+	return bHasSurface;
+}
+
+bool USBCharacterMovementComponent::QueryContactCache(FHitResult& Hit) const
+{
+	if (ContactCache.bValid == false)
+	{
+		return false;
+	}
+
+	// Anything that can move may have left the cached plane
+	const UPrimitiveComponent* Component = ContactCache.Component.Get();
+	if (Component == nullptr || Component->Mobility != EComponentMobility::Static)
+	{
+		return false;
+	}
+
+	// Leaving the plane means the skater is going airborne or onto another surface, trace to find out
+	if (IntersectSurfacePlane(ContactCache.Hit, Hit) == false)
+	{
+		return false;
+	}
+
+	// Every wheel has to stay in the trusted region, not just the capsule center
+	const float WheelReach = bUseWheelContacts ? GetWheelReach() : 0.f;
+	const float TrustedRadius = ContactCache.RegionRadius - WheelReach;
+	if (TrustedRadius <= 0.f || FVector::DistSquared(Hit.ImpactPoint, ContactCache.RegionCenter) > FMath::Square(TrustedRadius))
+	{
+		return false;
+	}
+
+	// The region can grow past the edge of a narrow primitive like a ledge or a rail, the plane ends with its bounds
+	const FBox Bounds = Component->Bounds.GetBox().ExpandBy(1.f);
+	FVector TangentX;
+	FVector TangentY;
+	Hit.Normal.FindBestAxisVectors(TangentX, TangentY);
+	TangentX *= WheelReach;
+	TangentY *= WheelReach;
+	return Bounds.IsInsideOrOn(Hit.ImpactPoint + TangentX) && Bounds.IsInsideOrOn(Hit.ImpactPoint - TangentX)
+		&& Bounds.IsInsideOrOn(Hit.ImpactPoint + TangentY) && Bounds.IsInsideOrOn(Hit.ImpactPoint - TangentY);
+}
+
+void USBCharacterMovementComponent::UpdateContactCache(bool bHasSurface, const FHitResult& Hit)
+{
+	UPrimitiveComponent* Component = Hit.GetComponent();
+	if (bHasSurface == false || Component == nullptr || Component->Mobility != EComponentMobility::Static)
+	{
+		ContactCache.bValid = false;
+		return;
+	}
+
+	const bool bConfirmsPlane = ContactCache.bValid
+		&& ContactCache.Component.Get() == Component
+		&& ContactCache.Hit.Normal.Dot(Hit.Normal) >= 0.9999f
+		&& FMath::Abs((Hit.ImpactPoint - ContactCache.Hit.ImpactPoint).Dot(ContactCache.Hit.Normal)) <= 0.5f;
+
+	ContactCache.RegionRadius = bConfirmsPlane ? FMath::Min(ContactCache.RegionRadius * 2.f, MaxContactCacheRadius) : MinContactCacheRadius;
+	ContactCache.RegionCenter = Hit.ImpactPoint;
+	ContactCache.Component = Component;
+	ContactCache.Hit = Hit;
+	ContactCache.bValid = true;
+}
+
+bool USBCharacterMovementComponent::TraceSurface(FHitResult& Hit) const
+{
+	FVector Start;
+	FVector End;
+	GetSurfaceProbe(Start, End);
+	
 	//DrawDebugDirectionalArrow(GetWorld(), Start, End, 100.f, FColor::Red, false, 2.f);
+	SB_SKATE_COUNT(SurfaceTraces, 1);
 	return GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECollisionChannel::ECC_Visibility);
 }
+
+bool USBCharacterMovementComponent::GetFieldSurface(FHitResult& Hit, bool& bOutHasSurface) const
+{
+	if (SurfaceField == nullptr)
+	{
+		return false;
+	}
+
+	if (bUseWheelContacts)
+	{
+		return GetFieldWheelSurface(Hit, bOutHasSurface);
+	}
+
+	FVector Start;
+	FVector End;
+	GetSurfaceProbe(Start, End);
+
+	const ESBSurfaceFieldResult Result = SurfaceField->Probe(Start, End, Hit);
+	if (Result == ESBSurfaceFieldResult::Unknown)
+	{
+		return false;
+	}
+
+	bOutHasSurface = Result == ESBSurfaceFieldResult::Surface;
+
+	if (bTraceDynamicSurfaces)
+	{
+		// Objects that can move aren't baked, only these still go through the physics scene
+		FCollisionObjectQueryParams ObjectQueryParams;
+		ObjectQueryParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+		ObjectQueryParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkateDynamicSurface), false, CharacterOwner);
+
+		FHitResult DynamicHit;
+		SB_SKATE_COUNT(SurfaceTraces, 1);
+		if (GetWorld()->LineTraceSingleByObjectType(DynamicHit, Start, End, ObjectQueryParams, QueryParams)
+			&& (bOutHasSurface == false || DynamicHit.Time < Hit.Time))
+		{
+			Hit = DynamicHit;
+			bOutHasSurface = true;
+		}
+	}
+
+	return true;
+}
+
+bool USBCharacterMovementComponent::TraceWheelSurface(FHitResult& Hit, bool& bOutSinglePlane) const
+{
+	FSBWheelContacts Wheels;
+	GetWheelProbes(Wheels);
+	SweepWheelContacts(Wheels, false);
+	return FitWheelPlane(Wheels, Hit, bOutSinglePlane);
+}
+
+bool USBCharacterMovementComponent::GetFieldWheelSurface(FHitResult& Hit, bool& bOutHasSurface) const
+{
+	FSBWheelContacts Wheels;
+	GetWheelProbes(Wheels);
+
+	// Field samples are cheap, every wheel probes the field on its own
+	for (FSBWheelContact& Wheel : Wheels)
+	{
+		const ESBSurfaceFieldResult Result = SurfaceField->Probe(Wheel.Start, Wheel.End, Wheel.Hit);
+		if (Result == ESBSurfaceFieldResult::Unknown)
+		{
+			return false;
+		}
+		Wheel.bHit = Result == ESBSurfaceFieldResult::Surface;
+	}
+
+	if (bTraceDynamicSurfaces)
+	{
+		// Objects that can move aren't baked, only these still go through the physics scene
+		SweepWheelContacts(Wheels, true);
+	}
+
+	bool bSinglePlane;
+	bOutHasSurface = FitWheelPlane(Wheels, Hit, bSinglePlane);
+	return true;
+}
+
+void USBCharacterMovementComponent::GetWheelProbes(FSBWheelContacts& OutWheels) const
+{
+	FVector Start;
+	FVector End;
+	GetSurfaceProbe(Start, End);
+
+	const FVector Forward = UpdatedComponent->GetForwardVector() * WheelBase * 0.5f;
+	const FVector Right = UpdatedComponent->GetRightVector() * TrackWidth * 0.5f;
+	const FVector Offsets[] = {Forward - Right, Forward + Right, -Forward + Right, -Forward - Right};
+	for (int32 Wheel = 0; Wheel < OutWheels.Num(); ++Wheel)
+	{
+		OutWheels[Wheel].Start = Start + Offsets[Wheel];
+		OutWheels[Wheel].End = End + Offsets[Wheel];
+		OutWheels[Wheel].Hit = FHitResult();
+		OutWheels[Wheel].bHit = false;
+	}
+}
+
+void USBCharacterMovementComponent::SweepWheelContacts(FSBWheelContacts& Wheels, bool bDynamicOnly) const
+{
+	FVector Start;
+	FVector End;
+	GetSurfaceProbe(Start, End);
+
+	// Box around all four probes, aligned with the board
+	const FCollisionShape Box = FCollisionShape::MakeBox(FVector(WheelBase * 0.5f + 1.f, TrackWidth * 0.5f + 1.f, (End - Start).Size() * 0.5f));
+	const FVector BoxCenter = (Start + End) * 0.5f;
+	const FQuat BoxRotation = UpdatedComponent->GetComponentQuat();
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkateWheelContacts), false, CharacterOwner);
+
+	TArray<FOverlapResult> Overlaps;
+	SB_SKATE_COUNT(SurfaceTraces, 1);
+	if (bDynamicOnly)
+	{
+		FCollisionObjectQueryParams ObjectQueryParams;
+		ObjectQueryParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldDynamic);
+		ObjectQueryParams.AddObjectTypesToQuery(ECollisionChannel::ECC_PhysicsBody);
+		GetWorld()->OverlapMultiByObjectType(Overlaps, BoxCenter, BoxRotation, ObjectQueryParams, Box, QueryParams);
+	}
+	else
+	{
+		GetWorld()->OverlapMultiByChannel(Overlaps, BoxCenter, BoxRotation, ECollisionChannel::ECC_Visibility, Box, QueryParams);
+	}
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component == nullptr || (bDynamicOnly == false && Component->GetCollisionResponseToChannel(ECollisionChannel::ECC_Visibility) != ECR_Block))
+		{
+			continue;
+		}
+
+		// Narrow phase against one component, no scene query per wheel
+		for (FSBWheelContact& Wheel : Wheels)
+		{
+			FHitResult WheelHit;
+			if (Component->LineTraceComponent(WheelHit, Wheel.Start, Wheel.End, QueryParams) && (Wheel.bHit == false || WheelHit.Time < Wheel.Hit.Time))
+			{
+				Wheel.Hit = WheelHit;
+				Wheel.bHit = true;
+			}
+		}
+	}
+}
+
+bool USBCharacterMovementComponent::FitWheelPlane(const FSBWheelContacts& Wheels, FHitResult& OutHit, bool& bOutSinglePlane) const
+{
+	bOutSinglePlane = false;
+
+	TArray<const FSBWheelContact*, TInlineAllocator<4>> Contacts;
+	const FSBWheelContact* ClosestContact = nullptr;
+	FVector Centroid = FVector::ZeroVector;
+	FVector AverageNormal = FVector::ZeroVector;
+	for (const FSBWheelContact& Wheel : Wheels)
+	{
+		if (Wheel.bHit == false)
+		{
+			continue;
+		}
+
+		Contacts.Add(&Wheel);
+		Centroid += Wheel.Hit.ImpactPoint;
+		AverageNormal += Wheel.Hit.Normal;
+		if (ClosestContact == nullptr || Wheel.Hit.Time < ClosestContact->Hit.Time)
+		{
+			ClosestContact = &Wheel;
+		}
+	}
+
+	if (Contacts.Num() == 0)
+	{
+		return false;
+	}
+
+	Centroid /= Contacts.Num();
+	AverageNormal = AverageNormal.GetSafeNormal(UE_SMALL_NUMBER, FVector::UpVector);
+
+	FVector Normal = AverageNormal;
+	if (Contacts.Num() >= 3)
+	{
+		// Newell normal of the contacts in order around the board, the least squares plane of a quad
+		FVector NewellNormal = FVector::ZeroVector;
+		for (int32 Index = 0; Index < Contacts.Num(); ++Index)
+		{
+			const FVector Current = Contacts[Index]->Hit.ImpactPoint - Centroid;
+			const FVector Next = Contacts[(Index + 1) % Contacts.Num()]->Hit.ImpactPoint - Centroid;
+			NewellNormal += Current.Cross(Next);
+		}
+		Normal = NewellNormal.GetSafeNormal(UE_SMALL_NUMBER, AverageNormal);
+	}
+	else if (Contacts.Num() == 2)
+	{
+		// Board pivots around the line through both contacts, e.g. one truck on the coping
+		const FVector Axis = (Contacts[1]->Hit.ImpactPoint - Contacts[0]->Hit.ImpactPoint).GetSafeNormal();
+		Normal = (AverageNormal - AverageNormal.Dot(Axis) * Axis).GetSafeNormal(UE_SMALL_NUMBER, AverageNormal);
+	}
+
+	if (Normal.Dot(UpdatedComponent->GetUpVector()) < 0.f)
+	{
+		Normal = -Normal;
+	}
+
+	bOutSinglePlane = Contacts.Num() == Wheels.Num() && Contacts.ContainsByPredicate([ClosestContact, &Normal](const FSBWheelContact* Contact)
+	{
+		return Contact->Hit.GetComponent() != ClosestContact->Hit.GetComponent() || Contact->Hit.Normal.Dot(Normal) < 0.9999f;
+	}) == false;
+
+	// Closest wheel decides the component and material, the board plane goes through the contacts
+	FVector Start;
+	FVector End;
+	GetSurfaceProbe(Start, End);
+	const FVector Probe = End - Start;
+	const float ProbeDotNormal = Probe.Dot(Normal);
+	const float Time = ProbeDotNormal < -UE_KINDA_SMALL_NUMBER ? FMath::Clamp((Centroid - Start).Dot(Normal) / ProbeDotNormal, 0.f, 1.f) : ClosestContact->Hit.Time;
+
+	OutHit = ClosestContact->Hit;
+	OutHit.Time = Time;
+	OutHit.Distance = Probe.Size() * Time;
+	OutHit.TraceStart = Start;
+	OutHit.TraceEnd = End;
+	OutHit.Location = Start + Probe * Time;
+	OutHit.ImpactPoint = OutHit.Location;
+	OutHit.Normal = Normal;
+	OutHit.ImpactNormal = Normal;
+
+#if ENABLE_DRAW_DEBUG
+	if (CVarDrawWheelContacts.GetValueOnGameThread())
+	{
+		for (const FSBWheelContact& Wheel : Wheels)
+		{
+			DrawDebugLine(GetWorld(), Wheel.Start, Wheel.bHit ? Wheel.Hit.ImpactPoint : Wheel.End, Wheel.bHit ? FColor::Green : FColor::Red);
+		}
+		DrawDebugDirectionalArrow(GetWorld(), OutHit.ImpactPoint, OutHit.ImpactPoint + Normal * 50.f, 10.f, FColor::Cyan);
+	}
+#endif
+	return true;
+}
+
+float USBCharacterMovementComponent::GetWheelReach() const
+{
+	return FVector2D(WheelBase, TrackWidth).Size() * 0.5f;
+}
+
+bool USBCharacterMovementComponent::GetAsyncSurface(FHitResult& Hit)
+{
+	UWorld* World = GetWorld();
+
+	// Results of the probes sent last frame, the handles are only valid for one frame after they were issued
+	if (PendingSurfaceProbes.Num() > 0 && World->IsTraceHandleValid(PendingSurfaceProbes[0], false) == false)
+	{
+		PendingSurfaceProbes.Reset();
+	}
+	else if (PendingSurfaceProbes.Num() > 0 && ReadAsyncSurfaceProbes(LastSurfaceProbeHit))
+	{
+		LastSurfaceProbeTime = PendingSurfaceProbeTime;
+		PendingSurfaceProbes.Reset();
+	}
+
+	// One set of probes per frame, substeps reuse the same result
+	if (PendingSurfaceProbes.Num() == 0)
+	{
+		IssueAsyncSurfaceProbes();
+	}
+
+	bool bSinglePlane;
+	const bool bHasRecentProbe = LastSurfaceProbeTime >= 0.0 && World->GetTimeSeconds() - LastSurfaceProbeTime <= MaxAsyncProbeAge;
+	if (bHasRecentProbe == false)
+	{
+		return bUseWheelContacts ? TraceWheelSurface(Hit, bSinglePlane) : TraceSurface(Hit);
+	}
+
+	if (LastSurfaceProbeHit.bBlockingHit == false)
+	{
+		return false;
+	}
+
+	if (IntersectSurfacePlane(LastSurfaceProbeHit, Hit) == false
+		|| FVector::DistSquared(Hit.ImpactPoint, LastSurfaceProbeHit.ImpactPoint) > FMath::Square(MaxAsyncProbeDistance))
+	{
+		// Moved off the probed plane, the extrapolation can't be trusted
+		return bUseWheelContacts ? TraceWheelSurface(Hit, bSinglePlane) : TraceSurface(Hit);
+	}
+
+	return true;
+}
+
+void USBCharacterMovementComponent::IssueAsyncSurfaceProbes()
+{
+	UWorld* World = GetWorld();
+	PendingSurfaceProbeTime = World->GetTimeSeconds();
+
+	if (bUseWheelContacts == false)
+	{
+		FVector Start;
+		FVector End;
+		GetSurfaceProbe(Start, End);
+		SB_SKATE_COUNT(SurfaceTraces, 1);
+		PendingSurfaceProbes.Add(World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECollisionChannel::ECC_Visibility));
+		return;
+	}
+
+	// The batch runs the wheel traces on worker threads, so there's no need for the overlap the blocking wheel probes share
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SkateWheelContacts), false, CharacterOwner);
+	GetWheelProbes(PendingWheelProbes);
+	SB_SKATE_COUNT(SurfaceTraces, PendingWheelProbes.Num());
+	for (const FSBWheelContact& Wheel : PendingWheelProbes)
+	{
+		PendingSurfaceProbes.Add(World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Wheel.Start, Wheel.End, ECollisionChannel::ECC_Visibility, QueryParams));
+	}
+}
+
+bool USBCharacterMovementComponent::ReadAsyncSurfaceProbes(FHitResult& OutHit) const
+{
+	FSBWheelContacts Wheels = PendingWheelProbes;
+	FHitResult ProbeHit;
+	for (int32 Index = 0; Index < PendingSurfaceProbes.Num(); ++Index)
+	{
+		FTraceDatum Datum;
+		if (GetWorld()->QueryTraceData(PendingSurfaceProbes[Index], Datum) == false)
+		{
+			return false;
+		}
+
+		ProbeHit = Datum.OutHits.Num() > 0 ? Datum.OutHits[0] : FHitResult();
+		if (bUseWheelContacts && Index < Wheels.Num())
+		{
+			Wheels[Index].Hit = ProbeHit;
+			Wheels[Index].bHit = ProbeHit.bBlockingHit;
+		}
+	}
+
+	// Probes of one set are issued with the same setting, all four wheels or the center alone
+	bool bSinglePlane;
+	if (bUseWheelContacts && PendingSurfaceProbes.Num() == Wheels.Num() && FitWheelPlane(Wheels, ProbeHit, bSinglePlane) == false)
+	{
+		ProbeHit = FHitResult();
+	}
+
+	OutHit = ProbeHit;
+	return true;
+}
+
+void USBCharacterMovementComponent::GetSurfaceProbe(FVector& OutStart, FVector& OutEnd) const
+{
+	OutStart = UpdatedComponent->GetComponentLocation();
+	OutEnd = OutStart + CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight() * (-1 * CharacterOwner->GetActorUpVector()) * 1.5f;
+}
+
+bool USBCharacterMovementComponent::IntersectSurfacePlane(const FHitResult& PlaneHit, FHitResult& OutHit) const
+{
+	FVector Start;
+	FVector End;
+	GetSurfaceProbe(Start, End);
+
+	const FVector Probe = End - Start;
+	const float ProbeDotNormal = Probe.Dot(PlaneHit.Normal);
+	if (ProbeDotNormal > -UE_KINDA_SMALL_NUMBER)
+	{
+		// Probe runs parallel to or away from the plane
+		return false;
+	}
+
+	const float Time = (PlaneHit.ImpactPoint - Start).Dot(PlaneHit.Normal) / ProbeDotNormal;
+	if (Time < 0.f || Time > 1.f)
+	{
+		return false;
+	}
+
+	OutHit = PlaneHit;
+	OutHit.Time = Time;
+	OutHit.Distance = Probe.Size() * Time;
+	OutHit.TraceStart = Start;
+	OutHit.TraceEnd = End;
+	OutHit.Location = Start + Probe * Time;
+	OutHit.ImpactPoint = OutHit.Location;
+	return true;
+}
+
+void FSavedMove_Skate::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToPush = false;
+	bSavedWantsToBrake = false;
+	bSavedWantsToManual = false;
+	SavedLeanDirection = 0;
+	SavedPushCooldownRemaining = 0.f;
+	SavedSkateStepAccumulator = 0.f;
+	SavedAirSpinYaw = 0.f;
+	SavedGrindState = FSBGrindState();
+	bSavedIsGrounded = true;
+	SavedSkateClock = 0.0;
+}
+
+uint8 FSavedMove_Skate::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedWantsToPush)
+	{
+		Result |= FLAG_Push;
+	}
+	if (bSavedWantsToBrake)
+	{
+		Result |= FLAG_Brake;
+	}
+	if (SavedLeanDirection < 0)
+	{
+		Result |= FLAG_LeanLeft;
+	}
+	else if (SavedLeanDirection > 0)
+	{
+		Result |= FLAG_LeanRight;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_Skate::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_Skate* NewSkateMove = static_cast<const FSavedMove_Skate*>(NewMove.Get());
+	if (bSavedWantsToPush != NewSkateMove->bSavedWantsToPush
+		|| bSavedWantsToBrake != NewSkateMove->bSavedWantsToBrake
+		|| bSavedWantsToManual != NewSkateMove->bSavedWantsToManual
+		|| SavedLeanDirection != NewSkateMove->SavedLeanDirection)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Skate::CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation)
+{
+	Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+	// The combined move runs again from the start of the old move, so it starts from the skate state of the old move too
+	const FSavedMove_Skate* OldSkateMove = static_cast<const FSavedMove_Skate*>(OldMove);
+	SavedPushCooldownRemaining = OldSkateMove->SavedPushCooldownRemaining;
+	SavedSkateStepAccumulator = OldSkateMove->SavedSkateStepAccumulator;
+	SavedAirSpinYaw = OldSkateMove->SavedAirSpinYaw;
+	SavedGrindState = OldSkateMove->SavedGrindState;
+	bSavedIsGrounded = OldSkateMove->bSavedIsGrounded;
+	SavedSkateClock = OldSkateMove->SavedSkateClock;
+
+	USBCharacterMovementComponent* MovementComponent = Cast<USBCharacterMovementComponent>(InCharacter->GetCharacterMovement());
+	RestoreSkateState(*MovementComponent);
+	// Unlike a replay the combined move is a new move, its steps advance the skate clock again
+	MovementComponent->SkateClock = SavedSkateClock;
+}
+
+void FSavedMove_Skate::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	// Queued input is consumed by the first step of the move, the move carries the input after it
+	const USBCharacterMovementComponent* MovementComponent = Cast<USBCharacterMovementComponent>(C->GetCharacterMovement());
+	const FSBSkateInputSample Input = MovementComponent->GetMoveSkateInput();
+	bSavedWantsToPush = Input.bPush;
+	bSavedWantsToBrake = Input.bBrake;
+	bSavedWantsToManual = Input.bManual;
+	SavedLeanDirection = Input.Lean;
+	SavedPushCooldownRemaining = MovementComponent->PushCooldownRemaining;
+	SavedSkateStepAccumulator = MovementComponent->SkateStepAccumulator;
+	SavedAirSpinYaw = MovementComponent->AirSpinYaw;
+	SavedGrindState = MovementComponent->GrindState;
+	bSavedIsGrounded = MovementComponent->bIsGrounded;
+	SavedSkateClock = MovementComponent->SkateClock;
+}
+
+void FSavedMove_Skate::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	USBCharacterMovementComponent* MovementComponent = Cast<USBCharacterMovementComponent>(C->GetCharacterMovement());
+	MovementComponent->bWantsToPush = bSavedWantsToPush;
+	MovementComponent->bWantsToBrake = bSavedWantsToBrake;
+	MovementComponent->bWantsToManual = bSavedWantsToManual;
+	MovementComponent->LeanDirection = SavedLeanDirection;
+	RestoreSkateState(*MovementComponent);
+}
+
+void FSavedMove_Skate::RestoreSkateState(USBCharacterMovementComponent& MovementComponent) const
+{
+	MovementComponent.PushCooldownRemaining = SavedPushCooldownRemaining;
+	MovementComponent.SkateStepAccumulator = SavedSkateStepAccumulator;
+	MovementComponent.AirSpinYaw = SavedAirSpinYaw;
+	MovementComponent.GrindState = SavedGrindState;
+	MovementComponent.bIsGrounded = bSavedIsGrounded;
+}
+
+void FSBSkateNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	bWantsToManual = static_cast<const FSavedMove_Skate&>(ClientMove).bSavedWantsToManual;
+}
+
+bool FSBSkateNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	Ar.SerializeBits(&bWantsToManual, 1);
+	return Ar.IsError() == false;
+}
+
+FSBSkateNetworkMoveDataContainer::FSBSkateNetworkMoveDataContainer()
+{
+	NewMoveData = &SkateMoveData[0];
+	PendingMoveData = &SkateMoveData[1];
+	OldMoveData = &SkateMoveData[2];
+}
+
+FNetworkPredictionData_Client_Skate::FNetworkPredictionData_Client_Skate(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Skate::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Skate());
+}
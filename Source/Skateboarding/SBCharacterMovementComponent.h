@@ -3,15 +3,120 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "WorldCollision.h"
+#include "SBSkateInputQueue.h"
+#include "SBSkateKernel.h"
+#include "Score/SBTrickRecognizer.h"
+#include "Surface/SBSurfaceMaterialTable.h"
 #include "SBCharacterMovementComponent.generated.h"
 
+class ASBCharacter;
+class FSBSurfaceField;
+class USBGrindRailSubsystem;
+class USBScoreSubsystem;
+class USBSkateMovementManager;
+class USBSurfaceMaterialSubsystem;
+struct FSBSkateNetState;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSkateMovement, Log, All);
+
 UENUM(BlueprintType)
 enum ECustomMovementMode
 {
 	CMOVE_Skate UMETA(DisplayName = "Skate"),
 };
 
+/** Cycles spent in each stage of the skate movement, only recorded while stage timings are enabled */
+struct FSBSkateStageTimings
+{
+	uint64 PhysSkateCycles = 0;
+	uint64 GetSurfaceCycles = 0;
+	uint64 RotationCycles = 0;
+	uint64 MoveCycles = 0;
+	int32 Steps = 0;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnSkateTrickNative, const FSBTrickEvent& /*Trick*/);
+
+/** Last traced ground plane and the region around it where the plane is trusted without tracing again */
+struct FSBSurfaceContactCache
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	FHitResult Hit;
+	FVector RegionCenter = FVector::ZeroVector;
+	float RegionRadius = 0.f;
+	bool bValid = false;
+};
+
+/** Ground probe of one wheel and what it hit */
+struct FSBWheelContact
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	FHitResult Hit;
+	bool bHit = false;
+};
+
+/** Front left, front right, rear right and rear left wheel, in order around the board */
+using FSBWheelContacts = TStaticArray<FSBWheelContact, 4>;
+
+/** Rail a skater grinds and how it moves along it */
+struct FSBGrindState
+{
+	int32 Rail = INDEX_NONE;
+	/** Arc length from the start of the rail */
+	float Distance = 0.f;
+	/** Speed along the rail, negative while grinding towards its start */
+	float Speed = 0.f;
+	/** Time left before the skater can snap to a rail again */
+	float Cooldown = 0.f;
+
+	bool IsGrinding() const { return Rail != INDEX_NONE; }
+};
+
+/** State carried between the gather, integrate and resolve phases of a skate step */
+struct FSBSkateStep
+{
+	FHitResult Hit;
+	FQuat NewRotation = FQuat::Identity;
+	/** Response of the ground material, neutral in the air */
+	FSBSurfaceResponse SurfaceResponse;
+	/** Updated component location on the rail after a grind step */
+	FVector GrindLocation = FVector::ZeroVector;
+	float DeltaTime = 0.f;
+	bool bHasSurface = false;
+	bool bGrinding = false;
+	/** Grind step ran off the end of the rail or lost too much speed */
+	bool bLeftRail = false;
+};
+
+/** How many surface queries the contact cache answered without tracing */
+struct FSBSurfaceContactCacheStats
+{
+	int64 Hits = 0;
+	int64 Misses = 0;
+};
+
+/** Skate input the compressed flags have no room for, sent along with every move */
+struct FSBSkateNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	bool bWantsToManual = false;
+
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FSBSkateNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FSBSkateNetworkMoveDataContainer();
+
+	FSBSkateNetworkMoveData SkateMoveData[3];
+};
+
 /**
  * Custom character movement component for skateboarding
  */
@@ -21,17 +126,76 @@ class SKATEBOARDING_API USBCharacterMovementComponent : public UCharacterMovemen
 	GENERATED_BODY()
 
 public:
+	USBCharacterMovementComponent(const FObjectInitializer& ObjectInitializer);
+
 	virtual void InitializeComponent() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	virtual void PhysCustom(float DeltaTime, int32 Iterations) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void SendClientAdjustment() override;
+
+	/**
+	 * Skate inputs, queued with the skate simulation time they arrive at and consumed by the skate step reaching it.
+	 * Saved in the client moves so they can be predicted and replayed.
+	 */
+	void SetWantsToPush(bool bValue);
+	void SetWantsToBrake(bool bValue);
+	void SetLeanInput(float Value);
+	/** Holds the nose up on two wheels while grounded */
+	void SetWantsToManual(bool bValue);
+
+	bool GetWantsToPush() const { return bWantsToPush; }
+	bool GetWantsToBrake() const { return bWantsToBrake; }
+	bool GetWantsToManual() const { return bWantsToManual; }
+	int8 GetLeanDirection() const { return LeanDirection; }
+	float GetFrictionMultiplier() const { return FrictionMultiplier; }
+
+	/** Applies the skate inputs replicated to a simulated proxy, so its animation and simulation follow the skater */
+	void ApplySkateNetState(const FSBSkateNetState& State);
+
+	/** Registers a visual component that is offset to the interpolated skate transform between fixed steps */
+	void AddInterpolatedVisualComponent(USceneComponent* Component);
+
+	const FSBSurfaceContactCacheStats& GetContactCacheStats() const { return ContactCacheStats; }
+
+	/** Share of surface queries answered by the contact cache, from 0 to 1 */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	float GetContactCacheHitRate() const;
+
+	/** Broadcast when the skater finishes a trick, after its score was added */
+	FOnSkateTrickNative OnTrick;
+
+	/** Enables per stage timings of the skate movement, used by the skate benchmark */
+	void SetRecordStageTimings(bool bRecord);
+	const FSBSkateStageTimings& GetStageTimings() const { return StageTimings; }
+	void ResetStageTimings();
+
+	/**
+	 * Cheaper skating for insignificant skaters: the board only turns with the velocity instead of aligning to the ground,
+	 * and every other step extrapolates on the last surface instead of querying it. Never used on predicted skaters.
+	 */
+	void SetReducedSkate(bool bReduced);
+	bool IsReducedSkate() const { return bReducedSkate; }
 
-	void SetFrictionMultiplier(float Value);
+	/** Corrections the server sent to the owning client of this skater, read by the load test report */
+	uint32 GetNumClientCorrections() const { return NumClientCorrections; }
 
 	UFUNCTION(BlueprintCallable, BlueprintPure)
-	bool GetIsGrounded();
+	bool GetIsGrounded() const;
 
 	UFUNCTION(BlueprintCallable, BlueprintPure)
-	bool GetIsSkateInAir();
+	bool GetIsSkateInAir() const;
+
+	/** Normal of the surface under the board at the last skate step, up in the air and on rails */
+	const FVector& GetSurfaceNormal() const { return SurfaceNormal; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	bool GetIsGrinding() const { return GrindState.IsGrinding(); }
 	
 private:
 	UPROPERTY(EditDefaultsOnly, Category = "Skating")
@@ -46,13 +210,332 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Skating")
 	float SlopeGravityScale = 10.f;
 
+	/** Run skate physics on a fixed internal step so the result doesn't depend on frame rate */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Fixed Step")
+	bool bUseFixedSkateStep = true;
+
+	/** Duration in seconds of a single fixed skate step */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Fixed Step", meta = (EditCondition = "bUseFixedSkateStep", ClampMin = "0.002", UIMin = "0.004", UIMax = "0.034"))
+	float FixedSkateStep = 1.f / 120.f;
+
+	/** Max amount of fixed steps per frame, time above this budget is dropped during hitches */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Fixed Step", meta = (EditCondition = "bUseFixedSkateStep", ClampMin = "1", UIMax = "16"))
+	int32 MaxSkateSubsteps = 8;
+
+	/**
+	 * Let the skate movement manager run the fixed steps of this skater together with all other skaters of the world.
+	 * Only skaters simulated by this machine are batched, moves of remote clients still run when the server receives them.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Fixed Step", meta = (EditCondition = "bUseFixedSkateStep"))
+	bool bUseBatchedSkateMovement = true;
+
+	/**
+	 * Query the ground from the baked surface field of the map instead of the physics scene.
+	 * Maps without a baked field, and probes leaving the baked area, fall back to traces.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface")
+	bool bUseSurfaceField = true;
+
+	/**
+	 * Also trace against dynamic objects when the surface field answers, the field only knows the static geometry.
+	 * Costs a scene query every step, which is what the field saves, so it is only worth it on parks with movable ramps.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface", meta = (EditCondition = "bUseSurfaceField"))
+	bool bTraceDynamicSurfaces = false;
+
+	/**
+	 * Reuse the last traced ground plane while the skater stays on a static primitive and inside its bounds.
+	 * Every trace that confirms the plane doubles the trusted region, so flat sections are traced less and less often.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface")
+	bool bUseSurfaceContactCache = true;
+
+	/** Radius of the trusted region around a newly traced ground plane */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface", meta = (EditCondition = "bUseSurfaceContactCache", ClampMin = "0"))
+	float MinContactCacheRadius = 20.f;
+
+	/** Max radius the trusted region can grow to on a flat surface */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface", meta = (EditCondition = "bUseSurfaceContactCache", ClampMin = "0"))
+	float MaxContactCacheRadius = 160.f;
+
+	/**
+	 * Probe the ground with async traces. The engine runs every async trace of a frame as one batch on worker threads,
+	 * skate physics uses the previous frame result extrapolated on the hit plane.
+	 * With wheel contacts every wheel sends its own async trace and the board plane is fitted to their results.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface")
+	bool bUseAsyncSurfaceProbes = false;
+
+	/** Oldest async probe result in seconds that can be extrapolated before falling back to a blocking trace */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface", meta = (EditCondition = "bUseAsyncSurfaceProbes", ClampMin = "0"))
+	float MaxAsyncProbeAge = 0.1f;
+
+	/** Max distance from the probed hit the result can be extrapolated to */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Surface", meta = (EditCondition = "bUseAsyncSurfaceProbes", ClampMin = "0"))
+	float MaxAsyncProbeDistance = 150.f;
+
+	/**
+	 * Probe the ground under the four wheels and fit the board to their contacts, instead of one probe under the capsule center.
+	 * The board bridges ramp lips and coping with one truck on each side rather than snapping from one plane to the other.
+	 * The wheels are tested against the components found by one overlap of the board, never with a scene query per wheel,
+	 * unless bUseAsyncSurfaceProbes sends one async trace per wheel instead.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Wheels")
+	bool bUseWheelContacts = true;
+
+	/** Distance between the front and the rear truck */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Wheels", meta = (EditCondition = "bUseWheelContacts", ClampMin = "0", Units = "cm"))
+	float WheelBase = 60.f;
+
+	/** Distance between the two wheels of a truck */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Wheels", meta = (EditCondition = "bUseWheelContacts", ClampMin = "0", Units = "cm"))
+	float TrackWidth = 20.f;
+
+	/** Snap to the grind rails of the world when landing on them */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Grind")
+	bool bCanGrind = true;
+
+	/** Max distance from the bottom of the capsule to a rail the skater snaps to */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Grind", meta = (EditCondition = "bCanGrind", ClampMin = "0"))
+	float GrindSnapRadius = 30.f;
+
+	/** Cosine of the max angle between the velocity and the rail for a snap */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Grind", meta = (EditCondition = "bCanGrind", ClampMin = "0", ClampMax = "1"))
+	float MinGrindAlignment = 0.7f;
+
+	/** Slowest speed along the rail a grind starts at, grinds end at half of it */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Grind", meta = (EditCondition = "bCanGrind", ClampMin = "0"))
+	float MinGrindSpeed = 150.f;
+
+	/** Deceleration of the board on the rail, scaled by the brake */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Grind", meta = (EditCondition = "bCanGrind", ClampMin = "0"))
+	float GrindFriction = 100.f;
+
+	/** Gravity along downhill rails */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Grind", meta = (EditCondition = "bCanGrind", ClampMin = "0"))
+	float GrindGravity = 980.f;
+
+	/** Time after leaving a rail before the skater can snap again, so popping off a rail doesn't snap right back */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Grind", meta = (EditCondition = "bCanGrind", ClampMin = "0", Units = "s"))
+	float GrindExitCooldown = 0.3f;
+
+	/** Thresholds and scores of the tricks recognized from the skate motion */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Tricks")
+	FSBTrickRecognizerSettings TrickSettings;
+
+	/** Yaw rate the lean input spins the board at in the air, landing lines the board up with the velocity again */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Tricks", meta = (ClampMin = "0", Units = "deg/s"))
+	float AirSpinRate = 540.f;
+
+	/** Board pitch against the ground held by the manual input, above TrickSettings.ManualMinPitch so it scores */
+	UPROPERTY(EditDefaultsOnly, Category = "Skating|Tricks", meta = (ClampMin = "0", ClampMax = "45", Units = "deg"))
+	float ManualPitch = 20.f;
+
 	float FrictionMultiplier = 1.f;
 
 	bool bIsGrounded = true;
+	FVector SurfaceNormal = FVector::UpVector;
+
+	bool bWantsToPush = false;
+	bool bWantsToBrake = false;
+	bool bWantsToManual = false;
+	/** Lean input quantized to -1, 0 or 1, so the client and server simulate the same force */
+	int8 LeanDirection = 0;
+
+	/** Time left before the skater can push again */
+	float PushCooldownRemaining = 0.f;
+
+	/** Yaw the board was spun by since takeoff, on top of the heading of the velocity */
+	float AirSpinYaw = 0.f;
+
+	FSBSkateInputQueue SkateInputQueue;
+	/** Time simulated by the skate steps of this skater, input samples are stamped with it */
+	double SkateClock = 0.0;
+	/** Push went down in a consumed input sample, pushes like a held button until a move has run a skate step */
+	bool bPushLatched = false;
+	bool bSkateStepRanThisMove = false;
+
+	ASBCharacter* SkateCharacterOwner = nullptr;
+
+	USBScoreSubsystem* ScoreSubsystem = nullptr;
+
+	/** Runs the fixed steps of this skater when batching is possible, null if the world has none */
+	USBSkateMovementManager* SkateMovementManager = nullptr;
+
+	FSBTrickRecognizer TrickRecognizer;
+
+	/** Baked surface field of the map, owned by the surface field subsystem */
+	const FSBSurfaceField* SurfaceField = nullptr;
+
+	/** Resolves the ground material to its friction, grip and slope response, null if the world has none */
+	USBSurfaceMaterialSubsystem* SurfaceMaterials = nullptr;
+
+	/** Rails of the world, null if the world has none */
+	const USBGrindRailSubsystem* GrindRailSubsystem = nullptr;
+	FSBGrindState GrindState;
+
+	FSBSurfaceContactCache ContactCache;
+	FSBSurfaceContactCacheStats ContactCacheStats;
+
+	/** Async surface probes in flight, one per wheel with wheel contacts, and the last result they returned */
+	TArray<FTraceHandle, TInlineAllocator<4>> PendingSurfaceProbes;
+	FSBWheelContacts PendingWheelProbes;
+	double PendingSurfaceProbeTime = 0.0;
+	FHitResult LastSurfaceProbeHit;
+	double LastSurfaceProbeTime = -1.0;
+
+	bool bReducedSkate = false;
+	/** Surface the reduced skate steps extrapolate on, and the steps since it was queried */
+	FHitResult ReducedSkateHit;
+	uint32 ReducedSkateSteps = 0;
+
+	/** Simulation time not consumed by the fixed skate steps yet */
+	float SkateStepAccumulator = 0.f;
+	/** Accumulator right after the current step was taken from it, handed to the new movement mode if the step changes it */
+	float RemainingSkateStepTime = 0.f;
+	/** Fixed steps of this frame are run by the skate movement manager */
+	bool bSkateStepsDeferred = false;
+
+	FSBSkateKernelBatch ScalarKernelBatch;
+
+	/** Updated component transform before and after the last fixed skate step, used for render interpolation */
+	FTransform PreviousSkateStepTransform;
+	FTransform CurrentSkateStepTransform;
+
+	/** Visual components offset between fixed steps and their relative transform without interpolation */
+	TArray<TPair<TWeakObjectPtr<USceneComponent>, FTransform>> InterpolatedVisualComponents;
+
+	bool bRecordStageTimings = false;
+	FSBSkateStageTimings StageTimings;
+
+	FSBSkateNetworkMoveDataContainer SkateMoveDataContainer;
+
+	uint32 NumClientCorrections = 0;
 	
 private:	
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+
 	void EnterSkate();
 	void ExitSkate();
+	/** Applies the ollie once per move while the jump is still pressed, pushes are applied per skate step */
+	void ApplyOllie();
+	/** Input after the newest queued sample, the current input if the queue is empty */
+	FSBSkateInputSample GetQueuedSkateInput() const;
+	void QueueSkateInput(const FSBSkateInputSample& Input);
+	/** Input the next move will run with, a push pressed since the last move counts as held */
+	FSBSkateInputSample GetMoveSkateInput() const;
+	/** Takes the input samples the step reaches from the queue and pushes if the cooldown allows */
+	void ConsumeSkateInput(float DeltaTime);
+	/** Releases the latched push once a move has run a skate step with it */
+	void FinishSkateInputMove();
+	/** Yaw the board faces, the velocity heading plus the air spin */
+	float GetSkateHeadingYaw() const;
+	void PhysSkateFixedStep(float DeltaTime, int32 Iterations);
+	void AccumulateSkateTime(float DeltaTime);
+	bool HasPendingSkateStep() const;
+	void BeginFixedSkateStep();
+	/** Returns false if the step left the skate movement mode */
+	bool EndFixedSkateStep(int32 Iterations);
+	void FinishFixedSkateSteps();
+	bool CanBatchSkateMovement() const;
+
+	/** Skate step split in phases, so the skate movement manager can run each phase for all skaters at once */
 	void PhysSkate(float DeltaTime, int32 Iterations);
-	bool GetSurface(FHitResult& Hit) const;
+	bool GatherSkateStep(float DeltaTime, FSBSkateStep& OutStep);
+	void WriteSkateKernelInput(FSBSkateKernelBatch& Batch, int32 Index, const FSBSkateStep& Step) const;
+	void ReadSkateKernelOutput(const FSBSkateKernelBatch& Batch, int32 Index);
+	/** Friction, braking and rotation of the step after the force kernel, game thread only */
+	void FinishSkateIntegration(FSBSkateStep& Step);
+	void ResolveSkateStep(const FSBSkateStep& Step, int32 Iterations);
+	/** Follows the rail instead of the ground forces, the grind counterpart of FinishSkateIntegration */
+	void IntegrateGrind(FSBSkateStep& Step);
+	void ResolveGrindStep(const FSBSkateStep& Step);
+	/** Snaps to the closest rail if the skater lands on it fast enough and along it */
+	void TryStartGrind();
+	void StopGrind();
+	/** Feeds the state after a skate step to the trick recognizer and scores the finished tricks */
+	void RecordTrickSample(float DeltaTime, bool bHasSurface, const FHitResult& Hit);
+	bool GetSurface(FHitResult& Hit);
+	/** Surface from the physics scene, through the async probes or the contact cache when they are enabled */
+	bool GetSceneSurface(FHitResult& Hit);
+	bool TraceSurface(FHitResult& Hit) const;
+	/** Returns the fitted board plane, bOutSinglePlane is false unless all four wheels rest on the same plane of one component */
+	bool TraceWheelSurface(FHitResult& Hit, bool& bOutSinglePlane) const;
+	bool GetAsyncSurface(FHitResult& Hit);
+	void IssueAsyncSurfaceProbes();
+	/** Returns false until every pending probe finished, OutHit is the fitted board plane with wheel contacts */
+	bool ReadAsyncSurfaceProbes(FHitResult& OutHit) const;
+	/** Answers the surface query from the baked field, false if the probe left the baked area */
+	bool GetFieldSurface(FHitResult& Hit, bool& bOutHasSurface) const;
+	bool GetFieldWheelSurface(FHitResult& Hit, bool& bOutHasSurface) const;
+	void GetSurfaceProbe(FVector& OutStart, FVector& OutEnd) const;
+
+	void GetWheelProbes(FSBWheelContacts& OutWheels) const;
+	/** Tests the wheel probes against the components overlapping the board, keeps the closer hit of every wheel */
+	void SweepWheelContacts(FSBWheelContacts& Wheels, bool bDynamicOnly) const;
+	bool FitWheelPlane(const FSBWheelContacts& Wheels, FHitResult& OutHit, bool& bOutSinglePlane) const;
+	/** Farthest a wheel is from the capsule center */
+	float GetWheelReach() const;
+
+	/** Answers the surface query from the contact cache if the probe still lands inside the trusted region */
+	bool QueryContactCache(FHitResult& Hit) const;
+	void UpdateContactCache(bool bHasSurface, const FHitResult& Hit);
+
+	/** Intersects the surface probe with the plane of a previous hit, so a known surface can be queried without tracing */
+	bool IntersectSurfacePlane(const FHitResult& PlaneHit, FHitResult& OutHit) const;
+
+	/** Offsets the registered visual components to the transform blended between the last two fixed steps */
+	void UpdateInterpolatedVisuals(float Alpha);
+	void ResetInterpolatedVisuals();
+
+	friend class FSavedMove_Skate;
+	friend class USBSkateMovementManager;
+};
+
+/** Client move carrying the skate inputs, so skating is predicted and replayed instead of corrected by the server */
+class FSavedMove_Skate : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	enum ESkateCompressedFlags
+	{
+		FLAG_Push = FLAG_Custom_0,
+		FLAG_Brake = FLAG_Custom_1,
+		FLAG_LeanLeft = FLAG_Custom_2,
+		FLAG_LeanRight = FLAG_Custom_3,
+	};
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	bool bSavedWantsToPush = false;
+	bool bSavedWantsToBrake = false;
+	bool bSavedWantsToManual = false;
+	int8 SavedLeanDirection = 0;
+
+	/** Skate simulation state at the start of the move, restored when the move is replayed */
+	float SavedPushCooldownRemaining = 0.f;
+	float SavedSkateStepAccumulator = 0.f;
+	float SavedAirSpinYaw = 0.f;
+	FSBGrindState SavedGrindState;
+	bool bSavedIsGrounded = true;
+	/** Only restored when moves are combined, replays don't advance the skate clock */
+	double SavedSkateClock = 0.0;
+
+	void RestoreSkateState(USBCharacterMovementComponent& MovementComponent) const;
+};
+
+class FNetworkPredictionData_Client_Skate : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	explicit FNetworkPredictionData_Client_Skate(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
 };
@@ -2,14 +2,82 @@
 
 #include "SBGameMode.h"
 #include "SBCharacter.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Loading/SBLoadingSubsystem.h"
+#include "Loading/SBParkDefinition.h"
+#include "Loading/SBSkaterDefinition.h"
 
 ASBGameMode::ASBGameMode()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnBPClass(TEXT("/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter"));
-	if (PlayerPawnBPClass.Class != NULL)
+	// Pawn class comes from the skater definition, loaded asynchronously once the game starts
+}
+
+void ASBGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	USBLoadingSubsystem* LoadingSubsystem = GetGameInstance()->GetSubsystem<USBLoadingSubsystem>();
+	if (LoadingSubsystem == nullptr)
+	{
+		OnContentLoaded();
+		return;
+	}
+
+	// Already loaded with the previous map or by the preload, this completes right away
+	LoadingSubsystem->LoadPrimaryAssets({DefaultSkater, USBParkDefinition::GetParkId(MapName)}, TEXT("ContentLoaded"),
+	                                    FSimpleDelegate::CreateUObject(this, &ASBGameMode::OnContentLoaded));
+}
+
+void ASBGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	if (bContentLoaded == false)
+	{
+		PendingPlayers.AddUnique(NewPlayer);
+		return;
+	}
+
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+}
+
+UClass* ASBGameMode::GetDefaultPawnClassForController_Implementation(AController* InController)
+{
+	if (Skater != nullptr && Skater->PawnClass.Get() != nullptr)
+	{
+		return Skater->PawnClass.Get();
+	}
+	return Super::GetDefaultPawnClassForController_Implementation(InController);
+}
+
+void ASBGameMode::SetPlayerDefaults(APawn* PlayerPawn)
+{
+	Super::SetPlayerDefaults(PlayerPawn);
+
+	if (ASBCharacter* Character = Cast<ASBCharacter>(PlayerPawn))
+	{
+		if (Skater != nullptr)
+		{
+			Character->SetSkaterDefinition(Skater->GetPrimaryAssetId());
+		}
+	}
+}
+
+void ASBGameMode::OnContentLoaded()
+{
+	if (bContentLoaded)
+	{
+		return;
+	}
+	bContentLoaded = true;
+
+	Skater = UAssetManager::Get().GetPrimaryAssetObject<USBSkaterDefinition>(DefaultSkater);
+
+	TArray<TObjectPtr<APlayerController>> Players = MoveTemp(PendingPlayers);
+	for (APlayerController* Player : Players)
 	{
-		DefaultPawnClass = PlayerPawnBPClass.Class;
+		if (IsValid(Player))
+		{
+			HandleStartingNewPlayer(Player);
+		}
 	}
 }
@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "SBGameMode.generated.h"
 
+class USBSkaterDefinition;
+
 UCLASS(minimalapi)
 class ASBGameMode : public AGameModeBase
 {
@@ -13,6 +15,31 @@ class ASBGameMode : public AGameModeBase
 
 public:
 	ASBGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+	virtual UClass* GetDefaultPawnClassForController_Implementation(AController* InController) override;
+	virtual void SetPlayerDefaults(APawn* PlayerPawn) override;
+
+	/** Players wait for the skater and park content to load before they spawn */
+	UFUNCTION(BlueprintPure, Category = "Loading")
+	bool IsContentLoaded() const { return bContentLoaded; }
+
+protected:
+	/** Skater the players spawn as, DefaultPawnClass is used while it is unset */
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Loading")
+	FPrimaryAssetId DefaultSkater;
+
+private:
+	void OnContentLoaded();
+
+	bool bContentLoaded = false;
+
+	UPROPERTY(Transient)
+	TObjectPtr<USBSkaterDefinition> Skater;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<APlayerController>> PendingPlayers;
 };
 
 
@@ -0,0 +1,121 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBPlayerCameraManager.h"
+
+#include "SBCharacter.h"
+#include "SBCharacterMovementComponent.h"
+#include "SBSkateStats.h"
+#include "GameFramework/SpringArmComponent.h"
+
+namespace
+{
+	/** Direction of travel changes below about a degree keep the previous heading, so the heading is only recomputed on turns */
+	constexpr float HeadingChangeDot = 0.9998f;
+}
+
+void FSBCriticallyDampedSpring::Update(float Target, float SmoothTime, float DeltaTime)
+{
+	// Closed form approximation of a critically damped spring, stable for any frame time
+	const float Omega = 2.f / SmoothTime;
+	const float X = Omega * DeltaTime;
+	const float Decay = 1.f / (1.f + X + 0.48f * X * X + 0.235f * X * X * X);
+	const float Offset = Value - Target;
+	const float Temp = (Velocity + Omega * Offset) * DeltaTime;
+	Velocity = (Velocity - Omega * Temp) * Decay;
+	Value = Target + (Offset + Temp) * Decay;
+}
+
+void FSBCriticallyDampedSpring::Reset(float InValue)
+{
+	Value = InValue;
+	Velocity = 0.f;
+}
+
+void ASBPlayerCameraManager::UpdateViewTarget(FTViewTarget& OutVT, float DeltaTime)
+{
+	// Boom is framed before the view is read from the follow camera
+	if (ASBCharacter* Character = Cast<ASBCharacter>(OutVT.Target))
+	{
+		if (FramedCharacter.Get() != Character)
+		{
+			ResetSkateFraming(Character);
+		}
+		UpdateSkateFraming(Character, DeltaTime);
+	}
+
+	Super::UpdateViewTarget(OutVT, DeltaTime);
+}
+
+void ASBPlayerCameraManager::UpdateSkateFraming(ASBCharacter* Character, float DeltaTime)
+{
+	SB_SKATE_SCOPE(Camera);
+
+	USBCharacterMovementComponent* MovementComponent = Character->GetSkateMovementComponent();
+	USpringArmComponent* CameraBoom = Character->GetCameraBoom();
+	if (MovementComponent == nullptr || CameraBoom == nullptr || DeltaTime <= 0.f)
+	{
+		return;
+	}
+
+	const bool bSkating = MovementComponent->MovementMode == MOVE_Custom && MovementComponent->CustomMovementMode == CMOVE_Skate;
+	const bool bInAir = bSkating && MovementComponent->GetIsGrounded() == false;
+	const FVector& Velocity = MovementComponent->Velocity;
+	const float Speed = Velocity.Size2D();
+
+	if (Speed > MinHeadingSpeed)
+	{
+		const FVector2D Direction = FVector2D(Velocity) / Speed;
+		if (Direction.Dot(TravelDirection) < HeadingChangeDot)
+		{
+			TravelDirection = Direction;
+			TravelHeading = FMath::RadiansToDegrees(FMath::Atan2(Direction.Y, Direction.X));
+		}
+	}
+
+	float TargetPitch = 0.f;
+	if (bInAir)
+	{
+		TargetPitch = AirPitch;
+	}
+	else if (bSkating)
+	{
+		TargetPitch = FMath::Clamp(Velocity.Z / FMath::Max(Speed, 1.f) * RampPitchScale, -MaxRampPitch, MaxRampPitch);
+	}
+
+	// Unwound around the current value so the spring turns the short way
+	HeadingSpring.Update(HeadingSpring.Value + FMath::FindDeltaAngleDegrees(HeadingSpring.Value, TravelHeading), HeadingSmoothTime, DeltaTime);
+	HeadingSpring.Value = FRotator::NormalizeAxis(HeadingSpring.Value);
+	LookAheadSpring.Update(bSkating ? FMath::Min(Speed * LookAheadPerSpeed, MaxLookAhead) : 0.f, LookAheadSmoothTime, DeltaTime);
+	LiftSpring.Update(bInAir ? AirLift : 0.f, FramingSmoothTime, DeltaTime);
+	PitchSpring.Update(TargetPitch, FramingSmoothTime, DeltaTime);
+
+	const FRotator HeadingRotation(0.f, HeadingSpring.Value, 0.f);
+	const FVector TargetOffset = HeadingRotation.Vector() * LookAheadSpring.Value + FVector::UpVector * LiftSpring.Value;
+	if (CameraBoom->TargetOffset.Equals(TargetOffset, OffsetTolerance) == false)
+	{
+		CameraBoom->TargetOffset = TargetOffset;
+	}
+
+	// Free look leaves the boom rotation to the controller
+	if (bSkating && Character->GetCameraMode() == CameraMode_SkateFixedForward)
+	{
+		const FRotator BoomRotation(PitchSpring.Value, HeadingSpring.Value, 0.f);
+		if (CameraBoom->GetRelativeRotation().Equals(BoomRotation, RotationTolerance) == false)
+		{
+			CameraBoom->SetRelativeRotation(BoomRotation);
+		}
+	}
+}
+
+void ASBPlayerCameraManager::ResetSkateFraming(ASBCharacter* Character)
+{
+	FramedCharacter = Character;
+
+	TravelHeading = Character->GetActorRotation().Yaw;
+	TravelDirection = FVector2D(Character->GetActorForwardVector()).GetSafeNormal();
+	HeadingSpring.Reset(TravelHeading);
+	LookAheadSpring.Reset(0.f);
+	LiftSpring.Reset(0.f);
+	PitchSpring.Reset(0.f);
+}
@@ -0,0 +1,83 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/PlayerCameraManager.h"
+#include "SBPlayerCameraManager.generated.h"
+
+class ASBCharacter;
+
+/** Critically damped spring, reaches the target as fast as possible without overshooting */
+struct FSBCriticallyDampedSpring
+{
+	float Value = 0.f;
+	float Velocity = 0.f;
+
+	void Update(float Target, float SmoothTime, float DeltaTime);
+	void Reset(float InValue);
+};
+
+/**
+ * Frames the skater from the skate movement: the fixed forward camera turns to the direction of travel,
+ * the boom looks ahead with speed and lifts on ramps and in the air. Every target goes through a critically damped spring,
+ * and the boom is only written when the framing changed noticeably.
+ */
+UCLASS()
+class SKATEBOARDING_API ASBPlayerCameraManager : public APlayerCameraManager
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void UpdateViewTarget(FTViewTarget& OutVT, float DeltaTime) override;
+
+	/** Time the fixed forward camera takes to turn to a new direction of travel */
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera", meta = (ClampMin = "0.01"))
+	float HeadingSmoothTime = 0.35f;
+	/** Below this speed the direction of travel is noise, the camera keeps its heading */
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float MinHeadingSpeed = 50.f;
+
+	/** Boom offset along the direction of travel per unit of speed */
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float LookAheadPerSpeed = 0.1f;
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float MaxLookAhead = 150.f;
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera", meta = (ClampMin = "0.01"))
+	float LookAheadSmoothTime = 0.5f;
+
+	/** Boom lift while airborne, keeps the landing in view */
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float AirLift = 60.f;
+	/** Fixed forward camera pitch while airborne */
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float AirPitch = -15.f;
+	/** Fixed forward camera pitch on ramps, in degrees per unit of rise over run of the direction of travel */
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float RampPitchScale = 25.f;
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float MaxRampPitch = 30.f;
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera", meta = (ClampMin = "0.01"))
+	float FramingSmoothTime = 0.4f;
+
+	/** Boom changes below these are not written */
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float RotationTolerance = 0.05f;
+	UPROPERTY(EditDefaultsOnly, Category = "Skate Camera")
+	float OffsetTolerance = 0.5f;
+
+private:
+	void UpdateSkateFraming(ASBCharacter* Character, float DeltaTime);
+	void ResetSkateFraming(ASBCharacter* Character);
+
+	TWeakObjectPtr<ASBCharacter> FramedCharacter;
+
+	/** Horizontal direction of travel the heading was last computed for */
+	FVector2D TravelDirection = FVector2D::UnitX();
+	float TravelHeading = 0.f;
+
+	FSBCriticallyDampedSpring HeadingSpring;
+	FSBCriticallyDampedSpring LookAheadSpring;
+	FSBCriticallyDampedSpring LiftSpring;
+	FSBCriticallyDampedSpring PitchSpring;
+};
@@ -3,3 +3,85 @@
 
 #include "SBPlayerController.h"
 
+#include "SBPlayerCameraManager.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PawnMovementComponent.h"
+#include "Loading/SBLoadingSubsystem.h"
+
+ASBPlayerController::ASBPlayerController()
+{
+	PlayerCameraManagerClass = ASBPlayerCameraManager::StaticClass();
+}
+
+void ASBPlayerController::AcknowledgePossession(APawn* P)
+{
+	Super::AcknowledgePossession(P);
+
+	USBLoadingSubsystem* LoadingSubsystem = GetGameInstance() != nullptr ? GetGameInstance()->GetSubsystem<USBLoadingSubsystem>() : nullptr;
+	if (LoadingSubsystem != nullptr && P != nullptr && IsLocalController())
+	{
+		LoadingSubsystem->NotifyControllable(this);
+	}
+}
+
+void ASBPlayerController::GetStreamingSourceLocationAndRotation(FVector& OutLocation, FRotator& OutRotation) const
+{
+	Super::GetStreamingSourceLocationAndRotation(OutLocation, OutRotation);
+
+	const APawn* ControlledPawn = GetPawn();
+	if (ControlledPawn == nullptr)
+	{
+		return;
+	}
+
+	// Skate camera trails and swings around the board, the pawn is where the player will be
+	OutLocation = ControlledPawn->GetActorLocation();
+
+	const FVector StreamingVelocity = GetStreamingVelocity();
+	if (StreamingVelocity.IsZero() == false)
+	{
+		OutRotation = StreamingVelocity.Rotation();
+	}
+}
+
+void ASBPlayerController::GetStreamingSourceShapes(TArray<FStreamingSourceShape>& OutShapes) const
+{
+	Super::GetStreamingSourceShapes(OutShapes);
+
+	const FVector StreamingVelocity = GetStreamingVelocity();
+	if (StreamingVelocity.IsZero())
+	{
+		return;
+	}
+
+	// No shapes stand for the grid loading range around the source, it has to be explicit once shapes are added
+	if (OutShapes.IsEmpty())
+	{
+		FStreamingSourceShape& AroundShape = OutShapes.AddDefaulted_GetRef();
+		AroundShape.LoadingRangeScale = MovingLoadingRangeScale;
+	}
+
+	// Source rotation follows the velocity, so ahead is +X in the source space
+	const float LookAheadDistance = FMath::Min(StreamingVelocity.Size() * StreamingLookAheadTime, MaxStreamingLookAheadDistance);
+	const int32 NumShapes = FMath::Clamp(PredictiveStreamingShapes, 1, 8);
+	for (int32 Index = 1; Index <= NumShapes; ++Index)
+	{
+		FStreamingSourceShape& AheadShape = OutShapes.AddDefaulted_GetRef();
+		AheadShape.LoadingRangeScale = PredictiveLoadingRangeScale;
+		AheadShape.Location = FVector(LookAheadDistance * Index / NumShapes, 0.f, 0.f);
+	}
+}
+
+FVector ASBPlayerController::GetStreamingVelocity() const
+{
+	const APawn* ControlledPawn = GetPawn();
+	const UPawnMovementComponent* MovementComponent = ControlledPawn != nullptr ? ControlledPawn->GetMovementComponent() : nullptr;
+	if (MovementComponent == nullptr)
+	{
+		return FVector::ZeroVector;
+	}
+
+	const FVector Velocity = MovementComponent->Velocity;
+	return Velocity.SizeSquared() >= FMath::Square(MinPredictiveStreamingSpeed) ? Velocity : FVector::ZeroVector;
+}
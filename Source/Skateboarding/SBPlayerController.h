@@ -13,5 +13,44 @@ UCLASS()
 class SKATEBOARDING_API ASBPlayerController : public APlayerController
 {
 	GENERATED_BODY()
-	
+
+public:
+	ASBPlayerController();
+
+	/** Reports the load time of the map to the first frame the local player controls its pawn */
+	virtual void AcknowledgePossession(APawn* P) override;
+
+	/** Streaming source follows the pawn along its direction of travel instead of the camera view */
+	virtual void GetStreamingSourceLocationAndRotation(FVector& OutLocation, FRotator& OutRotation) const override;
+	/** Adds shapes ahead of the pawn along its velocity, so cells finish loading before a fast skater reaches them */
+	virtual void GetStreamingSourceShapes(TArray<FStreamingSourceShape>& OutShapes) const override;
+
+protected:
+	/** Seconds of travel at the current velocity covered by the predictive streaming shapes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WorldPartition|Prediction", meta = (ClampMin = "0"))
+	float StreamingLookAheadTime = 1.5f;
+
+	/** Farthest the predictive streaming shapes reach ahead of the pawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WorldPartition|Prediction", meta = (ClampMin = "0"))
+	float MaxStreamingLookAheadDistance = 12800.f;
+
+	/** Below this speed the streaming source is the plain loading range around the pawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WorldPartition|Prediction", meta = (ClampMin = "0"))
+	float MinPredictiveStreamingSpeed = 600.f;
+
+	/** Shapes spread evenly along the look ahead distance */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WorldPartition|Prediction", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 PredictiveStreamingShapes = 2;
+
+	/** Grid loading range scale of the predictive shapes, smaller than the range around the pawn since they only cover the path ahead */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WorldPartition|Prediction", meta = (ClampMin = "0.1", ClampMax = "1"))
+	float PredictiveLoadingRangeScale = 0.6f;
+
+	/** Scale of the loading range around the pawn while predictive shapes are active, cells behind a fast skater are left behind */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WorldPartition|Prediction", meta = (ClampMin = "0.1", ClampMax = "1"))
+	float MovingLoadingRangeScale = 0.75f;
+
+private:
+	/** Velocity the streaming source predicts from, zero without a pawn or below MinPredictiveStreamingSpeed */
+	FVector GetStreamingVelocity() const;
 };
@@ -0,0 +1,70 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateAnimInstance.h"
+
+#include "SBCharacter.h"
+#include "SBCharacterMovementComponent.h"
+
+void FSBSkateAnimInstanceProxy::Initialize(UAnimInstance* InAnimInstance)
+{
+	FAnimInstanceProxy::Initialize(InAnimInstance);
+
+	Skater = Cast<ASBCharacter>(InAnimInstance->TryGetPawnOwner());
+}
+
+void FSBSkateAnimInstanceProxy::PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds)
+{
+	FAnimInstanceProxy::PreUpdate(InAnimInstance, DeltaSeconds);
+
+	ASBCharacter* Character = Skater.Get();
+	if (Character == nullptr)
+	{
+		// Owner can be assigned after the anim instance is initialized
+		Character = Cast<ASBCharacter>(InAnimInstance->TryGetPawnOwner());
+		Skater = Character;
+		if (Character == nullptr)
+		{
+			return;
+		}
+	}
+
+	const USBCharacterMovementComponent* MovementComponent = Character->GetSkateMovementComponent();
+	Snapshot.Lean = Character->GetLean();
+	Snapshot.bAccelerating = Character->GetIsAccelerating();
+	Snapshot.bGrounded = MovementComponent->GetIsGrounded();
+	Snapshot.bSkating = MovementComponent->MovementMode == MOVE_Custom && MovementComponent->CustomMovementMode == CMOVE_Skate;
+	Snapshot.bGrinding = MovementComponent->GetIsGrinding();
+	Snapshot.Velocity = MovementComponent->Velocity;
+	Snapshot.SurfaceNormal = MovementComponent->GetSurfaceNormal();
+	Snapshot.ActorRotation = Character->GetActorQuat();
+}
+
+void USBSkateAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	const FSBSkateAnimSnapshot& Snapshot = GetProxyOnAnyThread<FSBSkateAnimInstanceProxy>().GetSnapshot();
+
+	Lean = FMath::FInterpTo(Lean, Snapshot.Lean, DeltaSeconds, LeanInterpSpeed);
+	bIsAccelerating = Snapshot.bAccelerating;
+	bIsGrounded = Snapshot.bGrounded;
+	bIsSkating = Snapshot.bSkating;
+	bIsSkateInAir = Snapshot.bSkating && Snapshot.bGrounded == false;
+	bIsGrinding = Snapshot.bGrinding;
+	Speed = Snapshot.Velocity.Size();
+
+	SlopeNormal = Snapshot.ActorRotation.UnrotateVector(Snapshot.SurfaceNormal);
+	SlopePitch = FMath::RadiansToDegrees(FMath::Atan2(-SlopeNormal.X, SlopeNormal.Z));
+	SlopeRoll = FMath::RadiansToDegrees(FMath::Atan2(-SlopeNormal.Y, SlopeNormal.Z));
+}
+
+FAnimInstanceProxy* USBSkateAnimInstance::CreateAnimInstanceProxy()
+{
+	return new FSBSkateAnimInstanceProxy(this);
+}
+
+void USBSkateAnimInstance::DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy)
+{
+	delete InProxy;
+}
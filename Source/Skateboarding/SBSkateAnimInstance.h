@@ -0,0 +1,101 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "SBSkateAnimInstance.generated.h"
+
+class ASBCharacter;
+
+/** Skater state the skate pose is driven from, copied on the game thread once per frame */
+struct FSBSkateAnimSnapshot
+{
+	float Lean = 0.f;
+	bool bAccelerating = false;
+	bool bGrounded = true;
+	bool bSkating = false;
+	bool bGrinding = false;
+	FVector Velocity = FVector::ZeroVector;
+	FVector SurfaceNormal = FVector::UpVector;
+	FQuat ActorRotation = FQuat::Identity;
+};
+
+/** Snapshots the skater before the animation update, so the update never touches the character */
+USTRUCT()
+struct SKATEBOARDING_API FSBSkateAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY()
+
+	FSBSkateAnimInstanceProxy() = default;
+	explicit FSBSkateAnimInstanceProxy(UAnimInstance* InAnimInstance)
+		: FAnimInstanceProxy(InAnimInstance)
+	{
+	}
+
+	const FSBSkateAnimSnapshot& GetSnapshot() const { return Snapshot; }
+
+protected:
+	virtual void Initialize(UAnimInstance* InAnimInstance) override;
+	virtual void PreUpdate(UAnimInstance* InAnimInstance, float DeltaSeconds) override;
+
+private:
+	TWeakObjectPtr<ASBCharacter> Skater;
+	FSBSkateAnimSnapshot Snapshot;
+};
+
+/**
+ * Skate anim instance updating on the animation worker threads. The pose reads the members below, which property
+ * access copies on the fast path, instead of calling the skater getters on the game thread.
+ */
+UCLASS(Transient, Blueprintable)
+class SKATEBOARDING_API USBSkateAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
+	virtual void DestroyAnimInstanceProxy(FAnimInstanceProxy* InProxy) override;
+
+	/** How fast the lean blends to the input, 0 snaps */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Skate", meta = (ClampMin = "0"))
+	float LeanInterpSpeed = 8.f;
+
+	/** Lean input from -1 (left) to 1 (right), blended by LeanInterpSpeed */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	float Lean = 0.f;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	bool bIsAccelerating = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	bool bIsGrounded = true;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	bool bIsSkating = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	bool bIsSkateInAir = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	bool bIsGrinding = false;
+
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	float Speed = 0.f;
+
+	/** Surface normal in the space of the skater */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	FVector SlopeNormal = FVector::UpVector;
+
+	/** Degrees the surface rises ahead of the skater */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	float SlopePitch = 0.f;
+
+	/** Degrees the surface rises to the right of the skater */
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Skate")
+	float SlopeRoll = 0.f;
+};
@@ -0,0 +1,53 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateInputQueue.h"
+
+void FSBSkateInputQueue::Add(double Time, const FSBSkateInputSample& Input, const FSBSkateInputSample& Previous)
+{
+	FSBSkateInputSample Sample = Input;
+	Sample.Time = Time;
+	Sample.bPushPressed = Input.bPush && Previous.bPush == false;
+
+	if (Num == Capacity)
+	{
+		// Nothing consumed the queue for a while, fold the change into the newest sample and keep its edge
+		FSBSkateInputSample& Newest = Samples[(Head - 1 + Capacity) % Capacity];
+		Sample.bPushPressed |= Newest.bPushPressed;
+		Newest = Sample;
+		return;
+	}
+
+	Samples[Head] = Sample;
+	Head = (Head + 1) % Capacity;
+	++Num;
+}
+
+bool FSBSkateInputQueue::Consume(double Time, FSBSkateInputSample& InOutInput)
+{
+	bool bPushPressed = false;
+	while (Num > 0 && GetOldest().Time <= Time)
+	{
+		bPushPressed |= GetOldest().bPushPressed;
+		InOutInput = GetOldest();
+		--Num;
+	}
+	return bPushPressed;
+}
+
+bool FSBSkateInputQueue::Peek(FSBSkateInputSample& InOutInput) const
+{
+	bool bPushPressed = false;
+	for (int32 Age = Num - 1; Age >= 0; --Age)
+	{
+		const FSBSkateInputSample& Sample = Samples[(Head - 1 - Age + Capacity) % Capacity];
+		bPushPressed |= Sample.bPushPressed;
+		InOutInput = Sample;
+	}
+	return bPushPressed;
+}
+
+const FSBSkateInputSample* FSBSkateInputQueue::GetNewest() const
+{
+	return Num > 0 ? &Samples[(Head - 1 + Capacity) % Capacity] : nullptr;
+}
@@ -0,0 +1,56 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+
+/** Skate inputs held from a point in skate simulation time on */
+struct FSBSkateInputSample
+{
+	double Time = 0.0;
+	int8 Lean = 0;
+	bool bPush = false;
+	bool bBrake = false;
+	bool bManual = false;
+	/** Push went down since the previous sample, kept when samples are merged so a tap is never lost */
+	bool bPushPressed = false;
+
+	bool HasSameInput(const FSBSkateInputSample& Other) const
+	{
+		return Lean == Other.Lean && bPush == Other.bPush && bBrake == Other.bBrake && bManual == Other.bManual;
+	}
+};
+
+/**
+ * Skate input changes waiting for the skate steps that reach their timestamp.
+ * Fixed capacity ring buffer, a full queue merges new changes into its newest sample instead of allocating.
+ */
+class SKATEBOARDING_API FSBSkateInputQueue
+{
+public:
+	static constexpr int32 Capacity = 32;
+
+	/** Queues the input held from Time on, Previous is the input held before it */
+	void Add(double Time, const FSBSkateInputSample& Input, const FSBSkateInputSample& Previous);
+
+	/** Applies the samples up to Time to the input, returns true if push went down in any of them */
+	bool Consume(double Time, FSBSkateInputSample& InOutInput);
+
+	/** Input after every queued sample without consuming them, returns true if push went down in any of them */
+	bool Peek(FSBSkateInputSample& InOutInput) const;
+
+	/** Newest queued sample, null if the queue is empty */
+	const FSBSkateInputSample* GetNewest() const;
+
+	void Reset() { Head = 0; Num = 0; }
+	int32 GetNum() const { return Num; }
+
+private:
+	const FSBSkateInputSample& GetOldest() const { return Samples[(Head - Num + Capacity) % Capacity]; }
+
+	TStaticArray<FSBSkateInputSample, Capacity> Samples;
+	/** Slot the next sample is written to */
+	int32 Head = 0;
+	int32 Num = 0;
+};
@@ -0,0 +1,65 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateKernel.h"
+
+void FSBSkateKernelBatch::SetNum(int32 InNum)
+{
+	for (TArray<float>* Channel : {&DeltaTime, &VelocityX, &VelocityY, &VelocityZ, &AccelerationX, &AccelerationY, &AccelerationZ,
+	                               &RightX, &RightY, &RightZ, &NormalX, &NormalY, &NormalZ, &Surface, &LeanAcceleration,
+	                               &SlopeAcceleration, &GroundGravity, &AirGravity})
+	{
+		Channel->SetNumUninitialized(InNum, false);
+	}
+}
+
+void SBSkateKernel::IntegrateForces(FSBSkateKernelBatch& Batch, int32 Begin, int32 End)
+{
+	float* RESTRICT VelocityX = Batch.VelocityX.GetData();
+	float* RESTRICT VelocityY = Batch.VelocityY.GetData();
+	float* RESTRICT VelocityZ = Batch.VelocityZ.GetData();
+	float* RESTRICT AccelerationX = Batch.AccelerationX.GetData();
+	float* RESTRICT AccelerationY = Batch.AccelerationY.GetData();
+	float* RESTRICT AccelerationZ = Batch.AccelerationZ.GetData();
+	const float* RESTRICT DeltaTime = Batch.DeltaTime.GetData();
+	const float* RESTRICT RightX = Batch.RightX.GetData();
+	const float* RESTRICT RightY = Batch.RightY.GetData();
+	const float* RESTRICT RightZ = Batch.RightZ.GetData();
+	const float* RESTRICT NormalX = Batch.NormalX.GetData();
+	const float* RESTRICT NormalY = Batch.NormalY.GetData();
+	const float* RESTRICT NormalZ = Batch.NormalZ.GetData();
+	const float* RESTRICT Surface = Batch.Surface.GetData();
+	const float* RESTRICT LeanAcceleration = Batch.LeanAcceleration.GetData();
+	const float* RESTRICT SlopeAcceleration = Batch.SlopeAcceleration.GetData();
+	const float* RESTRICT GroundGravity = Batch.GroundGravity.GetData();
+	const float* RESTRICT AirGravity = Batch.AirGravity.GetData();
+
+	for (int32 Index = Begin; Index < End; ++Index)
+	{
+		const float Step = DeltaTime[Index];
+		const float OnSurface = Surface[Index];
+
+		/// On flat surfaces, NormalZ (the dot product with the up vector) will be 1.f
+		///    	               \                    |                  /           
+		///   __⬆__  Dot: 1     \ ↗  Dot: 0.7       |➡  Dot: 0       /↘  Dot: -0.7 
+		///	                     \                  |                /
+
+		// Lean pushes sideways, the slope pushes along the normal scaled by how flat the surface is
+		const float Lean = LeanAcceleration[Index] * Step;
+		const float Slope = OnSurface * SlopeAcceleration[Index] * NormalZ[Index] * Step;
+		const float Gravity = (OnSurface * GroundGravity[Index] + (1.f - OnSurface) * AirGravity[Index]) * Step;
+
+		VelocityX[Index] += RightX[Index] * Lean + NormalX[Index] * Slope;
+		VelocityY[Index] += RightY[Index] * Lean + NormalY[Index] * Slope;
+		VelocityZ[Index] += RightZ[Index] * Lean + NormalZ[Index] * Slope - Gravity;
+
+		// Only steering survives, on the ground and when the input mostly points to the side
+		const float AccelerationDotRight = AccelerationX[Index] * RightX[Index] + AccelerationY[Index] * RightY[Index] + AccelerationZ[Index] * RightZ[Index];
+		const float AccelerationSizeSquared = AccelerationX[Index] * AccelerationX[Index] + AccelerationY[Index] * AccelerationY[Index] + AccelerationZ[Index] * AccelerationZ[Index];
+		const float Steering = OnSurface * (AccelerationDotRight * AccelerationDotRight > 0.25f * AccelerationSizeSquared ? AccelerationDotRight : 0.f);
+
+		AccelerationX[Index] = RightX[Index] * Steering;
+		AccelerationY[Index] = RightY[Index] * Steering;
+		AccelerationZ[Index] = RightZ[Index] * Steering;
+	}
+}
@@ -0,0 +1,54 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Skate forces of many skaters as struct of arrays, element i of every array belongs to skater i.
+ * Filled during the gather phase, integrated by SBSkateKernel::IntegrateForces and read back by the movement components.
+ */
+struct FSBSkateKernelBatch
+{
+	void SetNum(int32 InNum);
+	int32 Num() const { return DeltaTime.Num(); }
+
+	TArray<float> DeltaTime;
+
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+
+	TArray<float> AccelerationX;
+	TArray<float> AccelerationY;
+	TArray<float> AccelerationZ;
+
+	/** Right vector of the skater, lean pushes and steering input go along it */
+	TArray<float> RightX;
+	TArray<float> RightY;
+	TArray<float> RightZ;
+
+	/** Ground normal, only read when the skater has a surface */
+	TArray<float> NormalX;
+	TArray<float> NormalY;
+	TArray<float> NormalZ;
+
+	/** 1 on the ground, 0 in the air */
+	TArray<float> Surface;
+
+	/** Lean direction * lean rate / mass */
+	TArray<float> LeanAcceleration;
+	/** Ground gravity * slope gravity scale / mass */
+	TArray<float> SlopeAcceleration;
+	TArray<float> GroundGravity;
+	TArray<float> AirGravity;
+};
+
+namespace SBSkateKernel
+{
+	/**
+	 * Applies lean, slope and gravity to the velocities of the elements in [Begin, End) and keeps only the steering part of the acceleration.
+	 * Branchless and free of engine types so the loop can be vectorized, used by both the scalar and the batched skate movement.
+	 */
+	void IntegrateForces(FSBSkateKernelBatch& Batch, int32 Begin, int32 End);
+}
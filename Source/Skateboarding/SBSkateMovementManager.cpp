@@ -0,0 +1,231 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateMovementManager.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "SBSkateStats.h"
+
+namespace
+{
+	TAutoConsoleVariable<bool> CVarBatchSkateMovement(
+		TEXT("sb.Skate.BatchMovement"),
+		true,
+		TEXT("Runs the fixed skate steps of the skaters this machine simulates itself in one batch, remote clients' moves on a server are not batched"));
+
+	/** Adds the cycles spent in its scope to the target counter */
+	struct FSBScopedBatchTimer
+	{
+		explicit FSBScopedBatchTimer(uint64& InTarget)
+			: Target(InTarget)
+			, StartCycles(FPlatformTime::Cycles64())
+		{
+		}
+
+		~FSBScopedBatchTimer()
+		{
+			Target += FPlatformTime::Cycles64() - StartCycles;
+		}
+
+		uint64& Target;
+		uint64 StartCycles;
+	};
+}
+
+void FSBSkateMovementTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager != nullptr)
+	{
+		Manager->UpdateSkaters();
+	}
+}
+
+FString FSBSkateMovementTickFunction::DiagnosticMessage()
+{
+	return TEXT("FSBSkateMovementTickFunction");
+}
+
+void USBSkateMovementManager::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Skaters tick in pre physics, the batch runs after all of them and before their meshes animate
+	TickFunction.Manager = this;
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+}
+
+void USBSkateMovementManager::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Manager = nullptr;
+	Skaters.Reset();
+
+	Super::Deinitialize();
+}
+
+void USBSkateMovementManager::RegisterSkater(USBCharacterMovementComponent* Skater)
+{
+	Skaters.AddUnique(Skater);
+	AddTickDependencies(Skater);
+}
+
+void USBSkateMovementManager::UnregisterSkater(USBCharacterMovementComponent* Skater)
+{
+	Skaters.RemoveSingleSwap(Skater, false);
+	RemoveTickDependencies(Skater);
+}
+
+void USBSkateMovementManager::UpdateSkaters()
+{
+	ActiveSkaters.Reset();
+	int32 NumSkating = 0;
+	int32 NumAirborne = 0;
+	int32 NumGrinding = 0;
+	for (const TWeakObjectPtr<USBCharacterMovementComponent>& Skater : Skaters)
+	{
+		if (Skater.IsValid() == false)
+		{
+			continue;
+		}
+
+		if (Skater->MovementMode == MOVE_Custom && Skater->CustomMovementMode == CMOVE_Skate)
+		{
+			++NumSkating;
+			NumAirborne += Skater->bIsGrounded ? 0 : 1;
+			NumGrinding += Skater->GrindState.IsGrinding() ? 1 : 0;
+		}
+
+		if (Skater->bSkateStepsDeferred)
+		{
+			ActiveSkaters.Add(Skater.Get());
+		}
+	}
+
+	SB_SKATE_SET_COUNT(ActiveSkaters, NumSkating);
+	SB_SKATE_SET_COUNT(AirborneSkaters, NumAirborne);
+	SB_SKATE_SET_COUNT(GrindingSkaters, NumGrinding);
+
+	if (ActiveSkaters.Num() == 0)
+	{
+		return;
+	}
+
+	// One iteration per fixed step, skaters drop out once their accumulator is used up
+	while (true)
+	{
+		SteppingSkaters.Reset();
+		Steps.Reset();
+		{
+			SB_SKATE_SCOPE(BatchGather);
+			FSBScopedBatchTimer GatherTimer(Timings.GatherCycles);
+			for (USBCharacterMovementComponent* Skater : ActiveSkaters)
+			{
+				if (Skater->bSkateStepsDeferred == false || Skater->HasPendingSkateStep() == false)
+				{
+					continue;
+				}
+
+				Skater->BeginFixedSkateStep();
+				FSBSkateStep& Step = Steps.AddDefaulted_GetRef();
+				if (Skater->GatherSkateStep(Skater->FixedSkateStep, Step))
+				{
+					SteppingSkaters.Add(Skater);
+				}
+				else
+				{
+					Steps.Pop(false);
+				}
+			}
+
+			Batch.SetNum(SteppingSkaters.Num());
+			for (int32 Index = 0; Index < SteppingSkaters.Num(); ++Index)
+			{
+				SteppingSkaters[Index]->WriteSkateKernelInput(Batch, Index, Steps[Index]);
+			}
+		}
+
+		if (SteppingSkaters.Num() == 0)
+		{
+			break;
+		}
+
+		{
+			SB_SKATE_SCOPE(BatchIntegrate);
+			FSBScopedBatchTimer IntegrateTimer(Timings.IntegrateCycles);
+			SBSkateKernel::IntegrateForces(Batch, 0, SteppingSkaters.Num());
+		}
+
+		{
+			SB_SKATE_SCOPE(BatchResolve);
+			FSBScopedBatchTimer ResolveTimer(Timings.ResolveCycles);
+			for (int32 Index = 0; Index < SteppingSkaters.Num(); ++Index)
+			{
+				// Friction and rotation go through the character movement code, which is only safe on the game thread
+				SteppingSkaters[Index]->ReadSkateKernelOutput(Batch, Index);
+				SteppingSkaters[Index]->FinishSkateIntegration(Steps[Index]);
+				SteppingSkaters[Index]->ResolveSkateStep(Steps[Index], 0);
+				SteppingSkaters[Index]->EndFixedSkateStep(0);
+			}
+		}
+
+		++Timings.Steps;
+		Timings.SkaterSteps += SteppingSkaters.Num();
+	}
+
+	// Skaters that left the skate mode mid step were already handed to their new movement mode
+	for (USBCharacterMovementComponent* Skater : ActiveSkaters)
+	{
+		if (Skater->bSkateStepsDeferred)
+		{
+			Skater->bSkateStepsDeferred = false;
+			Skater->FinishFixedSkateSteps();
+			Skater->UpdateComponentVelocity();
+		}
+	}
+}
+
+bool USBSkateMovementManager::IsBatchingEnabled()
+{
+	return CVarBatchSkateMovement.GetValueOnGameThread();
+}
+
+bool USBSkateMovementManager::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USBSkateMovementManager::AddTickDependencies(USBCharacterMovementComponent* Skater)
+{
+	TickFunction.AddPrerequisite(Skater, Skater->PrimaryComponentTick);
+
+	// Animation reads the velocity and transform the batch produces
+	if (const ACharacter* CharacterOwner = Skater->GetCharacterOwner())
+	{
+		if (USkeletalMeshComponent* Mesh = CharacterOwner->GetMesh())
+		{
+			Mesh->PrimaryComponentTick.AddPrerequisite(this, TickFunction);
+		}
+	}
+}
+
+void USBSkateMovementManager::RemoveTickDependencies(USBCharacterMovementComponent* Skater)
+{
+	TickFunction.RemovePrerequisite(Skater, Skater->PrimaryComponentTick);
+
+	if (const ACharacter* CharacterOwner = Skater->GetCharacterOwner())
+	{
+		if (USkeletalMeshComponent* Mesh = CharacterOwner->GetMesh())
+		{
+			Mesh->PrimaryComponentTick.RemovePrerequisite(this, TickFunction);
+		}
+	}
+}
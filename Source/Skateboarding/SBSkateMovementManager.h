@@ -0,0 +1,90 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBCharacterMovementComponent.h"
+#include "SBSkateKernel.h"
+#include "SBSkateMovementManager.generated.h"
+
+class USBSkateMovementManager;
+
+/** Runs the batched skate steps after the movement components of all registered skaters ticked */
+USTRUCT()
+struct FSBSkateMovementTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	USBSkateMovementManager* Manager = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FSBSkateMovementTickFunction> : public TStructOpsTypeTraitsBase2<FSBSkateMovementTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/** Cycles spent in each phase of the batched skate steps */
+struct FSBSkateBatchTimings
+{
+	uint64 GatherCycles = 0;
+	uint64 IntegrateCycles = 0;
+	uint64 ResolveCycles = 0;
+	int32 Steps = 0;
+	int32 SkaterSteps = 0;
+};
+
+/**
+ * Runs the fixed skate steps of the skaters this machine simulates itself in three phases per step:
+ * gather the ground contacts, integrate the skate forces of every skater on a struct of arrays, then resolve the moves.
+ * Everything runs on the game thread, the batch saves the per skater overhead of the kernel, not threads.
+ * Player skaters on a server simulate the moves of their client when they are received and are never batched,
+ * so on a dedicated server only skaters without a remote owner, such as AI skaters, go through here.
+ */
+UCLASS()
+class SKATEBOARDING_API USBSkateMovementManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void RegisterSkater(USBCharacterMovementComponent* Skater);
+	void UnregisterSkater(USBCharacterMovementComponent* Skater);
+
+	/** Runs the deferred steps of every skater, called once per frame after the skaters ticked */
+	void UpdateSkaters();
+
+	const FSBSkateBatchTimings& GetTimings() const { return Timings; }
+	void ResetTimings() { Timings = FSBSkateBatchTimings(); }
+
+	static bool IsBatchingEnabled();
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void AddTickDependencies(USBCharacterMovementComponent* Skater);
+	void RemoveTickDependencies(USBCharacterMovementComponent* Skater);
+
+	FSBSkateMovementTickFunction TickFunction;
+
+	TArray<TWeakObjectPtr<USBCharacterMovementComponent>> Skaters;
+
+	/** Reused every frame so batching doesn't allocate once the arrays reached the skater count */
+	TArray<USBCharacterMovementComponent*> ActiveSkaters;
+	TArray<USBCharacterMovementComponent*> SteppingSkaters;
+	TArray<FSBSkateStep> Steps;
+	FSBSkateKernelBatch Batch;
+
+	FSBSkateBatchTimings Timings;
+};
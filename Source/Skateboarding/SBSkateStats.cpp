@@ -0,0 +1,88 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateStats.h"
+
+#include "GameFramework/Actor.h"
+#include "GameFramework/PlayerState.h"
+
+DEFINE_STAT(STAT_SkatePhysSkate);
+DEFINE_STAT(STAT_SkateGetSurface);
+DEFINE_STAT(STAT_SkateBatchGather);
+DEFINE_STAT(STAT_SkateBatchIntegrate);
+DEFINE_STAT(STAT_SkateBatchResolve);
+DEFINE_STAT(STAT_SkateTrickRecognition);
+DEFINE_STAT(STAT_SkateRequestAddScore);
+DEFINE_STAT(STAT_SkateScoreNotifications);
+DEFINE_STAT(STAT_SkateCamera);
+
+DEFINE_STAT(STAT_SkateActiveSkaters);
+DEFINE_STAT(STAT_SkateAirborneSkaters);
+DEFINE_STAT(STAT_SkateGrindingSkaters);
+DEFINE_STAT(STAT_SkateSurfaceTraces);
+DEFINE_STAT(STAT_SkateTricks);
+DEFINE_STAT(STAT_SkateScoreEvents);
+DEFINE_STAT(STAT_SkateClientCorrections);
+
+CSV_DEFINE_CATEGORY_MODULE(SKATEBOARDING_API, Skate, true);
+
+UE_TRACE_CHANNEL_DEFINE(SkateChannel);
+
+#if UE_TRACE_ENABLED
+UE_TRACE_EVENT_BEGIN(Skate, TrickEvent)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, SkaterId)
+	UE_TRACE_EVENT_FIELD(uint8, Trick)
+	UE_TRACE_EVENT_FIELD(int32, Score)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Skate, ScoreEvent)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, PlayerId)
+	UE_TRACE_EVENT_FIELD(int32, Amount)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Source)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Skate, SkateModeEvent)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, SkaterId)
+	UE_TRACE_EVENT_FIELD(bool, Skating)
+UE_TRACE_EVENT_END()
+#endif
+
+void SBSkateTrace::OutputTrick(const AActor* Skater, uint8 Trick, int32 Score)
+{
+#if UE_TRACE_ENABLED
+	UE_TRACE_LOG(Skate, TrickEvent, SkateChannel)
+		<< TrickEvent.Cycle(FPlatformTime::Cycles64())
+		<< TrickEvent.SkaterId(Skater != nullptr ? Skater->GetUniqueID() : 0)
+		<< TrickEvent.Trick(Trick)
+		<< TrickEvent.Score(Score);
+#endif
+}
+
+void SBSkateTrace::OutputScore(const APlayerState* PlayerState, int32 Amount, FName Source)
+{
+#if UE_TRACE_ENABLED
+	// Names are only resolved when the channel is on
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(SkateChannel))
+	{
+		const FString SourceName = Source.ToString();
+		UE_TRACE_LOG(Skate, ScoreEvent, SkateChannel)
+			<< ScoreEvent.Cycle(FPlatformTime::Cycles64())
+			<< ScoreEvent.PlayerId(PlayerState != nullptr ? PlayerState->GetPlayerId() : 0)
+			<< ScoreEvent.Amount(Amount)
+			<< ScoreEvent.Source(*SourceName, SourceName.Len());
+	}
+#endif
+}
+
+void SBSkateTrace::OutputSkateMode(const AActor* Skater, bool bSkating)
+{
+#if UE_TRACE_ENABLED
+	UE_TRACE_LOG(Skate, SkateModeEvent, SkateChannel)
+		<< SkateModeEvent.Cycle(FPlatformTime::Cycles64())
+		<< SkateModeEvent.SkaterId(Skater != nullptr ? Skater->GetUniqueID() : 0)
+		<< SkateModeEvent.Skating(bSkating);
+#endif
+}
@@ -0,0 +1,62 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+class AActor;
+class APlayerState;
+
+/** Skate costs and per frame counts, shown by `stat skate` */
+DECLARE_STATS_GROUP(TEXT("Skate"), STATGROUP_Skate, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("PhysSkate"), STAT_SkatePhysSkate, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GetSurface"), STAT_SkateGetSurface, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Batch Gather"), STAT_SkateBatchGather, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Batch Integrate"), STAT_SkateBatchIntegrate, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Batch Resolve"), STAT_SkateBatchResolve, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Trick Recognition"), STAT_SkateTrickRecognition, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RequestAddScore"), STAT_SkateRequestAddScore, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Score Notifications"), STAT_SkateScoreNotifications, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Camera"), STAT_SkateCamera, STATGROUP_Skate, SKATEBOARDING_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Active Skaters"), STAT_SkateActiveSkaters, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Airborne Skaters"), STAT_SkateAirborneSkaters, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Grinding Skaters"), STAT_SkateGrindingSkaters, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Surface Traces"), STAT_SkateSurfaceTraces, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Tricks"), STAT_SkateTricks, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Score Events"), STAT_SkateScoreEvents, STATGROUP_Skate, SKATEBOARDING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Client Corrections"), STAT_SkateClientCorrections, STATGROUP_Skate, SKATEBOARDING_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SKATEBOARDING_API, Skate);
+
+/** Skate events and scopes in Unreal Insights, enable with -trace=cpu,skate */
+UE_TRACE_CHANNEL_EXTERN(SkateChannel, SKATEBOARDING_API);
+
+/** Times a scope in `stat skate`, the CSV profiler and Insights, Name is the stat without its STAT_Skate prefix */
+#define SB_SKATE_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Skate##Name); \
+	CSV_SCOPED_TIMING_STAT(Skate, Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("Skate_" #Name, SkateChannel)
+
+/** Adds to a per frame count in `stat skate` and the CSV profiler */
+#define SB_SKATE_COUNT(Name, Amount) \
+	INC_DWORD_STAT_BY(STAT_Skate##Name, Amount); \
+	CSV_CUSTOM_STAT(Skate, Name, static_cast<int32>(Amount), ECsvCustomStatOp::Accumulate)
+
+/** Sets a per frame count in `stat skate` and the CSV profiler */
+#define SB_SKATE_SET_COUNT(Name, Value) \
+	SET_DWORD_STAT(STAT_Skate##Name, Value); \
+	CSV_CUSTOM_STAT(Skate, Name, static_cast<int32>(Value), ECsvCustomStatOp::Set)
+
+/** Skate events on the skate trace channel */
+namespace SBSkateTrace
+{
+	void OutputTrick(const AActor* Skater, uint8 Trick, int32 Score);
+	void OutputScore(const APlayerState* PlayerState, int32 Amount, FName Source);
+	void OutputSkateMode(const AActor* Skater, bool bSkating);
+}
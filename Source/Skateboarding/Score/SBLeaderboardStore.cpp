@@ -0,0 +1,357 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBLeaderboardStore.h"
+
+#include "Algo/BinarySearch.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Templates/Greater.h"
+
+DEFINE_LOG_CATEGORY(LogSkateLeaderboard);
+
+FArchive& operator<<(FArchive& Ar, FSBLeaderboardEntry& Entry)
+{
+	// Stored as a string, name indices don't survive the session
+	FString Map = Entry.Map.ToString();
+	Ar << Map;
+	Ar << Entry.PlayerName;
+	Ar << Entry.Score;
+	Ar << Entry.BestCombo;
+	Ar << Entry.RunTime;
+	Ar << Entry.ReplayId;
+	Ar << Entry.Date;
+
+	if (Ar.IsLoading())
+	{
+		Entry.Map = FName(*Map);
+	}
+	return Ar;
+}
+
+FSBLeaderboardIndex::FSBLeaderboardIndex(int32 InMaxEntriesPerMap)
+	: MaxEntriesPerMap(FMath::Max(1, InMaxEntriesPerMap))
+{
+}
+
+bool FSBLeaderboardIndex::Add(const FSBLeaderboardEntry& Entry)
+{
+	TArray<FSBLeaderboardEntry>& Entries = Maps.FindOrAdd(Entry.Map);
+	const int32 Position = Algo::UpperBoundBy(Entries, Entry.Score, &FSBLeaderboardEntry::Score, TGreater<>());
+	if (Position >= MaxEntriesPerMap)
+	{
+		return false;
+	}
+
+	Entries.Insert(Entry, Position);
+	if (Entries.Num() > MaxEntriesPerMap)
+	{
+		Entries.RemoveAt(MaxEntriesPerMap, Entries.Num() - MaxEntriesPerMap, false);
+	}
+	return true;
+}
+
+int32 FSBLeaderboardIndex::GetRank(FName Map, int32 Score) const
+{
+	const TArray<FSBLeaderboardEntry>* Entries = Maps.Find(Map);
+	if (Entries == nullptr)
+	{
+		return 1;
+	}
+
+	const int32 Position = Algo::UpperBoundBy(*Entries, Score, &FSBLeaderboardEntry::Score, TGreater<>());
+	return Position < MaxEntriesPerMap ? Position + 1 : INDEX_NONE;
+}
+
+TConstArrayView<FSBLeaderboardEntry> FSBLeaderboardIndex::GetEntries(FName Map) const
+{
+	const TArray<FSBLeaderboardEntry>* Entries = Maps.Find(Map);
+	return Entries != nullptr ? TConstArrayView<FSBLeaderboardEntry>(*Entries) : TConstArrayView<FSBLeaderboardEntry>();
+}
+
+int32 FSBLeaderboardIndex::Num() const
+{
+	int32 NumEntries = 0;
+	for (const TPair<FName, TArray<FSBLeaderboardEntry>>& Map : Maps)
+	{
+		NumEntries += Map.Value.Num();
+	}
+	return NumEntries;
+}
+
+FSBLeaderboardStore::~FSBLeaderboardStore()
+{
+	Close();
+}
+
+bool FSBLeaderboardStore::Open(const FString& InFilename, int32 InMaxEntriesPerMap, int32 InCompactionThreshold)
+{
+	Close();
+
+	Filename = InFilename;
+	MaxEntriesPerMap = InMaxEntriesPerMap;
+	CompactionThreshold = FMath::Max(0, InCompactionThreshold);
+	Index = FSBLeaderboardIndex(MaxEntriesPerMap);
+	NumRecords = 0;
+	bStopping = false;
+
+	WorkEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("SkateLeaderboardStore"), 0, TPri_BelowNormal);
+	return Thread != nullptr;
+}
+
+void FSBLeaderboardStore::Append(const FSBLeaderboardEntry& Entry)
+{
+	if (IsOpen() == false)
+	{
+		return;
+	}
+
+	PendingEntries.Enqueue(Entry);
+	WorkEvent->Trigger();
+}
+
+void FSBLeaderboardStore::Close()
+{
+	if (Thread == nullptr)
+	{
+		return;
+	}
+
+	bStopping = true;
+	WorkEvent->Trigger();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+
+	FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+	WorkEvent = nullptr;
+}
+
+bool FSBLeaderboardStore::DequeueLoadedIndex(FSBLeaderboardIndex& OutIndex)
+{
+	return LoadedIndex.Dequeue(OutIndex);
+}
+
+uint32 FSBLeaderboardStore::Run()
+{
+	Load();
+
+	while (true)
+	{
+		const bool bStopRequested = bStopping;
+
+		bool bAppended = false;
+		FSBLeaderboardEntry Entry;
+		while (PendingEntries.Dequeue(Entry))
+		{
+			if (Archive.IsValid())
+			{
+				WriteRecord(*Archive, Entry);
+				++NumRecords;
+				bAppended = true;
+			}
+			Index.Add(Entry);
+		}
+
+		if (bAppended)
+		{
+			// Keep the log readable up to the last record if the session ends in a crash
+			Archive->Flush();
+
+			// Records that fell off the index are only kept until the log is compacted
+			if (NumRecords - Index.Num() > CompactionThreshold)
+			{
+				Compact();
+				OpenAppend();
+			}
+		}
+
+		if (bStopRequested)
+		{
+			break;
+		}
+		WorkEvent->Wait(1000);
+	}
+
+	if (Archive.IsValid())
+	{
+		Archive->Close();
+		Archive.Reset();
+	}
+	return 0;
+}
+
+void FSBLeaderboardStore::Stop()
+{
+	bStopping = true;
+	if (WorkEvent != nullptr)
+	{
+		WorkEvent->Trigger();
+	}
+}
+
+void FSBLeaderboardStore::Load()
+{
+	TArray<uint8> Data;
+	const bool bExists = FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent);
+
+	TArray<FSBLeaderboardEntry> Entries;
+	int64 ValidSize = 0;
+	const ESBLeaderboardLogResult Result = bExists ? ReadLog(Data, Entries, ValidSize) : ESBLeaderboardLogResult::Complete;
+
+	for (const FSBLeaderboardEntry& Entry : Entries)
+	{
+		Index.Add(Entry);
+	}
+	NumRecords = Entries.Num();
+	LoadedIndex.Enqueue(Index);
+
+	if (Result == ESBLeaderboardLogResult::UnknownHeader)
+	{
+		// Could be a log of another version, keep it for whoever can read it instead of writing over it
+		const FString BackupFilename = Filename + TEXT(".bak");
+		if (IFileManager::Get().Move(*BackupFilename, *Filename, true, true) == false)
+		{
+			UE_LOG(LogSkateLeaderboard, Warning, TEXT("%s is not a leaderboard log and can't be moved to %s, new results won't be saved"), *Filename, *BackupFilename);
+			return;
+		}
+		UE_LOG(LogSkateLeaderboard, Warning, TEXT("%s is not a leaderboard log of version %u, moved it to %s and started a new log"),
+		       *Filename, FSBLeaderboardLogHeader::ExpectedVersion, *BackupFilename);
+	}
+	else if (Result == ESBLeaderboardLogResult::BrokenTail)
+	{
+		UE_LOG(LogSkateLeaderboard, Warning, TEXT("Leaderboard log %s is cut short or damaged, dropping %lld bytes after the last complete record"),
+		       *Filename, Data.Num() - ValidSize);
+	}
+
+	// New logs and logs with a broken tail are rewritten, appending after a broken record would make the new records unreadable
+	if ((bExists && Result == ESBLeaderboardLogResult::Complete) || Compact())
+	{
+		OpenAppend();
+	}
+}
+
+bool FSBLeaderboardStore::OpenAppend()
+{
+	Archive.Reset(IFileManager::Get().CreateFileWriter(*Filename, FILEWRITE_Append | FILEWRITE_AllowRead));
+	if (Archive.IsValid() == false)
+	{
+		UE_LOG(LogSkateLeaderboard, Warning, TEXT("Failed to open leaderboard log %s, new results won't be saved"), *Filename);
+		return false;
+	}
+	return true;
+}
+
+bool FSBLeaderboardStore::Compact()
+{
+	if (Archive.IsValid())
+	{
+		Archive->Close();
+		Archive.Reset();
+	}
+
+	const FString TempFilename = Filename + TEXT(".tmp");
+	bool bWritten = false;
+	{
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilename));
+		if (Writer.IsValid())
+		{
+			FSBLeaderboardLogHeader LogHeader;
+			Writer->Serialize(&LogHeader, sizeof(FSBLeaderboardLogHeader));
+			for (const TPair<FName, TArray<FSBLeaderboardEntry>>& Map : Index.GetMaps())
+			{
+				for (const FSBLeaderboardEntry& Entry : Map.Value)
+				{
+					WriteRecord(*Writer, Entry);
+				}
+			}
+			bWritten = Writer->Close();
+		}
+	}
+
+	// Old log stays in place until the compacted one is complete
+	if (bWritten == false || IFileManager::Get().Move(*Filename, *TempFilename, true, true) == false)
+	{
+		UE_LOG(LogSkateLeaderboard, Warning, TEXT("Failed to compact leaderboard log %s"), *Filename);
+		IFileManager::Get().Delete(*TempFilename, false, false, true);
+		return false;
+	}
+
+	NumRecords = Index.Num();
+	return true;
+}
+
+ESBLeaderboardLogResult FSBLeaderboardStore::ReadLog(const TArray<uint8>& Data, TArray<FSBLeaderboardEntry>& OutEntries, int64& OutValidSize)
+{
+	OutValidSize = 0;
+	// Empty when the log was created right before a crash
+	if (Data.Num() == 0)
+	{
+		return ESBLeaderboardLogResult::BrokenTail;
+	}
+
+	if (Data.Num() < static_cast<int64>(sizeof(FSBLeaderboardLogHeader)))
+	{
+		return ESBLeaderboardLogResult::UnknownHeader;
+	}
+
+	FSBLeaderboardLogHeader LogHeader;
+	FMemory::Memcpy(&LogHeader, Data.GetData(), sizeof(FSBLeaderboardLogHeader));
+	if (LogHeader.Magic != FSBLeaderboardLogHeader::ExpectedMagic || LogHeader.Version != FSBLeaderboardLogHeader::ExpectedVersion)
+	{
+		return ESBLeaderboardLogResult::UnknownHeader;
+	}
+
+	int64 Offset = sizeof(FSBLeaderboardLogHeader);
+	OutValidSize = Offset;
+	while (Offset < Data.Num())
+	{
+		if (Data.Num() - Offset < static_cast<int64>(sizeof(FSBLeaderboardRecordHeader)))
+		{
+			return ESBLeaderboardLogResult::BrokenTail;
+		}
+
+		FSBLeaderboardRecordHeader RecordHeader;
+		FMemory::Memcpy(&RecordHeader, Data.GetData() + Offset, sizeof(FSBLeaderboardRecordHeader));
+		const int64 PayloadOffset = Offset + sizeof(FSBLeaderboardRecordHeader);
+		if (RecordHeader.Magic != FSBLeaderboardRecordHeader::ExpectedMagic || RecordHeader.PayloadSize < 0
+			|| RecordHeader.PayloadSize > Data.Num() - PayloadOffset
+			|| FCrc::MemCrc32(Data.GetData() + PayloadOffset, RecordHeader.PayloadSize) != RecordHeader.PayloadCrc)
+		{
+			return ESBLeaderboardLogResult::BrokenTail;
+		}
+
+		FMemoryReaderView Reader(MakeArrayView(Data.GetData() + PayloadOffset, RecordHeader.PayloadSize));
+		FSBLeaderboardEntry Entry;
+		Reader << Entry;
+		if (Reader.IsError())
+		{
+			return ESBLeaderboardLogResult::BrokenTail;
+		}
+
+		OutEntries.Add(MoveTemp(Entry));
+		Offset = PayloadOffset + RecordHeader.PayloadSize;
+		OutValidSize = Offset;
+	}
+	return ESBLeaderboardLogResult::Complete;
+}
+
+void FSBLeaderboardStore::WriteRecord(FArchive& Ar, const FSBLeaderboardEntry& Entry)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter Writer(Payload);
+	FSBLeaderboardEntry SavedEntry = Entry;
+	Writer << SavedEntry;
+
+	FSBLeaderboardRecordHeader RecordHeader;
+	RecordHeader.PayloadSize = Payload.Num();
+	RecordHeader.PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+	Ar.Serialize(&RecordHeader, sizeof(FSBLeaderboardRecordHeader));
+	Ar.Serialize(Payload.GetData(), Payload.Num());
+}
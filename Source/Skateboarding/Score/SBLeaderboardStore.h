@@ -0,0 +1,159 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+#include "SBLeaderboardStore.generated.h"
+
+class FArchive;
+class FEvent;
+class FRunnableThread;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSkateLeaderboard, Log, All);
+
+/** Result of one skate session */
+USTRUCT(BlueprintType)
+struct FSBLeaderboardEntry
+{
+	GENERATED_BODY()
+
+	/** Short name of the map the session was played on */
+	UPROPERTY(BlueprintReadOnly)
+	FName Map;
+
+	UPROPERTY(BlueprintReadOnly)
+	FString PlayerName;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 Score = 0;
+
+	/** Most tricks chained in one combo */
+	UPROPERTY(BlueprintReadOnly)
+	int32 BestCombo = 0;
+
+	UPROPERTY(BlueprintReadOnly, meta = (Units = "s"))
+	float RunTime = 0.f;
+
+	/** File name of the session replay in Saved/Replays, empty if the session wasn't recorded */
+	UPROPERTY(BlueprintReadOnly)
+	FString ReplayId;
+
+	UPROPERTY(BlueprintReadOnly)
+	FDateTime Date;
+
+	friend FArchive& operator<<(FArchive& Ar, FSBLeaderboardEntry& Entry);
+};
+
+/**
+ * Best entries of every map, ordered by score with earlier entries first on equal scores.
+ * Finding the rank of a score is a binary search, inserting moves at most MaxEntriesPerMap entries.
+ */
+class SKATEBOARDING_API FSBLeaderboardIndex
+{
+public:
+	explicit FSBLeaderboardIndex(int32 InMaxEntriesPerMap = 100);
+
+	/** Returns false if the entry doesn't make it into the best entries of its map */
+	bool Add(const FSBLeaderboardEntry& Entry);
+
+	/** Rank a score would get on a map starting at 1, INDEX_NONE if it wouldn't make it into the best entries */
+	int32 GetRank(FName Map, int32 Score) const;
+
+	/** Best entries of a map, empty if nothing was recorded on the map */
+	TConstArrayView<FSBLeaderboardEntry> GetEntries(FName Map) const;
+
+	const TMap<FName, TArray<FSBLeaderboardEntry>>& GetMaps() const { return Maps; }
+	int32 Num() const;
+
+private:
+	TMap<FName, TArray<FSBLeaderboardEntry>> Maps;
+	int32 MaxEntriesPerMap = 100;
+};
+
+/**
+ * Log layout: FSBLeaderboardLogHeader | records (FSBLeaderboardRecordHeader + serialized FSBLeaderboardEntry)
+ * Records are only ever appended, a record whose size or CRC doesn't match ends the log.
+ */
+struct FSBLeaderboardLogHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x424C4253; // "SBLB"
+	static constexpr uint32 ExpectedVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = ExpectedVersion;
+};
+
+struct FSBLeaderboardRecordHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x52424C53; // "SLBR"
+
+	uint32 Magic = ExpectedMagic;
+	int32 PayloadSize = 0;
+	uint32 PayloadCrc = 0;
+};
+
+enum class ESBLeaderboardLogResult : uint8
+{
+	Complete,
+	/** Log ends in a record cut short or damaged, the records before it are read */
+	BrokenTail,
+	/** File doesn't start with a leaderboard log header of this version, nothing is read */
+	UnknownHeader,
+};
+
+/**
+ * Persists leaderboard entries to an append-only log. Loading, appending and compaction all run on a background thread,
+ * the game thread only queues entries and picks up the index once the log has been read.
+ * A log cut short by a crash is read up to its last complete record and rewritten without the broken tail.
+ * A file that isn't a log of this version is moved to Filename.bak and a new log is started.
+ */
+class FSBLeaderboardStore : public FRunnable
+{
+public:
+	FSBLeaderboardStore() = default;
+	virtual ~FSBLeaderboardStore() override;
+
+	/** Starts reading the log, CompactionThreshold is how many dropped records the log may hold before it is rewritten */
+	bool Open(const FString& InFilename, int32 InMaxEntriesPerMap, int32 InCompactionThreshold);
+	void Append(const FSBLeaderboardEntry& Entry);
+	/** Writes the queued entries, blocks until the log is closed */
+	void Close();
+
+	/** Index read from the log, only returned once */
+	bool DequeueLoadedIndex(FSBLeaderboardIndex& OutIndex);
+
+	bool IsOpen() const { return Thread != nullptr; }
+
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	void Load();
+	bool OpenAppend();
+	/** Rewrites the log with the entries of the index only, the old log is replaced once the new one is complete */
+	bool Compact();
+
+	/** OutValidSize is the size up to the last complete record */
+	static ESBLeaderboardLogResult ReadLog(const TArray<uint8>& Data, TArray<FSBLeaderboardEntry>& OutEntries, int64& OutValidSize);
+	static void WriteRecord(FArchive& Ar, const FSBLeaderboardEntry& Entry);
+
+	FString Filename;
+	int32 MaxEntriesPerMap = 100;
+	int32 CompactionThreshold = 256;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WorkEvent = nullptr;
+	std::atomic<bool> bStopping = false;
+
+	TQueue<FSBLeaderboardEntry, EQueueMode::Spsc> PendingEntries;
+	TQueue<FSBLeaderboardIndex, EQueueMode::Spsc> LoadedIndex;
+
+	/** Only touched by the store thread */
+	TUniquePtr<FArchive> Archive;
+	FSBLeaderboardIndex Index;
+	int32 NumRecords = 0;
+};
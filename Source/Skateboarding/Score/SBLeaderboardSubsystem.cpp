@@ -0,0 +1,184 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBLeaderboardSubsystem.h"
+
+#include "SBScoreSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Replay/SBSkateReplaySubsystem.h"
+#include "Skateboarding/SBCharacter.h"
+
+namespace
+{
+	FAutoConsoleCommandWithWorldAndArgs PrintLeaderboardCommand(
+		TEXT("sb.Leaderboard"),
+		TEXT("Prints the best results of a map. Usage: sb.Leaderboard [Map] [Count]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UGameInstance* GameInstance = World != nullptr ? World->GetGameInstance() : nullptr;
+			USBLeaderboardSubsystem* LeaderboardSubsystem = GameInstance != nullptr ? GameInstance->GetSubsystem<USBLeaderboardSubsystem>() : nullptr;
+			if (LeaderboardSubsystem == nullptr)
+			{
+				return;
+			}
+
+			const FName Map = Args.Num() > 0 ? FName(*Args[0]) : USBLeaderboardSubsystem::GetMapName(World);
+			const int32 Count = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 10;
+			const TArray<FSBLeaderboardEntry> Entries = LeaderboardSubsystem->GetTopEntries(Map, Count);
+
+			UE_LOG(LogSkateLeaderboard, Display, TEXT("Leaderboard %s%s"), *Map.ToString(), LeaderboardSubsystem->IsLoaded() ? TEXT("") : TEXT(" (log still loading)"));
+			for (int32 Rank = 0; Rank < Entries.Num(); ++Rank)
+			{
+				const FSBLeaderboardEntry& Entry = Entries[Rank];
+				UE_LOG(LogSkateLeaderboard, Display, TEXT("%3d. %-20s %8d combo %2d %7.1fs %s %s"), Rank + 1, *Entry.PlayerName, Entry.Score, Entry.BestCombo,
+				       Entry.RunTime, *Entry.Date.ToString(), *Entry.ReplayId);
+			}
+		}));
+}
+
+void USBLeaderboardSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Index = FSBLeaderboardIndex(MaxEntriesPerMap);
+	bLoaded = Store.Open(GetLeaderboardPath(), MaxEntriesPerMap, CompactionThreshold) == false;
+
+	WorldBeginTearDownHandle = FWorldDelegates::OnWorldBeginTearDown.AddUObject(this, &USBLeaderboardSubsystem::OnWorldBeginTearDown);
+}
+
+void USBLeaderboardSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldBeginTearDown.Remove(WorldBeginTearDownHandle);
+
+	// Closing waits for the store thread, the queued results are in the log once the game instance is gone
+	Store.Close();
+
+	Super::Deinitialize();
+}
+
+void USBLeaderboardSubsystem::Tick(float DeltaTime)
+{
+	FSBLeaderboardIndex LoadedIndex;
+	if (Store.DequeueLoadedIndex(LoadedIndex) == false)
+	{
+		return;
+	}
+
+	Index = MoveTemp(LoadedIndex);
+	for (const FSBLeaderboardEntry& Entry : UnloadedResults)
+	{
+		Index.Add(Entry);
+	}
+	UnloadedResults.Empty();
+
+	bLoaded = true;
+	OnLeaderboardLoaded.Broadcast();
+}
+
+ETickableTickType USBLeaderboardSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USBLeaderboardSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBLeaderboardSubsystem, STATGROUP_Tickables);
+}
+
+void USBLeaderboardSubsystem::SubmitResult(const FSBLeaderboardEntry& Entry)
+{
+	Store.Append(Entry);
+	Index.Add(Entry);
+
+	if (bLoaded == false)
+	{
+		UnloadedResults.Add(Entry);
+	}
+}
+
+TArray<FSBLeaderboardEntry> USBLeaderboardSubsystem::GetTopEntries(FName Map, int32 Count) const
+{
+	const TConstArrayView<FSBLeaderboardEntry> Entries = Index.GetEntries(Map);
+	return TArray<FSBLeaderboardEntry>(Entries.GetData(), FMath::Clamp(Count, 0, Entries.Num()));
+}
+
+int32 USBLeaderboardSubsystem::GetRank(FName Map, int32 Score) const
+{
+	return Index.GetRank(Map, Score);
+}
+
+FName USBLeaderboardSubsystem::GetMapName(const UWorld* World)
+{
+	return World != nullptr ? FName(FPackageName::GetShortName(UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()))) : NAME_None;
+}
+
+FString USBLeaderboardSubsystem::GetLeaderboardPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Leaderboards") / TEXT("Leaderboard.sblog");
+}
+
+void USBLeaderboardSubsystem::OnWorldBeginTearDown(UWorld* World)
+{
+	if (World == nullptr || World->IsGameWorld() == false || World->GetGameInstance() != GetGameInstance())
+	{
+		return;
+	}
+
+	const AGameStateBase* GameState = World->GetGameState();
+	if (GameState == nullptr)
+	{
+		return;
+	}
+
+	for (APlayerState* PlayerState : GameState->PlayerArray)
+	{
+		SubmitPlayerResult(World, PlayerState);
+	}
+}
+
+void USBLeaderboardSubsystem::SubmitPlayerResult(UWorld* World, APlayerState* PlayerState)
+{
+	if (PlayerState == nullptr)
+	{
+		return;
+	}
+
+	// Clients only keep the score of their own players
+	const APlayerController* PlayerController = PlayerState->GetPlayerController();
+	if (World->GetNetMode() == NM_Client && (PlayerController == nullptr || PlayerController->IsLocalController() == false))
+	{
+		return;
+	}
+
+	const USBScoreSubsystem* ScoreSubsystem = GetGameInstance()->GetSubsystem<USBScoreSubsystem>();
+	const FSBScoreLedger* Ledger = ScoreSubsystem != nullptr ? ScoreSubsystem->FindLedger(PlayerState) : nullptr;
+	// Players who never scored don't take a leaderboard slot
+	if (Ledger == nullptr || Ledger->Score <= 0)
+	{
+		return;
+	}
+
+	FSBLeaderboardEntry Entry;
+	Entry.Map = GetMapName(World);
+	Entry.PlayerName = PlayerState->GetPlayerName();
+	Entry.Score = Ledger->Score;
+	Entry.BestCombo = Ledger->BestCombo;
+	// Player state lives as long as the player is in the map, a reload starts a new run
+	Entry.RunTime = PlayerState->GetGameTimeSinceCreation();
+	Entry.Date = FDateTime::UtcNow();
+
+	ASBCharacter* Skater = PlayerState->GetPawn<ASBCharacter>();
+	const USBSkateReplaySubsystem* ReplaySubsystem = World->GetSubsystem<USBSkateReplaySubsystem>();
+	if (Skater != nullptr && ReplaySubsystem != nullptr)
+	{
+		Entry.ReplayId = ReplaySubsystem->GetReplayId(Skater);
+	}
+
+	SubmitResult(Entry);
+}
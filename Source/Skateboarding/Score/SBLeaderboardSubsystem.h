@@ -0,0 +1,77 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "SBLeaderboardStore.h"
+#include "SBLeaderboardSubsystem.generated.h"
+
+class APlayerState;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnLeaderboardLoaded);
+
+/**
+ * Saves the result of every skate session to Saved/Leaderboards when its world is torn down, on map reloads and on exit,
+ * and answers leaderboard queries from an in-memory copy of the best entries of every map.
+ * Reading and writing the log happens on the store thread, queries never wait on disk I/O.
+ */
+UCLASS(Config = Game)
+class SKATEBOARDING_API USBLeaderboardSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return bLoaded == false; }
+	virtual TStatId GetStatId() const override;
+
+	/** Adds a session result to the leaderboard of its map and queues it for the log */
+	UFUNCTION(BlueprintCallable)
+	void SubmitResult(const FSBLeaderboardEntry& Entry);
+
+	/** Best Count entries of a map, best first */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	TArray<FSBLeaderboardEntry> GetTopEntries(FName Map, int32 Count) const;
+
+	/** Rank a score would get on a map starting at 1, -1 if it wouldn't make it onto the leaderboard */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	int32 GetRank(FName Map, int32 Score) const;
+
+	/** False until the log has been read, the leaderboards only hold the results of this session until then */
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	bool IsLoaded() const { return bLoaded; }
+
+	const FSBLeaderboardIndex& GetIndex() const { return Index; }
+
+	UPROPERTY(BlueprintAssignable)
+	FOnLeaderboardLoaded OnLeaderboardLoaded;
+
+	static FName GetMapName(const UWorld* World);
+	static FString GetLeaderboardPath();
+
+private:
+	void OnWorldBeginTearDown(UWorld* World);
+	void SubmitPlayerResult(UWorld* World, APlayerState* PlayerState);
+
+	/** Entries kept per map, results below the last entry are dropped when the log is compacted */
+	UPROPERTY(Config)
+	int32 MaxEntriesPerMap = 100;
+
+	/** Dropped results the log may hold before it is rewritten with the leaderboard entries only */
+	UPROPERTY(Config)
+	int32 CompactionThreshold = 256;
+
+	FSBLeaderboardStore Store;
+	FSBLeaderboardIndex Index;
+	/** Results submitted before the log was read, added again to the loaded index */
+	TArray<FSBLeaderboardEntry> UnloadedResults;
+	bool bLoaded = false;
+
+	FDelegateHandle WorldBeginTearDownHandle;
+};
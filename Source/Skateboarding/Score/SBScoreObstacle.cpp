@@ -3,53 +3,32 @@
 
 #include "SBScoreObstacle.h"
 
-#include "SBScoreSubsystem.h"
-#include "GameFramework/Character.h"
+#include "SBTrickZoneSubsystem.h"
 
 // Sets default values
 ASBScoreObstacle::ASBScoreObstacle()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Skaters are tested against the obstacle by the trick zone subsystem, the obstacle itself has nothing to update
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 // Called when the game starts or when spawned
 void ASBScoreObstacle::BeginPlay()
 {
 	Super::BeginPlay();
-	OnActorBeginOverlap.AddDynamic(this, &ASBScoreObstacle::OnOverlapBegin);
-}
 
-void ASBScoreObstacle::OnOverlapBegin(AActor* OverlappedActor, AActor* OtherActor)
-{
-	if (OtherActor == nullptr)
-	{
-		return;
-	}
-
-	ACharacter* Character = Cast<ACharacter>(OtherActor);
-	if (Character == nullptr)
-	{
-		return;
-	}
-	
-	APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
-	if (PlayerController == nullptr)
+	if (USBTrickZoneSubsystem* TrickZoneSubsystem = GetWorld()->GetSubsystem<USBTrickZoneSubsystem>())
 	{
-		return;
-	}
-
-	USBScoreSubsystem* Subsystem = UGameInstance::GetSubsystem<USBScoreSubsystem>(GetWorld()->GetGameInstance());
-	if (Subsystem == nullptr)
-	{
-		return;
+		TrickZoneSubsystem->RegisterObstacle(this);
 	}
+}
 
-	if(Subsystem->RequestAddScore(Character, ScoreAmount))
+void ASBScoreObstacle::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USBTrickZoneSubsystem* TrickZoneSubsystem = GetWorld()->GetSubsystem<USBTrickZoneSubsystem>())
 	{
-		OnScoreAdded();
+		TrickZoneSubsystem->UnregisterObstacle(this);
 	}
 
-	// GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Blue, *FString::Printf(TEXT("Score: %d"), Subsystem->GetScore()));
+	Super::EndPlay(EndPlayReason);
 }
-
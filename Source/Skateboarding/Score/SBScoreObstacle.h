@@ -3,9 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Engine/TriggerVolume.h"
+#include "GameFramework/Actor.h"
 #include "SBScoreObstacle.generated.h"
 
+/**
+ * Scores skaters passing through it in the air. Components responding to the TrickZone channel form the zone,
+ * skaters are tested against them by USBTrickZoneSubsystem.
+ */
 UCLASS(BlueprintType, Blueprintable)
 class SKATEBOARDING_API ASBScoreObstacle : public AActor
 {
@@ -17,14 +21,18 @@ public:
 
 	UPROPERTY(EditAnywhere, Category = "Score")
 	int32 ScoreAmount = 10;
+
+	/** Time in seconds before the same player can score on this obstacle again */
+	UPROPERTY(EditAnywhere, Category = "Score", meta = (ClampMin = "0"))
+	float ScoreCooldown = 1.f;
 	
 protected:	
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
-
-	UFUNCTION()
-	void OnOverlapBegin(AActor* OverlappedActor, AActor* OtherActor);
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	UFUNCTION(BlueprintImplementableEvent)
 	void OnScoreAdded();
+
+	friend class USBTrickZoneSubsystem;
 };
@@ -3,33 +3,201 @@
 
 #include "SBScoreSubsystem.h"
 
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "SBTrickRecognizer.h"
 #include "Skateboarding/SBCharacter.h"
 #include "Skateboarding/SBCharacterMovementComponent.h"
+#include "Skateboarding/SBSkateStats.h"
+
+void FSBScoreEventBuffer::Add(const FSBScoreEvent& Event)
+{
+	Events[Head] = Event;
+	Head = (Head + 1) % Capacity;
+	Num = FMath::Min(Num + 1, Capacity);
+}
+
+const FSBScoreEvent& FSBScoreEventBuffer::GetRecent(int32 Age) const
+{
+	check(Age >= 0 && Age < Num);
+	return Events[(Head - 1 - Age + Capacity) % Capacity];
+}
+
+void USBScoreSubsystem::Deinitialize()
+{
+	Ledgers.Reset();
+	bHasPendingNotifications = false;
+
+	Super::Deinitialize();
+}
+
+void USBScoreSubsystem::Tick(float DeltaTime)
+{
+	SB_SKATE_SCOPE(ScoreNotifications);
+
+	bHasPendingNotifications = false;
+
+	const APlayerState* PrimaryPlayerState = GetPrimaryPlayerState();
+	for (FSBScoreLedger& Ledger : Ledgers)
+	{
+		if (Ledger.bHasPendingScore == false)
+		{
+			continue;
+		}
+
+		const int32 ScoreAdded = Ledger.PendingScore;
+		Ledger.PendingScore = 0;
+		Ledger.bHasPendingScore = false;
+
+		// Players that left are pruned below, nobody listens to their score anymore
+		APlayerState* PlayerState = Ledger.PlayerState.Get();
+		if (PlayerState == nullptr)
+		{
+			continue;
+		}
+
+		OnPlayerScoreAddedNative.Broadcast(PlayerState, ScoreAdded, Ledger.Score);
+		OnPlayerScoreAdded.Broadcast(PlayerState, ScoreAdded, Ledger.Score);
+		if (PlayerState == PrimaryPlayerState)
+		{
+			OnScoreAdded.Broadcast(ScoreAdded, Ledger.Score);
+		}
+	}
+
+	PruneStaleLedgers();
+}
+
+ETickableTickType USBScoreSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+TStatId USBScoreSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBScoreSubsystem, STATGROUP_Tickables);
+}
 
 void USBScoreSubsystem::AddToScore(int32 Value)
 {
-	CurrentScore += Value;
+	AddToPlayerScore(GetPrimaryPlayerState(), Value);
 }
 
 void USBScoreSubsystem::RemoveFromScore(int32 Value)
 {
-	CurrentScore -= Value;
+	AddToPlayerScore(GetPrimaryPlayerState(), -Value);
 }
 
 int32 USBScoreSubsystem::GetScore()
 {
-	return CurrentScore;
+	return GetPlayerScore(GetPrimaryPlayerState());
+}
+
+void USBScoreSubsystem::AddToPlayerScore(APlayerState* PlayerState, int32 Value)
+{
+	AddScore(PlayerState, Value, NAME_None);
 }
 
-bool USBScoreSubsystem::RequestAddScore(ACharacter* Character, int32 ScoreAmount)
+void USBScoreSubsystem::AddScore(APlayerState* PlayerState, int32 Value, FName Source)
 {
+	if (FSBScoreLedger* Ledger = FindOrAddLedger(PlayerState))
+	{
+		AddScoreEvent(*Ledger, Value, Source);
+	}
+}
+
+void USBScoreSubsystem::AddTrickScore(APlayerState* PlayerState, const FSBTrickEvent& Trick)
+{
+	FSBScoreLedger* Ledger = FindOrAddLedger(PlayerState);
+	if (Ledger == nullptr)
+	{
+		return;
+	}
+
+	Ledger->BestCombo = FMath::Max(Ledger->BestCombo, Trick.ComboCount);
+	AddScoreEvent(*Ledger, Trick.Score, FSBTrickRecognizer::GetTrickName(Trick.Trick));
+}
+
+int32 USBScoreSubsystem::GetPlayerScore(const APlayerState* PlayerState) const
+{
+	const FSBScoreLedger* Ledger = FindLedger(PlayerState);
+	return Ledger != nullptr ? Ledger->Score : 0;
+}
+
+bool USBScoreSubsystem::RequestAddScore(ACharacter* Character, int32 ScoreAmount, FName Source)
+{
+	SB_SKATE_SCOPE(RequestAddScore);
+
 	USBCharacterMovementComponent* SkateMovementComponent = Cast<USBCharacterMovementComponent>(Character->GetMovementComponent());
-	if(SkateMovementComponent->GetIsSkateInAir() == true)
+	if(SkateMovementComponent != nullptr && SkateMovementComponent->GetIsSkateInAir() == true)
 	{
-		AddToScore(ScoreAmount);
-		OnScoreAdded.Broadcast(ScoreAmount, GetScore());
+		AddScore(Character->GetPlayerState(), ScoreAmount, Source);
 		return true;
 	}
 
 	return false;
 }
+
+const FSBScoreLedger* USBScoreSubsystem::FindLedger(const APlayerState* PlayerState) const
+{
+	// Stale ledgers read as null, a null player state would match them
+	if (PlayerState == nullptr)
+	{
+		return nullptr;
+	}
+
+	return Ledgers.FindByPredicate([PlayerState](const FSBScoreLedger& Ledger) { return Ledger.PlayerState.Get() == PlayerState; });
+}
+
+FSBScoreLedger* USBScoreSubsystem::FindOrAddLedger(APlayerState* PlayerState)
+{
+	if (PlayerState == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (FSBScoreLedger* Ledger = Ledgers.FindByPredicate([PlayerState](const FSBScoreLedger& Existing) { return Existing.PlayerState.Get() == PlayerState; }))
+	{
+		return Ledger;
+	}
+
+	PruneStaleLedgers();
+
+	FSBScoreLedger& Ledger = Ledgers.AddDefaulted_GetRef();
+	Ledger.PlayerState = PlayerState;
+	return &Ledger;
+}
+
+void USBScoreSubsystem::PruneStaleLedgers()
+{
+	Ledgers.RemoveAllSwap([](const FSBScoreLedger& Ledger) { return Ledger.PlayerState.IsValid() == false; });
+}
+
+APlayerState* USBScoreSubsystem::GetPrimaryPlayerState() const
+{
+	const ULocalPlayer* LocalPlayer = GetGameInstance()->GetFirstGamePlayer();
+	const UWorld* World = GetGameInstance()->GetWorld();
+	const APlayerController* PlayerController = LocalPlayer != nullptr && World != nullptr ? LocalPlayer->GetPlayerController(World) : nullptr;
+	return PlayerController != nullptr ? PlayerController->PlayerState : nullptr;
+}
+
+void USBScoreSubsystem::AddScoreEvent(FSBScoreLedger& Ledger, int32 Value, FName Source)
+{
+	Ledger.Score += Value;
+	Ledger.PendingScore += Value;
+	Ledger.bHasPendingScore = true;
+
+	FSBScoreEvent Event;
+	Event.Amount = Value;
+	Event.TotalScore = Ledger.Score;
+	Event.Source = Source;
+	Event.Time = FPlatformTime::Seconds();
+	Ledger.Events.Add(Event);
+
+	SB_SKATE_COUNT(ScoreEvents, 1);
+	SBSkateTrace::OutputScore(Ledger.PlayerState.Get(), Value, Source);
+
+	bHasPendingNotifications = true;
+}
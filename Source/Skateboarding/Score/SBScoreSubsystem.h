@@ -3,36 +3,126 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
 #include "SBScoreSubsystem.generated.h"
 
+class ACharacter;
+class APlayerState;
+struct FSBTrickEvent;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnScoreAdded, int32, ScoreAdded, int32, TotalScore);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPlayerScoreAdded, APlayerState*, PlayerState, int32, ScoreAdded, int32, TotalScore);
+
+/** Score added to a player, a new event is recorded for every score request */
+struct FSBScoreEvent
+{
+	int32 Amount = 0;
+	int32 TotalScore = 0;
+	/** What the score was awarded for, e.g. the obstacle name */
+	FName Source;
+	double Time = 0.0;
+};
+
+/** Last score events of a player, the oldest event is overwritten once the buffer is full */
+struct FSBScoreEventBuffer
+{
+	static constexpr int32 Capacity = 32;
+
+	void Add(const FSBScoreEvent& Event);
+	void Reset() { Num = 0; Head = 0; }
+
+	int32 GetNum() const { return Num; }
+	/** Returns the event recorded Age events ago, 0 is the latest */
+	const FSBScoreEvent& GetRecent(int32 Age) const;
+
+private:
+	TStaticArray<FSBScoreEvent, Capacity> Events;
+	int32 Head = 0;
+	int32 Num = 0;
+};
+
+/** Score of a single player and the score added since listeners were last notified */
+struct FSBScoreLedger
+{
+	TWeakObjectPtr<APlayerState> PlayerState;
+	int32 Score = 0;
+	int32 PendingScore = 0;
+	bool bHasPendingScore = false;
+	/** Most tricks chained in one combo */
+	int32 BestCombo = 0;
+	FSBScoreEventBuffer Events;
+};
+
+/** Coalesced score change of a player, listeners are notified at most once per frame per player */
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnPlayerScoreAddedNative, APlayerState* /*PlayerState*/, int32 /*ScoreAdded*/, int32 /*TotalScore*/);
 
 /**
- * 
+ * Keeps a score ledger per player. Score requests are recorded immediately,
+ * the score delegates are broadcast once per frame with everything added during that frame.
  */
 UCLASS()
-class SKATEBOARDING_API USBScoreSubsystem : public UGameInstanceSubsystem
+class SKATEBOARDING_API USBScoreSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
 {
 	GENERATED_BODY()
 
 public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return bHasPendingNotifications; }
+	virtual TStatId GetStatId() const override;
+
+	/** Adds to the score of the first local player */
 	UFUNCTION(BlueprintCallable)
 	void AddToScore(int32 Value);
 	
 	UFUNCTION(BlueprintCallable)
 	void RemoveFromScore(int32 Value);
 	
+	/** Score of the first local player */
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	int32 GetScore();
 
-	bool RequestAddScore(ACharacter* Character, int32 ScoreAmount);
+	UFUNCTION(BlueprintCallable)
+	void AddToPlayerScore(APlayerState* PlayerState, int32 Value);
+
+	void AddScore(APlayerState* PlayerState, int32 Value, FName Source);
+
+	/** Adds the score of a recognized trick and keeps the best combo of the player */
+	void AddTrickScore(APlayerState* PlayerState, const FSBTrickEvent& Trick);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure)
+	int32 GetPlayerScore(const APlayerState* PlayerState) const;
+
+	/** Awards the score to the player controlling the character if the character is in the air */
+	bool RequestAddScore(ACharacter* Character, int32 ScoreAmount, FName Source = NAME_None);
+
+	/** Ledger of a player, null if the player never scored */
+	const FSBScoreLedger* FindLedger(const APlayerState* PlayerState) const;
 
-	// UFUNCTION(BlueprintImplementableEvent)
-	// void OnScoreAdded;
+	/** Coalesced score of the first local player, kept for the score widgets */
 	UPROPERTY(BlueprintAssignable)
 	FOnScoreAdded OnScoreAdded;
+
+	/** Coalesced score of every player */
+	UPROPERTY(BlueprintAssignable)
+	FOnPlayerScoreAdded OnPlayerScoreAdded;
+
+	FOnPlayerScoreAddedNative OnPlayerScoreAddedNative;
 	
 protected:
-	int32 CurrentScore = 0;
+	/** Null without a player state, score can't be kept for a player that doesn't exist yet */
+	FSBScoreLedger* FindOrAddLedger(APlayerState* PlayerState);
+	/** Drops the ledgers of players that left */
+	void PruneStaleLedgers();
+	APlayerState* GetPrimaryPlayerState() const;
+	void AddScoreEvent(FSBScoreLedger& Ledger, int32 Value, FName Source);
+
+	/** Split screen has at most four local players, remote players only exist on the server */
+	TArray<FSBScoreLedger, TInlineAllocator<4>> Ledgers;
+
+	bool bHasPendingNotifications = false;
 };
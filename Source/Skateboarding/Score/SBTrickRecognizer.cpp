@@ -0,0 +1,151 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBTrickRecognizer.h"
+
+void FSBTrickRecognizer::Reset()
+{
+	Head = 0;
+	Num = 0;
+	Time = 0.f;
+	Phase = EPhase::Rolling;
+	PhaseStartTime = 0.f;
+	AirYaw = 0.f;
+	ComboCount = 0;
+	LastTrickTime = -UE_BIG_NUMBER;
+}
+
+bool FSBTrickRecognizer::AddSample(float DeltaTime, float Yaw, float Pitch, bool bGrounded, bool bOnWall, bool bGrinding, const FSBTrickRecognizerSettings& Settings, FSBTrickEvent& OutTrick)
+{
+	Time += DeltaTime;
+
+	FSBTrickSample& Sample = Samples[Head];
+	const float YawDelta = Num > 0 ? FMath::FindDeltaAngleDegrees(GetRecent(0).Yaw, Yaw) : 0.f;
+	Sample.Time = Time;
+	Sample.Yaw = Yaw;
+	Sample.YawRate = DeltaTime > UE_SMALL_NUMBER ? YawDelta / DeltaTime : 0.f;
+	Sample.Pitch = Pitch;
+	Sample.bGrounded = bGrounded;
+	Sample.bOnWall = bOnWall;
+	Sample.bGrinding = bGrinding;
+	Head = (Head + 1) % Capacity;
+	Num = FMath::Min(Num + 1, Capacity);
+
+	EPhase NewPhase = EPhase::Rolling;
+	if (bGrinding)
+	{
+		NewPhase = EPhase::Grind;
+	}
+	else if (bGrounded == false)
+	{
+		NewPhase = EPhase::Air;
+	}
+	else if (bOnWall)
+	{
+		NewPhase = EPhase::WallRide;
+	}
+	else if (FMath::Abs(Pitch) >= Settings.ManualMinPitch)
+	{
+		NewPhase = EPhase::Manual;
+	}
+
+	bool bFinishedTrick = false;
+	if (NewPhase != Phase)
+	{
+		bFinishedTrick = FinishPhase(Time, Settings, OutTrick);
+		Phase = NewPhase;
+		PhaseStartTime = Time;
+		AirYaw = 0.f;
+	}
+
+	// Takeoff sample already turned in the air, the landing sample belongs to the ground
+	AirYaw += Phase == EPhase::Air ? YawDelta : 0.f;
+	return bFinishedTrick;
+}
+
+const FSBTrickSample& FSBTrickRecognizer::GetRecent(int32 Age) const
+{
+	check(Age >= 0 && Age < Num);
+	return Samples[(Head - 1 - Age + Capacity) % Capacity];
+}
+
+FName FSBTrickRecognizer::GetTrickName(ESBTrick Trick)
+{
+	static const FName Spin180Name(TEXT("Spin180"));
+	static const FName Spin360Name(TEXT("Spin360"));
+	static const FName ManualName(TEXT("Manual"));
+	static const FName WallRideName(TEXT("WallRide"));
+	static const FName GrindName(TEXT("Grind"));
+
+	switch (Trick)
+	{
+	case ESBTrick::Spin180:
+		return Spin180Name;
+	case ESBTrick::Spin360:
+		return Spin360Name;
+	case ESBTrick::Manual:
+		return ManualName;
+	case ESBTrick::WallRide:
+		return WallRideName;
+	case ESBTrick::Grind:
+		return GrindName;
+	default:
+		return NAME_None;
+	}
+}
+
+bool FSBTrickRecognizer::FinishPhase(float InTime, const FSBTrickRecognizerSettings& Settings, FSBTrickEvent& OutTrick)
+{
+	const float Duration = InTime - PhaseStartTime;
+	switch (Phase)
+	{
+	case EPhase::Air:
+		{
+			const float Spin = FMath::Abs(AirYaw);
+			if (Duration < Settings.MinAirTime || Spin < 180.f - Settings.SpinTolerance)
+			{
+				return false;
+			}
+
+			const bool bFullSpin = Spin >= 360.f - Settings.SpinTolerance;
+			AddToCombo(bFullSpin ? ESBTrick::Spin360 : ESBTrick::Spin180, bFullSpin ? Settings.Spin360Score : Settings.Spin180Score, Duration, InTime, Settings, OutTrick);
+			return true;
+		}
+	case EPhase::Manual:
+		if (Duration < Settings.ManualMinTime)
+		{
+			return false;
+		}
+		AddToCombo(ESBTrick::Manual, FMath::RoundToInt32(Settings.ManualScorePerSecond * Duration), Duration, InTime, Settings, OutTrick);
+		return true;
+	case EPhase::WallRide:
+		if (Duration < Settings.WallRideMinTime)
+		{
+			return false;
+		}
+		AddToCombo(ESBTrick::WallRide, FMath::RoundToInt32(Settings.WallRideScorePerSecond * Duration), Duration, InTime, Settings, OutTrick);
+		return true;
+	case EPhase::Grind:
+		if (Duration < Settings.GrindMinTime)
+		{
+			return false;
+		}
+		AddToCombo(ESBTrick::Grind, FMath::RoundToInt32(Settings.GrindScorePerSecond * Duration), Duration, InTime, Settings, OutTrick);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void FSBTrickRecognizer::AddToCombo(ESBTrick Trick, int32 BaseScore, float Duration, float InTime, const FSBTrickRecognizerSettings& Settings, FSBTrickEvent& OutTrick)
+{
+	// Tricks started within the combo window of the last one continue its combo
+	ComboCount = PhaseStartTime - LastTrickTime <= Settings.ComboWindow ? ComboCount + 1 : 1;
+	LastTrickTime = InTime;
+
+	OutTrick.Trick = Trick;
+	OutTrick.ComboCount = ComboCount;
+	OutTrick.ComboMultiplier = FMath::Min(1.f + Settings.ComboMultiplierStep * (ComboCount - 1), Settings.MaxComboMultiplier);
+	OutTrick.Score = FMath::RoundToInt32(BaseScore * OutTrick.ComboMultiplier);
+	OutTrick.Duration = Duration;
+}
@@ -0,0 +1,150 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "SBTrickRecognizer.generated.h"
+
+UENUM(BlueprintType)
+enum class ESBTrick : uint8
+{
+	None,
+	Spin180,
+	Spin360,
+	Manual,
+	WallRide,
+	Grind,
+};
+
+/** Thresholds and scores of the trick recognizer */
+USTRUCT(BlueprintType)
+struct FSBTrickRecognizerSettings
+{
+	GENERATED_BODY()
+
+	/** Shortest air time that counts as a jump, skips small bumps */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", Units = "s"))
+	float MinAirTime = 0.2f;
+
+	/** How far in degrees a spin can be short of 180 or 360 and still count */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", ClampMax = "90", Units = "deg"))
+	float SpinTolerance = 30.f;
+
+	/** Board pitch relative to the ground above which the skater is on two wheels */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", Units = "deg"))
+	float ManualMinPitch = 12.f;
+
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", Units = "s"))
+	float ManualMinTime = 0.5f;
+
+	/** Ground normals with a smaller up component are walls */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "-1", ClampMax = "1"))
+	float WallRideMaxNormalZ = 0.35f;
+
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", Units = "s"))
+	float WallRideMinTime = 0.3f;
+
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", Units = "s"))
+	float GrindMinTime = 0.2f;
+
+	UPROPERTY(EditDefaultsOnly)
+	int32 Spin180Score = 100;
+
+	UPROPERTY(EditDefaultsOnly)
+	int32 Spin360Score = 250;
+
+	UPROPERTY(EditDefaultsOnly)
+	int32 ManualScorePerSecond = 50;
+
+	UPROPERTY(EditDefaultsOnly)
+	int32 WallRideScorePerSecond = 150;
+
+	UPROPERTY(EditDefaultsOnly)
+	int32 GrindScorePerSecond = 200;
+
+	/** Time after a trick in which the next trick continues the combo */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0", Units = "s"))
+	float ComboWindow = 1.5f;
+
+	/** Multiplier added by every trick of a combo after the first */
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "0"))
+	float ComboMultiplierStep = 0.5f;
+
+	UPROPERTY(EditDefaultsOnly, meta = (ClampMin = "1"))
+	float MaxComboMultiplier = 4.f;
+};
+
+/** Skate state after a movement step */
+struct FSBTrickSample
+{
+	float Time = 0.f;
+	/** World yaw of the skater in degrees */
+	float Yaw = 0.f;
+	/** Yaw rate in degrees per second */
+	float YawRate = 0.f;
+	/** Board pitch relative to the ground in degrees, positive with the nose up */
+	float Pitch = 0.f;
+	bool bGrounded = false;
+	bool bOnWall = false;
+	bool bGrinding = false;
+};
+
+/** Trick finished by a sample, the score already includes the combo multiplier */
+struct FSBTrickEvent
+{
+	ESBTrick Trick = ESBTrick::None;
+	int32 Score = 0;
+	int32 ComboCount = 0;
+	float ComboMultiplier = 1.f;
+	/** Air time of spins, time on two wheels, on the wall or on the rail otherwise */
+	float Duration = 0.f;
+};
+
+/**
+ * Classifies spins, manuals, wall rides and grinds from the skate motion.
+ * The last samples are kept in a fixed ring buffer and every phase is tracked incrementally,
+ * adding a sample is constant time and never allocates.
+ */
+class SKATEBOARDING_API FSBTrickRecognizer
+{
+public:
+	static constexpr int32 Capacity = 128;
+
+	void Reset();
+
+	/** Records the state after a step, returns true if the step finished a trick */
+	bool AddSample(float DeltaTime, float Yaw, float Pitch, bool bGrounded, bool bOnWall, bool bGrinding, const FSBTrickRecognizerSettings& Settings, FSBTrickEvent& OutTrick);
+
+	int32 GetNum() const { return Num; }
+	/** Returns the sample recorded Age samples ago, 0 is the latest */
+	const FSBTrickSample& GetRecent(int32 Age) const;
+
+	static FName GetTrickName(ESBTrick Trick);
+
+private:
+	enum class EPhase : uint8
+	{
+		Rolling,
+		Air,
+		Manual,
+		WallRide,
+		Grind,
+	};
+
+	bool FinishPhase(float InTime, const FSBTrickRecognizerSettings& Settings, FSBTrickEvent& OutTrick);
+	void AddToCombo(ESBTrick Trick, int32 BaseScore, float Duration, float InTime, const FSBTrickRecognizerSettings& Settings, FSBTrickEvent& OutTrick);
+
+	TStaticArray<FSBTrickSample, Capacity> Samples;
+	int32 Head = 0;
+	int32 Num = 0;
+	float Time = 0.f;
+
+	EPhase Phase = EPhase::Rolling;
+	float PhaseStartTime = 0.f;
+	/** Yaw turned since takeoff, unwrapped so it can exceed 360 */
+	float AirYaw = 0.f;
+
+	int32 ComboCount = 0;
+	float LastTrickTime = -UE_BIG_NUMBER;
+};
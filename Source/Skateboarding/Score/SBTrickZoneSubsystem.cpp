@@ -0,0 +1,266 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBTrickZoneSubsystem.h"
+
+#include "SBScoreObstacle.h"
+#include "SBScoreSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Skateboarding/SBCharacter.h"
+
+namespace SBTrickZoneSubsystem
+{
+	/** Edge length of the grid cells, zones larger than a cell are added to every cell they touch */
+	constexpr float CellSize = 1000.f;
+}
+
+void USBTrickZoneSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	ScoreSubsystem = UGameInstance::GetSubsystem<USBScoreSubsystem>(InWorld.GetGameInstance());
+}
+
+void USBTrickZoneSubsystem::Deinitialize()
+{
+	Zones.Reset();
+	FreeZones.Reset();
+	Grid.Reset();
+	Contacts.Reset();
+	ScoreSubsystem = nullptr;
+
+	Super::Deinitialize();
+}
+
+void USBTrickZoneSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	for (auto It = Contacts.CreateIterator(); It; ++It)
+	{
+		if (It.Key().IsValid() == false)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (GetNumZones() == 0)
+	{
+		return;
+	}
+
+	// Only skaters of players can score, same as the score subsystem expects
+	const double Time = GetWorld()->GetTimeSeconds();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController == nullptr)
+		{
+			continue;
+		}
+
+		if (ASBCharacter* Skater = Cast<ASBCharacter>(PlayerController->GetPawn()))
+		{
+			UpdateSkater(Skater, Time);
+		}
+	}
+}
+
+TStatId USBTrickZoneSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBTrickZoneSubsystem, STATGROUP_Tickables);
+}
+
+void USBTrickZoneSubsystem::RegisterObstacle(ASBScoreObstacle* Obstacle)
+{
+	TInlineComponentArray<UPrimitiveComponent*> Components(Obstacle);
+
+	TArray<UPrimitiveComponent*, TInlineAllocator<4>> ZoneComponents;
+	for (UPrimitiveComponent* Component : Components)
+	{
+		if (Component->IsQueryCollisionEnabled() && Component->GetCollisionResponseToChannel(ECC_TrickZone) != ECR_Ignore)
+		{
+			ZoneComponents.Add(Component);
+		}
+	}
+
+	// Obstacles set up before the trick zone channel existed use their overlap triggers as zones
+	if (ZoneComponents.Num() == 0)
+	{
+		for (UPrimitiveComponent* Component : Components)
+		{
+			if (Component->IsQueryCollisionEnabled() && Component->GetGenerateOverlapEvents())
+			{
+				ZoneComponents.Add(Component);
+			}
+		}
+	}
+
+	for (UPrimitiveComponent* Component : ZoneComponents)
+	{
+		// Zones are tested here, the physics scene doesn't need to report overlaps with them anymore
+		Component->SetGenerateOverlapEvents(false);
+		AddZone(Obstacle, Component);
+	}
+}
+
+void USBTrickZoneSubsystem::UnregisterObstacle(ASBScoreObstacle* Obstacle)
+{
+	for (int32 ZoneIndex = 0; ZoneIndex < Zones.Num(); ++ZoneIndex)
+	{
+		if (Zones[ZoneIndex].Obstacle.Get() == Obstacle)
+		{
+			RemoveZone(ZoneIndex);
+		}
+	}
+}
+
+bool USBTrickZoneSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USBTrickZoneSubsystem::AddZone(ASBScoreObstacle* Obstacle, UPrimitiveComponent* Component)
+{
+	const int32 ZoneIndex = FreeZones.Num() > 0 ? FreeZones.Pop(false) : Zones.AddDefaulted();
+
+	FSBTrickZone& Zone = Zones[ZoneIndex];
+	Zone.Obstacle = Obstacle;
+	Zone.Component = Component;
+	Zone.Bounds = Component->Bounds.GetBox();
+
+	const FIntVector MinCell = GetCell(Zone.Bounds.Min);
+	const FIntVector MaxCell = GetCell(Zone.Bounds.Max);
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				Grid.FindOrAdd(FIntVector(X, Y, Z)).Add(ZoneIndex);
+			}
+		}
+	}
+}
+
+void USBTrickZoneSubsystem::RemoveZone(int32 ZoneIndex)
+{
+	FSBTrickZone& Zone = Zones[ZoneIndex];
+
+	const FIntVector MinCell = GetCell(Zone.Bounds.Min);
+	const FIntVector MaxCell = GetCell(Zone.Bounds.Max);
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const FIntVector Cell(X, Y, Z);
+				if (TArray<int32>* CellZones = Grid.Find(Cell))
+				{
+					CellZones->RemoveSingleSwap(ZoneIndex, false);
+					if (CellZones->Num() == 0)
+					{
+						Grid.Remove(Cell);
+					}
+				}
+			}
+		}
+	}
+
+	// Index is reused by the next zone, contacts must not carry over
+	for (TPair<TWeakObjectPtr<ASBCharacter>, TArray<FSBTrickZoneContact>>& SkaterContacts : Contacts)
+	{
+		SkaterContacts.Value.RemoveAllSwap([ZoneIndex](const FSBTrickZoneContact& Contact) { return Contact.ZoneIndex == ZoneIndex; });
+	}
+
+	Zone = FSBTrickZone();
+	FreeZones.Add(ZoneIndex);
+}
+
+void USBTrickZoneSubsystem::UpdateSkater(ASBCharacter* Skater, double Time)
+{
+	const UCapsuleComponent* Capsule = Skater->GetCapsuleComponent();
+	const FBox SkaterBounds = Capsule->Bounds.GetBox();
+	const FVector Location = Capsule->GetComponentLocation();
+	const FQuat Rotation = Capsule->GetComponentQuat();
+	const FCollisionShape Shape = Capsule->GetCollisionShape();
+
+	// Broadphase on the grid, only zones whose bounds touch the skater are tested against their actual shape
+	TArray<int32, TInlineAllocator<8>> Overlapping;
+	const FIntVector MinCell = GetCell(SkaterBounds.Min);
+	const FIntVector MaxCell = GetCell(SkaterBounds.Max);
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const TArray<int32>* CellZones = Grid.Find(FIntVector(X, Y, Z));
+				if (CellZones == nullptr)
+				{
+					continue;
+				}
+
+				for (const int32 ZoneIndex : *CellZones)
+				{
+					const FSBTrickZone& Zone = Zones[ZoneIndex];
+					const UPrimitiveComponent* Component = Zone.Component.Get();
+					if (Component != nullptr && Overlapping.Contains(ZoneIndex) == false && Zone.Bounds.Intersect(SkaterBounds)
+						&& Component->OverlapComponent(Location, Rotation, Shape))
+					{
+						Overlapping.Add(ZoneIndex);
+					}
+				}
+			}
+		}
+	}
+
+	TArray<FSBTrickZoneContact>& SkaterContacts = Contacts.FindOrAdd(Skater);
+	if (Overlapping.Num() == 0 && SkaterContacts.Num() == 0)
+	{
+		return;
+	}
+
+	for (FSBTrickZoneContact& Contact : SkaterContacts)
+	{
+		Contact.bWasInside = Contact.bInside;
+		Contact.bInside = false;
+	}
+
+	for (const int32 ZoneIndex : Overlapping)
+	{
+		FSBTrickZoneContact* Contact = SkaterContacts.FindByPredicate([ZoneIndex](const FSBTrickZoneContact& Existing) { return Existing.ZoneIndex == ZoneIndex; });
+		if (Contact == nullptr)
+		{
+			Contact = &SkaterContacts.AddDefaulted_GetRef();
+			Contact->ZoneIndex = ZoneIndex;
+		}
+		Contact->bInside = true;
+
+		// Only entering a zone scores, and only once per cooldown so bouncing on the edge of a zone doesn't score again
+		ASBScoreObstacle* Obstacle = Zones[ZoneIndex].Obstacle.Get();
+		if (Contact->bWasInside || Time < Contact->CooldownEndTime || Obstacle == nullptr || ScoreSubsystem == nullptr)
+		{
+			continue;
+		}
+
+		if (ScoreSubsystem->RequestAddScore(Skater, Obstacle->ScoreAmount, Obstacle->GetFName()))
+		{
+			Contact->CooldownEndTime = Time + Obstacle->ScoreCooldown;
+			Obstacle->OnScoreAdded();
+		}
+	}
+
+	SkaterContacts.RemoveAllSwap([Time](const FSBTrickZoneContact& Contact) { return Contact.bInside == false && Time >= Contact.CooldownEndTime; });
+}
+
+FIntVector USBTrickZoneSubsystem::GetCell(const FVector& Location)
+{
+	return FIntVector(FMath::FloorToInt32(Location.X / SBTrickZoneSubsystem::CellSize),
+	                  FMath::FloorToInt32(Location.Y / SBTrickZoneSubsystem::CellSize),
+	                  FMath::FloorToInt32(Location.Z / SBTrickZoneSubsystem::CellSize));
+}
@@ -0,0 +1,74 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBTrickZoneSubsystem.generated.h"
+
+class ASBCharacter;
+class ASBScoreObstacle;
+class USBScoreSubsystem;
+
+/** Collision channel marking the components of a score obstacle that act as its trick zone */
+#define ECC_TrickZone ECC_GameTraceChannel1
+
+/** Component of a score obstacle that skaters are tested against */
+struct FSBTrickZone
+{
+	TWeakObjectPtr<ASBScoreObstacle> Obstacle;
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	FBox Bounds = FBox(ForceInit);
+};
+
+/** Zones a skater is inside and when each of them can score again */
+struct FSBTrickZoneContact
+{
+	int32 ZoneIndex = INDEX_NONE;
+	double CooldownEndTime = 0.0;
+	bool bInside = false;
+	bool bWasInside = false;
+};
+
+/**
+ * Tests the skaters of every player against all score obstacles of the world once per frame.
+ * Zones are kept in a uniform grid, so a skater is only tested against the zones of the cells it touches.
+ * Replaces the overlap events of the obstacles, obstacles don't tick.
+ */
+UCLASS()
+class SKATEBOARDING_API USBTrickZoneSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Adds the trick zone components of an obstacle, called by the obstacle when it begins play */
+	void RegisterObstacle(ASBScoreObstacle* Obstacle);
+	void UnregisterObstacle(ASBScoreObstacle* Obstacle);
+
+	int32 GetNumZones() const { return Zones.Num() - FreeZones.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void AddZone(ASBScoreObstacle* Obstacle, UPrimitiveComponent* Component);
+	void RemoveZone(int32 ZoneIndex);
+	void UpdateSkater(ASBCharacter* Skater, double Time);
+
+	static FIntVector GetCell(const FVector& Location);
+
+	TArray<FSBTrickZone> Zones;
+	TArray<int32> FreeZones;
+	TMap<FIntVector, TArray<int32>> Grid;
+
+	TMap<TWeakObjectPtr<ASBCharacter>, TArray<FSBTrickZoneContact>> Contacts;
+
+	UPROPERTY()
+	TObjectPtr<USBScoreSubsystem> ScoreSubsystem;
+};
@@ -0,0 +1,310 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSkateSignificanceSubsystem.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SignificanceManager.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+const FName USBSkateSignificanceSubsystem::SkaterTag(TEXT("Skater"));
+
+namespace
+{
+	/** Frames run after switching the buckets before the budget report measures */
+	constexpr int32 BudgetWarmupFrames = 30;
+
+	TAutoConsoleVariable<bool> CVarSignificanceEnabled(
+		TEXT("sb.Significance.Enable"),
+		true,
+		TEXT("Lowers the movement and animation cost of insignificant skaters, off keeps every skater in the first bucket"));
+
+	FAutoConsoleCommandWithWorldAndArgs BudgetCommand(
+		TEXT("sb.Significance.Budget"),
+		TEXT("Measures the world tick with every skater at full cost and with the significance buckets. Usage: sb.Significance.Budget [Frames]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			if (USBSkateSignificanceSubsystem* SignificanceSubsystem = World != nullptr ? World->GetSubsystem<USBSkateSignificanceSubsystem>() : nullptr)
+			{
+				SignificanceSubsystem->StartBudgetReport(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 300);
+			}
+		}));
+}
+
+void USBSkateSignificanceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (Buckets.Num() == 0)
+	{
+		FSBSkateSignificanceBucket& Full = Buckets.AddDefaulted_GetRef();
+		Full.Name = TEXT("Full");
+		Full.MaxDistance = 2000.f;
+
+		FSBSkateSignificanceBucket& Near = Buckets.AddDefaulted_GetRef();
+		Near.Name = TEXT("Near");
+		Near.MaxDistance = 6000.f;
+		Near.bRequiresOnScreen = true;
+		Near.bUpdateRateOptimizations = true;
+
+		FSBSkateSignificanceBucket& Far = Buckets.AddDefaulted_GetRef();
+		Far.Name = TEXT("Far");
+		Far.MaxDistance = 15000.f;
+		Far.MovementTickInterval = 1.f / 30.f;
+		Far.AnimTickInterval = 1.f / 15.f;
+		Far.bReducedSkate = true;
+		Far.bUpdateRateOptimizations = true;
+
+		FSBSkateSignificanceBucket& Hidden = Buckets.AddDefaulted_GetRef();
+		Hidden.Name = TEXT("Hidden");
+		Hidden.MovementTickInterval = 1.f / 15.f;
+		Hidden.AnimTickInterval = 0.2f;
+		Hidden.bReducedSkate = true;
+		Hidden.bUpdateRateOptimizations = true;
+	}
+
+	TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &USBSkateSignificanceSubsystem::OnWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &USBSkateSignificanceSubsystem::OnWorldPostActorTick);
+}
+
+void USBSkateSignificanceSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	SkaterBuckets.Reset();
+
+	Super::Deinitialize();
+}
+
+void USBSkateSignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (SignificanceManager == nullptr || SkaterBuckets.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FTransform> Viewpoints;
+	GetViewpoints(Viewpoints);
+	SignificanceManager->Update(Viewpoints);
+
+	UpdateBudgetReport();
+}
+
+TStatId USBSkateSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBSkateSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void USBSkateSignificanceSubsystem::RegisterSkater(ASBCharacter* Skater)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (SignificanceManager == nullptr || Skater == nullptr || SkaterBuckets.Contains(Skater))
+	{
+		return;
+	}
+
+	// Skaters start in the full bucket, applied here since the character defaults don't match it
+	SkaterBuckets.Add(Skater, INDEX_NONE);
+	ApplyBucket(Skater, 0);
+
+	// Significance runs on worker threads and only reads the skater, the bucket is applied on the game thread after it
+	SignificanceManager->RegisterObject(Skater, SkaterTag,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+		{
+			return CalculateSignificance(CastChecked<ASBCharacter>(ObjectInfo->GetObject()), Viewpoint);
+		},
+		USignificanceManager::EPostSignificanceType::Sequential,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+		{
+			ApplyBucket(CastChecked<ASBCharacter>(ObjectInfo->GetObject()), Buckets.Num() - FMath::RoundToInt32(Significance));
+		});
+}
+
+void USBSkateSignificanceSubsystem::UnregisterSkater(ASBCharacter* Skater)
+{
+	if (SkaterBuckets.Remove(Skater) == 0)
+	{
+		return;
+	}
+
+	if (USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterObject(Skater);
+	}
+}
+
+int32 USBSkateSignificanceSubsystem::GetBucket(const ASBCharacter* Skater) const
+{
+	const int32* Bucket = SkaterBuckets.Find(Skater);
+	return Bucket != nullptr ? *Bucket : 0;
+}
+
+void USBSkateSignificanceSubsystem::StartBudgetReport(int32 Frames)
+{
+	BudgetFrames = FMath::Max(1, Frames);
+	BudgetFramesLeft = BudgetFrames + BudgetWarmupFrames;
+	BudgetTickTime[static_cast<int32>(EBudgetPhase::Full)] = 0.0;
+	BudgetTickTime[static_cast<int32>(EBudgetPhase::Bucketed)] = 0.0;
+	BudgetPhase = EBudgetPhase::Full;
+	bForceFullBucket = true;
+}
+
+bool USBSkateSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+float USBSkateSignificanceSubsystem::CalculateSignificance(const ASBCharacter* Skater, const FTransform& Viewpoint) const
+{
+	const int32 NumBuckets = Buckets.Num();
+
+	// The skater a player views has to run every step, on the server the same ones its client predicts
+	if (bForceFullBucket || CVarSignificanceEnabled.GetValueOnAnyThread() == false || ViewerPawns.Contains(Skater))
+	{
+		return NumBuckets;
+	}
+
+	const float DistanceSquared = FVector::DistSquared(Skater->GetActorLocation(), Viewpoint.GetLocation());
+	const bool bOnScreen = Skater->WasRecentlyRendered(0.2f);
+	for (int32 Bucket = 0; Bucket < NumBuckets - 1; ++Bucket)
+	{
+		const FSBSkateSignificanceBucket& Settings = Buckets[Bucket];
+		if (DistanceSquared <= FMath::Square(Settings.MaxDistance) && (bOnScreen || Settings.bRequiresOnScreen == false))
+		{
+			return NumBuckets - Bucket;
+		}
+	}
+	return 1.f;
+}
+
+void USBSkateSignificanceSubsystem::ApplyBucket(ASBCharacter* Skater, int32 Bucket)
+{
+	Bucket = FMath::Clamp(Bucket, 0, Buckets.Num() - 1);
+
+	int32* CurrentBucket = SkaterBuckets.Find(Skater);
+	if (CurrentBucket == nullptr || *CurrentBucket == Bucket)
+	{
+		return;
+	}
+	*CurrentBucket = Bucket;
+
+	const FSBSkateSignificanceBucket& Settings = Buckets[Bucket];
+	USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+	MovementComponent->SetComponentTickInterval(Settings.MovementTickInterval);
+	MovementComponent->SetReducedSkate(Settings.bReducedSkate);
+
+	if (USkeletalMeshComponent* Mesh = Skater->GetMesh())
+	{
+		Mesh->SetComponentTickInterval(Settings.AnimTickInterval);
+		Mesh->bEnableUpdateRateOptimizations = Settings.bUpdateRateOptimizations;
+	}
+}
+
+void USBSkateSignificanceSubsystem::GetViewpoints(TArray<FTransform>& OutViewpoints)
+{
+	ViewerPawns.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (PlayerController == nullptr)
+		{
+			continue;
+		}
+
+		if (const APawn* Pawn = PlayerController->GetPawn())
+		{
+			ViewerPawns.Add(Pawn);
+		}
+
+		if (PlayerController->IsLocalController())
+		{
+			FVector Location;
+			FRotator Rotation;
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+			OutViewpoints.Emplace(Rotation, Location);
+		}
+		else if (const APawn* Pawn = PlayerController->GetPawn())
+		{
+			// Dedicated servers have no views, the skaters close to any player matter
+			OutViewpoints.Emplace(Pawn->GetActorRotation(), Pawn->GetActorLocation());
+		}
+	}
+}
+
+void USBSkateSignificanceSubsystem::OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaTime)
+{
+	if (InWorld == GetWorld())
+	{
+		TickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void USBSkateSignificanceSubsystem::OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaTime)
+{
+	if (InWorld == GetWorld() && BudgetPhase != EBudgetPhase::None && BudgetFramesLeft <= BudgetFrames)
+	{
+		BudgetTickTime[static_cast<int32>(BudgetPhase)] += FPlatformTime::Seconds() - TickStartTime;
+	}
+}
+
+void USBSkateSignificanceSubsystem::UpdateBudgetReport()
+{
+	if (BudgetPhase == EBudgetPhase::None || --BudgetFramesLeft > 0)
+	{
+		return;
+	}
+
+	if (BudgetPhase == EBudgetPhase::Full)
+	{
+		BudgetPhase = EBudgetPhase::Bucketed;
+		BudgetFramesLeft = BudgetFrames + BudgetWarmupFrames;
+		bForceFullBucket = false;
+		return;
+	}
+
+	BudgetPhase = EBudgetPhase::None;
+
+	TArray<int32> BucketCounts;
+	BucketCounts.SetNumZeroed(Buckets.Num());
+	for (const TPair<TWeakObjectPtr<ASBCharacter>, int32>& SkaterBucket : SkaterBuckets)
+	{
+		if (SkaterBucket.Key.IsValid() && BucketCounts.IsValidIndex(SkaterBucket.Value))
+		{
+			++BucketCounts[SkaterBucket.Value];
+		}
+	}
+
+	const double FullMs = BudgetTickTime[static_cast<int32>(EBudgetPhase::Full)] * 1000.0 / BudgetFrames;
+	const double BucketedMs = BudgetTickTime[static_cast<int32>(EBudgetPhase::Bucketed)] * 1000.0 / BudgetFrames;
+	const double SavedMs = FullMs - BucketedMs;
+	const double SavedPercent = FullMs > 0.0 ? SavedMs / FullMs * 100.0 : 0.0;
+
+	FString BucketText;
+	FString BucketCsv;
+	for (int32 Bucket = 0; Bucket < Buckets.Num(); ++Bucket)
+	{
+		BucketText += FString::Printf(TEXT(" %s %d"), *Buckets[Bucket].Name.ToString(), BucketCounts[Bucket]);
+		BucketCsv += FString::Printf(TEXT("%s%s=%d"), Bucket > 0 ? TEXT(";") : TEXT(""), *Buckets[Bucket].Name.ToString(), BucketCounts[Bucket]);
+	}
+
+	UE_LOG(LogSkateMovement, Display, TEXT("Significance budget over %d frames, %d skaters:%s | world tick %.2fms at full cost, %.2fms bucketed, %.2fms (%.0f%%) saved"),
+	       BudgetFrames, SkaterBuckets.Num(), *BucketText, FullMs, BucketedMs, SavedMs, SavedPercent);
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("Significance") / TEXT("Budget.csv");
+	FString Csv = FString::Printf(TEXT("%s,%d,%d,%.3f,%.3f,%.3f,%.1f,%s\n"), *FDateTime::Now().ToString(), SkaterBuckets.Num(), BudgetFrames,
+	                              FullMs, BucketedMs, SavedMs, SavedPercent, *BucketCsv);
+	if (IFileManager::Get().FileExists(*Filename) == false)
+	{
+		Csv = TEXT("Date,Skaters,Frames,FullMs,BucketedMs,SavedMs,SavedPercent,Buckets\n") + Csv;
+	}
+	FFileHelper::SaveStringToFile(Csv, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
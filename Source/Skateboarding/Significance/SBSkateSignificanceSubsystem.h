@@ -0,0 +1,117 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBSkateSignificanceSubsystem.generated.h"
+
+class APawn;
+class ASBCharacter;
+
+/** Update budget of the skaters in a significance bucket */
+USTRUCT()
+struct FSBSkateSignificanceBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	FName Name;
+
+	/** Skaters farther than this from every viewpoint fall to a later bucket */
+	UPROPERTY(Config)
+	float MaxDistance = UE_BIG_NUMBER;
+
+	/** Off screen skaters fall to a later bucket */
+	UPROPERTY(Config)
+	bool bRequiresOnScreen = false;
+
+	/** Seconds between movement component ticks, 0 ticks every frame */
+	UPROPERTY(Config)
+	float MovementTickInterval = 0.f;
+
+	/** Seconds between skeletal mesh ticks, 0 ticks every frame */
+	UPROPERTY(Config)
+	float AnimTickInterval = 0.f;
+
+	/** Runs the reduced skate steps, see USBCharacterMovementComponent::SetReducedSkate */
+	UPROPERTY(Config)
+	bool bReducedSkate = false;
+
+	/** Lets the animation update rate optimizations skip and interpolate frames */
+	UPROPERTY(Config)
+	bool bUpdateRateOptimizations = false;
+};
+
+/**
+ * Buckets the skaters by distance to the viewpoints and on screen presence through the significance manager,
+ * and lowers the movement and animation cost of the less significant buckets. The pawn of every viewer, the local
+ * players or the connected players on a server, always stays in the first bucket.
+ * Viewpoints are the local player views, or the player pawns on a dedicated server.
+ *
+ * sb.Significance.Budget measures the world tick with and without the buckets and reports the time saved.
+ */
+UCLASS(Config = Game)
+class SKATEBOARDING_API USBSkateSignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterSkater(ASBCharacter* Skater);
+	void UnregisterSkater(ASBCharacter* Skater);
+
+	/** Bucket of a registered skater, 0 is the most significant */
+	int32 GetBucket(const ASBCharacter* Skater) const;
+
+	/** Runs Frames world ticks with every skater in the first bucket, then as many with the buckets, and reports both */
+	void StartBudgetReport(int32 Frames);
+
+	static const FName SkaterTag;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	float CalculateSignificance(const ASBCharacter* Skater, const FTransform& Viewpoint) const;
+	void ApplyBucket(ASBCharacter* Skater, int32 Bucket);
+	/** Also collects the pawns of the viewers */
+	void GetViewpoints(TArray<FTransform>& OutViewpoints);
+
+	void OnWorldTickStart(UWorld* InWorld, ELevelTick TickType, float DeltaTime);
+	void OnWorldPostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaTime);
+	void UpdateBudgetReport();
+
+	/** From the most to the least significant, the last bucket takes every skater left */
+	UPROPERTY(Config)
+	TArray<FSBSkateSignificanceBucket> Buckets;
+
+	TMap<TWeakObjectPtr<ASBCharacter>, int32> SkaterBuckets;
+
+	/** Pawns of the player controllers, gathered with the viewpoints and read by the significance workers */
+	TArray<const APawn*, TInlineAllocator<4>> ViewerPawns;
+
+	/** Buckets are forced to the first one while the budget report measures the full cost */
+	bool bForceFullBucket = false;
+
+	enum class EBudgetPhase : uint8
+	{
+		None,
+		Full,
+		Bucketed,
+	};
+
+	EBudgetPhase BudgetPhase = EBudgetPhase::None;
+	int32 BudgetFrames = 0;
+	int32 BudgetFramesLeft = 0;
+	double BudgetTickTime[3] = {};
+	double TickStartTime = 0.0;
+
+	FDelegateHandle TickStartHandle;
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,287 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBStreamingRouteSubsystem.h"
+
+#include "Components/SplineComponent.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+
+const FName USBStreamingRouteSubsystem::StreamingRouteTag(TEXT("StreamingRoute"));
+
+namespace
+{
+	TAutoConsoleVariable<float> CVarStreamingHitchThreshold(
+		TEXT("sb.Streaming.HitchThresholdMs"),
+		50.f,
+		TEXT("Frames of a streaming route run longer than this count as hitches"));
+
+	FAutoConsoleCommandWithWorldAndArgs RouteTestCommand(
+		TEXT("sb.Streaming.RouteTest"),
+		TEXT("Drives the local pawn along the StreamingRoute spline and reports streaming hitches. Usage: sb.Streaming.RouteTest [Speed] [Duration] [quit]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			USBStreamingRouteSubsystem* RouteSubsystem = World != nullptr ? World->GetSubsystem<USBStreamingRouteSubsystem>() : nullptr;
+			if (RouteSubsystem == nullptr)
+			{
+				return;
+			}
+
+			const float Speed = Args.Num() > 0 ? FCString::Atof(*Args[0]) : 2500.f;
+			const float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 60.f;
+			const bool bQuit = Args.Num() > 2 && Args[2].Equals(TEXT("quit"), ESearchCase::IgnoreCase);
+			RouteSubsystem->StartRoute(Speed, Duration, bQuit);
+		}));
+
+	FAutoConsoleCommandWithWorld StopRouteCommand(
+		TEXT("sb.Streaming.StopRoute"),
+		TEXT("Ends the current streaming route run and writes its report"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (USBStreamingRouteSubsystem* RouteSubsystem = World != nullptr ? World->GetSubsystem<USBStreamingRouteSubsystem>() : nullptr)
+			{
+				RouteSubsystem->StopRoute();
+			}
+		}));
+}
+
+void USBStreamingRouteSubsystem::Deinitialize()
+{
+	if (bStarted)
+	{
+		WriteReport();
+	}
+	bRequested = false;
+	bStarted = false;
+
+	Super::Deinitialize();
+}
+
+void USBStreamingRouteSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (bRequested == false)
+	{
+		return;
+	}
+
+	// Commands passed with -ExecCmds run before the player has a pawn
+	if (bStarted == false && BeginRun() == false)
+	{
+		return;
+	}
+
+	if (Pawn.IsValid() == false)
+	{
+		StopRoute();
+		return;
+	}
+
+	RecordFrame();
+	MovePawn(DeltaTime);
+
+	if (bStarted && FPlatformTime::Seconds() - StartTime >= Duration)
+	{
+		StopRoute();
+	}
+}
+
+TStatId USBStreamingRouteSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USBStreamingRouteSubsystem, STATGROUP_Tickables);
+}
+
+void USBStreamingRouteSubsystem::StartRoute(float InSpeed, float InDuration, bool bInQuitWhenDone)
+{
+	if (bStarted)
+	{
+		// Replacing a run doesn't end the session
+		bQuitWhenDone = false;
+		StopRoute();
+	}
+
+	Speed = FMath::Max(0.f, InSpeed);
+	Duration = FMath::Max(0.f, InDuration);
+	bQuitWhenDone = bInQuitWhenDone;
+	bRequested = true;
+}
+
+void USBStreamingRouteSubsystem::StopRoute()
+{
+	if (bStarted)
+	{
+		WriteReport();
+	}
+
+	if (Pawn.IsValid())
+	{
+		Pawn->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	}
+
+	bRequested = false;
+	bStarted = false;
+	Pawn.Reset();
+	Route.Reset();
+	Frames.Reset();
+
+	if (bQuitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+FString USBStreamingRouteSubsystem::GetReportDir()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Streaming");
+}
+
+bool USBStreamingRouteSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool USBStreamingRouteSubsystem::BeginRun()
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	ACharacter* Character = PlayerController != nullptr ? Cast<ACharacter>(PlayerController->GetPawn()) : nullptr;
+	if (Character == nullptr)
+	{
+		return false;
+	}
+
+	Route.Reset();
+	for (TActorIterator<AActor> It(GetWorld()); It && Route.IsValid() == false; ++It)
+	{
+		TInlineComponentArray<USplineComponent*> Splines(*It);
+		for (USplineComponent* Spline : Splines)
+		{
+			if (Spline->ComponentHasTag(StreamingRouteTag))
+			{
+				Route = Spline;
+				break;
+			}
+		}
+	}
+
+	// Route drives the pawn, the movement component would fight it
+	Character->GetCharacterMovement()->DisableMovement();
+
+	Pawn = Character;
+	StartTransform = FTransform(FRotator(0.f, Character->GetActorRotation().Yaw, 0.f), Character->GetActorLocation());
+	Distance = 0.f;
+	StartTime = FPlatformTime::Seconds();
+	LastFrameTime = StartTime;
+	Frames.Reset();
+	bStarted = true;
+
+	UE_LOG(LogSkateMovement, Display, TEXT("Streaming route started at %.0f cm/s for %.0fs along %s"), Speed, Duration,
+	       Route.IsValid() ? *Route->GetPathName() : TEXT("a straight line"));
+	return true;
+}
+
+void USBStreamingRouteSubsystem::MovePawn(float DeltaTime)
+{
+	Distance += Speed * DeltaTime;
+
+	FVector Location;
+	FVector Direction;
+	if (const USplineComponent* Spline = Route.Get())
+	{
+		const float Length = Spline->GetSplineLength();
+		if (Distance > Length && Spline->IsClosedLoop() == false)
+		{
+			StopRoute();
+			return;
+		}
+
+		const float RouteDistance = Length > 0.f ? FMath::Fmod(Distance, Length) : 0.f;
+		Location = Spline->GetLocationAtDistanceAlongSpline(RouteDistance, ESplineCoordinateSpace::World);
+		Direction = Spline->GetDirectionAtDistanceAlongSpline(RouteDistance, ESplineCoordinateSpace::World);
+	}
+	else
+	{
+		Direction = StartTransform.GetUnitAxis(EAxis::X);
+		Location = StartTransform.GetLocation() + Direction * Distance;
+	}
+
+	ACharacter* Character = Pawn.Get();
+	Character->SetActorLocationAndRotation(Location, FRotator(0.f, Direction.Rotation().Yaw, 0.f), false, nullptr, ETeleportType::TeleportPhysics);
+
+	// Streaming source predicts from the movement velocity, keep it as if the pawn was skating the route
+	Character->GetCharacterMovement()->Velocity = Direction * Speed;
+}
+
+void USBStreamingRouteSubsystem::RecordFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	FSBStreamingRouteFrame& Frame = Frames.AddDefaulted_GetRef();
+	Frame.Time = Now - StartTime;
+	Frame.FrameMs = static_cast<float>((Now - LastFrameTime) * 1000.0);
+	Frame.Distance = Distance;
+	Frame.UsedPhysicalMB = static_cast<float>(FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+
+	// Not completed means cells the streaming sources want are still loading
+	const UWorldPartitionSubsystem* WorldPartitionSubsystem = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>();
+	Frame.bStreamingCompleted = WorldPartitionSubsystem == nullptr || WorldPartitionSubsystem->IsStreamingCompleted();
+
+	LastFrameTime = Now;
+}
+
+void USBStreamingRouteSubsystem::WriteReport() const
+{
+	if (Frames.Num() == 0)
+	{
+		return;
+	}
+
+	const float HitchThreshold = CVarStreamingHitchThreshold.GetValueOnGameThread();
+
+	FString Csv = TEXT("Time,FrameMs,Distance,UsedPhysicalMB,StreamingCompleted\n");
+	TArray<float> FrameTimes;
+	FrameTimes.Reserve(Frames.Num());
+	int32 Hitches = 0;
+	int32 StreamingHitches = 0;
+	int32 PendingFrames = 0;
+	float PeakMemory = 0.f;
+
+	// First frame measures the time since the run was requested
+	for (int32 Index = 1; Index < Frames.Num(); ++Index)
+	{
+		const FSBStreamingRouteFrame& Frame = Frames[Index];
+		Csv += FString::Printf(TEXT("%.4f,%.3f,%.1f,%.1f,%d\n"), Frame.Time, Frame.FrameMs, Frame.Distance, Frame.UsedPhysicalMB, Frame.bStreamingCompleted ? 1 : 0);
+
+		FrameTimes.Add(Frame.FrameMs);
+		PeakMemory = FMath::Max(PeakMemory, Frame.UsedPhysicalMB);
+		PendingFrames += Frame.bStreamingCompleted ? 0 : 1;
+		if (Frame.FrameMs > HitchThreshold)
+		{
+			++Hitches;
+			StreamingHitches += Frame.bStreamingCompleted ? 0 : 1;
+		}
+	}
+
+	FrameTimes.Sort();
+	const float WorstMs = FrameTimes.Num() > 0 ? FrameTimes.Last() : 0.f;
+	const float P99Ms = FrameTimes.Num() > 0 ? FrameTimes[FMath::Min(FrameTimes.Num() - 1, FrameTimes.Num() * 99 / 100)] : 0.f;
+
+	const FString MapName = FPackageName::GetShortName(UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName()));
+	const FString Filename = GetReportDir() / FString::Printf(TEXT("%s_%.0f_%s.csv"), *MapName, Speed, *FDateTime::Now().ToString());
+	if (FFileHelper::SaveStringToFile(Csv, *Filename) == false)
+	{
+		UE_LOG(LogSkateMovement, Warning, TEXT("Failed to write the streaming route report to %s"), *Filename);
+	}
+
+	UE_LOG(LogSkateMovement, Display, TEXT("Streaming route: %d frames over %.0f cm at %.0f cm/s | hitches %d (%d while streaming) over %.0fms, worst %.1fms, p99 %.1fms | streaming pending %d frames | peak used physical %.0f MB | %s"),
+	       FrameTimes.Num(), Distance, Speed, Hitches, StreamingHitches, HitchThreshold, WorstMs, P99Ms, PendingFrames, PeakMemory, *Filename);
+}
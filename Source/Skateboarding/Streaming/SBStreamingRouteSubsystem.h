@@ -0,0 +1,74 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBStreamingRouteSubsystem.generated.h"
+
+class ACharacter;
+class USplineComponent;
+
+/** One frame of a streaming route run */
+struct FSBStreamingRouteFrame
+{
+	double Time = 0.0;
+	float FrameMs = 0.f;
+	float Distance = 0.f;
+	float UsedPhysicalMB = 0.f;
+	bool bStreamingCompleted = true;
+};
+
+/**
+ * Drives the first local pawn along a scripted route at a fixed speed and measures the streaming hitches on the way.
+ * The route is the first spline component tagged StreamingRoute, or a straight line ahead of the pawn without one.
+ * Frames, streaming state and resident memory are written to Saved/Streaming, so headless runs can be compared:
+ * -game -nullrhi -ExecCmds="sb.Streaming.RouteTest 2500 60 quit"
+ */
+UCLASS()
+class SKATEBOARDING_API USBStreamingRouteSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Starts a run once there is a local pawn, the run ends after Duration seconds or at the end of an open route */
+	void StartRoute(float InSpeed, float InDuration, bool bInQuitWhenDone);
+	/** Ends the current run and writes its report */
+	void StopRoute();
+
+	bool IsRunning() const { return bRequested; }
+
+	static const FName StreamingRouteTag;
+
+	static FString GetReportDir();
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	bool BeginRun();
+	void MovePawn(float DeltaTime);
+	void RecordFrame();
+	void WriteReport() const;
+
+	bool bRequested = false;
+	bool bStarted = false;
+	bool bQuitWhenDone = false;
+	float Speed = 0.f;
+	float Duration = 0.f;
+
+	TWeakObjectPtr<ACharacter> Pawn;
+	TWeakObjectPtr<USplineComponent> Route;
+	/** Start of the straight route when there is no route spline */
+	FTransform StartTransform;
+	float Distance = 0.f;
+
+	double StartTime = 0.0;
+	double LastFrameTime = 0.0;
+	TArray<FSBStreamingRouteFrame> Frames;
+};
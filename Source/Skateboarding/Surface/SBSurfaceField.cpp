@@ -0,0 +1,281 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSurfaceField.h"
+
+#include "Async/MappedFileHandle.h"
+#include "Engine/HitResult.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+FSBSurfaceField::~FSBSurfaceField()
+{
+	Reset();
+}
+
+void FSBSurfaceField::Reset()
+{
+	Header = nullptr;
+	BrickIndex = nullptr;
+	Samples = nullptr;
+	SurfaceKeys.Empty();
+
+	// Region has to be unmapped before its file handle is closed
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	LoadedData.Empty();
+}
+
+bool FSBSurfaceField::Load(const FString& Filename)
+{
+	Reset();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (MappedFile.IsValid())
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if (MappedRegion.IsValid() && SetData(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()))
+		{
+			return true;
+		}
+	}
+
+	Reset();
+
+	// Platform can't map the file (e.g. inside a pak), keep a copy in memory instead
+	if (FFileHelper::LoadFileToArray(LoadedData, *Filename, FILEREAD_Silent) == false)
+	{
+		return false;
+	}
+
+	return SetData(LoadedData.GetData(), LoadedData.Num());
+}
+
+bool FSBSurfaceField::SetData(const uint8* Data, int64 Size)
+{
+	Header = nullptr;
+	BrickIndex = nullptr;
+	Samples = nullptr;
+	SurfaceKeys.Empty();
+
+	if (Data == nullptr || Size < static_cast<int64>(sizeof(FSBSurfaceFieldHeader)))
+	{
+		return false;
+	}
+
+	const FSBSurfaceFieldHeader* FileHeader = reinterpret_cast<const FSBSurfaceFieldHeader*>(Data);
+	if (FileHeader->Magic != FSBSurfaceFieldHeader::ExpectedMagic || FileHeader->Version != FSBSurfaceFieldHeader::ExpectedVersion
+		|| FileHeader->BrickSize <= 0 || FileHeader->CellSize <= 0.f || FileHeader->NumBricks < 0
+		|| FileHeader->BrickGridSize.X <= 0 || FileHeader->BrickGridSize.Y <= 0 || FileHeader->BrickGridSize.Z <= 0
+		|| FileHeader->SurfaceTableSize < 0)
+	{
+		return false;
+	}
+
+	const int64 NumIndices = static_cast<int64>(FileHeader->BrickGridSize.X) * FileHeader->BrickGridSize.Y * FileHeader->BrickGridSize.Z;
+	const int64 IndexSize = NumIndices * sizeof(int32);
+	const int64 SamplesSize = static_cast<int64>(FileHeader->NumBricks) * GetSamplesPerBrick(FileHeader->BrickSize) * sizeof(FSBSurfaceFieldSample);
+	if (static_cast<int64>(sizeof(FSBSurfaceFieldHeader)) + IndexSize + SamplesSize + FileHeader->SurfaceTableSize > Size)
+	{
+		return false;
+	}
+
+	// Samples are read straight from the index, a stale or damaged bake must not point past the stored bricks
+	const int32* FileBrickIndex = reinterpret_cast<const int32*>(Data + sizeof(FSBSurfaceFieldHeader));
+	for (int64 Index = 0; Index < NumIndices; ++Index)
+	{
+		if (FileBrickIndex[Index] != INDEX_NONE && (FileBrickIndex[Index] < 0 || FileBrickIndex[Index] >= FileHeader->NumBricks))
+		{
+			return false;
+		}
+	}
+
+	Header = FileHeader;
+	BrickIndex = FileBrickIndex;
+	Samples = reinterpret_cast<const FSBSurfaceFieldSample*>(Data + sizeof(FSBSurfaceFieldHeader) + IndexSize);
+	SamplesPerBrick = GetSamplesPerBrick(Header->BrickSize);
+
+	TArray<FString> SurfaceLines;
+	if (Header->SurfaceTableSize > 0)
+	{
+		const uint8* SurfaceTable = Data + sizeof(FSBSurfaceFieldHeader) + IndexSize + SamplesSize;
+		const FUTF8ToTCHAR SurfaceTableText(reinterpret_cast<const UTF8CHAR*>(SurfaceTable), Header->SurfaceTableSize);
+		FString(SurfaceTableText.Length(), SurfaceTableText.Get()).ParseIntoArray(SurfaceLines, TEXT("\n"), false);
+	}
+
+	SurfaceKeys.SetNum(SurfaceLines.Num() + 1);
+	for (int32 Line = 0; Line < SurfaceLines.Num(); ++Line)
+	{
+		TArray<FString> Paths;
+		SurfaceLines[Line].ParseIntoArray(Paths, TEXT(";"));
+		for (const FString& Path : Paths)
+		{
+			SurfaceKeys[Line + 1].Emplace(Path);
+		}
+	}
+	return true;
+}
+
+bool FSBSurfaceField::Sample(const FVector& Location, float& OutDistance, FVector& OutNormal, uint8* OutSurface) const
+{
+	if (Header == nullptr)
+	{
+		return false;
+	}
+
+	const FVector3f Local = (FVector3f(Location) - Header->Origin) / Header->CellSize;
+	const int32 CellX = FMath::FloorToInt32(Local.X);
+	const int32 CellY = FMath::FloorToInt32(Local.Y);
+	const int32 CellZ = FMath::FloorToInt32(Local.Z);
+	if (CellX < 0 || CellY < 0 || CellZ < 0)
+	{
+		return false;
+	}
+
+	const int32 BrickSize = Header->BrickSize;
+	const FIntVector3& GridSize = Header->BrickGridSize;
+	const int32 BrickX = CellX / BrickSize;
+	const int32 BrickY = CellY / BrickSize;
+	const int32 BrickZ = CellZ / BrickSize;
+	if (BrickX >= GridSize.X || BrickY >= GridSize.Y || BrickZ >= GridSize.Z)
+	{
+		return false;
+	}
+
+	const int32 BrickSlot = BrickIndex[(BrickZ * GridSize.Y + BrickY) * GridSize.X + BrickX];
+	if (BrickSlot < 0)
+	{
+		// Empty bricks are outside the narrow band
+		OutDistance = Header->MaxDistance;
+		OutNormal = FVector::UpVector;
+		if (OutSurface != nullptr)
+		{
+			*OutSurface = 0;
+		}
+		return true;
+	}
+
+	const FSBSurfaceFieldSample* BrickSamples = Samples + static_cast<int64>(BrickSlot) * SamplesPerBrick;
+	const int32 Stride = BrickSize + 1;
+	const int32 X = CellX - BrickX * BrickSize;
+	const int32 Y = CellY - BrickY * BrickSize;
+	const int32 Z = CellZ - BrickZ * BrickSize;
+	const float FracX = Local.X - CellX;
+	const float FracY = Local.Y - CellY;
+	const float FracZ = Local.Z - CellZ;
+
+	float Distance = 0.f;
+	FVector3f Normal = FVector3f::ZeroVector;
+	float SurfaceWeight = -1.f;
+	uint8 Surface = 0;
+	for (int32 Corner = 0; Corner < 8; ++Corner)
+	{
+		const int32 OffsetX = Corner & 1;
+		const int32 OffsetY = (Corner >> 1) & 1;
+		const int32 OffsetZ = (Corner >> 2) & 1;
+		const float Weight = (OffsetX ? FracX : 1.f - FracX) * (OffsetY ? FracY : 1.f - FracY) * (OffsetZ ? FracZ : 1.f - FracZ);
+
+		const FSBSurfaceFieldSample& CornerSample = BrickSamples[((Z + OffsetZ) * Stride + Y + OffsetY) * Stride + X + OffsetX];
+		Distance += Weight * CornerSample.Distance;
+		Normal += Weight * FVector3f(CornerSample.NormalX, CornerSample.NormalY, CornerSample.NormalZ);
+
+		// Surface slots can't be blended, the nearest corner decides
+		if (Weight > SurfaceWeight)
+		{
+			SurfaceWeight = Weight;
+			Surface = CornerSample.Surface;
+		}
+	}
+
+	OutDistance = Distance / MAX_uint16 * Header->MaxDistance;
+	OutNormal = FVector(Normal.GetSafeNormal(UE_SMALL_NUMBER, FVector3f::UpVector));
+	if (OutSurface != nullptr)
+	{
+		*OutSurface = Surface;
+	}
+	return true;
+}
+
+ESBSurfaceFieldResult FSBSurfaceField::Probe(const FVector& Start, const FVector& End, FHitResult& OutHit) const
+{
+	if (Header == nullptr)
+	{
+		return ESBSurfaceFieldResult::Unknown;
+	}
+
+	const FVector Delta = End - Start;
+	const float Length = Delta.Size();
+	if (Length <= UE_KINDA_SMALL_NUMBER)
+	{
+		return ESBSurfaceFieldResult::NoSurface;
+	}
+
+	const FVector Direction = Delta / Length;
+	const float SurfaceTolerance = Header->CellSize * 0.25f;
+
+	// Distance to the closest surface is a safe step along any direction
+	float Travelled = 0.f;
+	for (int32 Iteration = 0; Iteration < 64 && Travelled <= Length; ++Iteration)
+	{
+		const FVector Location = Start + Direction * Travelled;
+
+		float Distance;
+		FVector Normal;
+		uint8 Surface;
+		if (Sample(Location, Distance, Normal, &Surface) == false)
+		{
+			return ESBSurfaceFieldResult::Unknown;
+		}
+
+		if (Distance <= SurfaceTolerance)
+		{
+			OutHit = FHitResult(Start, End);
+			OutHit.bBlockingHit = true;
+			OutHit.Time = Travelled / Length;
+			OutHit.Distance = Travelled;
+			OutHit.Location = Location;
+			OutHit.ImpactPoint = Location;
+			OutHit.Normal = Normal;
+			OutHit.ImpactNormal = Normal;
+			// There is no primitive to resolve the surface from, the slot stands in for it
+			OutHit.Item = Surface;
+			return ESBSurfaceFieldResult::Surface;
+		}
+
+		Travelled += FMath::Max(Distance, SurfaceTolerance);
+	}
+
+	return ESBSurfaceFieldResult::NoSurface;
+}
+
+bool FSBSurfaceField::Save(const FString& Filename, const FSBSurfaceFieldHeader& InHeader, const TArray<int32>& InBrickIndex, const TArray<FSBSurfaceFieldSample>& InSamples,
+                           const FString& InSurfaceTable)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (Writer.IsValid() == false)
+	{
+		return false;
+	}
+
+	const FTCHARToUTF8 SurfaceTable(*InSurfaceTable);
+	FSBSurfaceFieldHeader FileHeader = InHeader;
+	FileHeader.SurfaceTableSize = SurfaceTable.Length();
+
+	Writer->Serialize(&FileHeader, sizeof(FSBSurfaceFieldHeader));
+	Writer->Serialize(const_cast<int32*>(InBrickIndex.GetData()), InBrickIndex.Num() * sizeof(int32));
+	Writer->Serialize(const_cast<FSBSurfaceFieldSample*>(InSamples.GetData()), InSamples.Num() * sizeof(FSBSurfaceFieldSample));
+	Writer->Serialize(const_cast<void*>(static_cast<const void*>(SurfaceTable.Get())), SurfaceTable.Length());
+	return Writer->Close();
+}
+
+uint16 FSBSurfaceField::QuantizeDistance(float Distance, float MaxDistance)
+{
+	return static_cast<uint16>(FMath::Clamp(FMath::RoundToInt32(Distance / MaxDistance * MAX_uint16), 0, static_cast<int32>(MAX_uint16)));
+}
+
+int8 FSBSurfaceField::QuantizeNormal(float Value)
+{
+	return static_cast<int8>(FMath::Clamp(FMath::RoundToInt32(Value * 127.f), -127, 127));
+}
@@ -0,0 +1,99 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+struct FHitResult;
+
+/** Header of a baked surface field file, followed by the brick index, the brick samples and the surface table */
+struct FSBSurfaceFieldHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x46534253; // "SBSF"
+	static constexpr uint32 ExpectedVersion = 2;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = ExpectedVersion;
+	FVector3f Origin = FVector3f::ZeroVector;
+	float CellSize = 10.f;
+	/** Distance stored at and beyond the narrow band, empty bricks are at least this far from any surface */
+	float MaxDistance = 30.f;
+	/** Cells per brick edge, bricks store one extra sample per axis so trilinear lookups never cross bricks */
+	int32 BrickSize = 8;
+	FIntVector3 BrickGridSize = FIntVector3(0, 0, 0);
+	int32 NumBricks = 0;
+	/** Bytes of the surface table, UTF-8 lines of ';' separated object paths, line N describes surface slot N + 1 */
+	int32 SurfaceTableSize = 0;
+};
+
+/** Quantized distance to the closest static surface, its normal and its surface slot */
+struct FSBSurfaceFieldSample
+{
+	uint16 Distance = 0;
+	int8 NormalX = 0;
+	int8 NormalY = 0;
+	int8 NormalZ = 127;
+	/** Slot in the surface table of the closest primitive, 0 if unknown */
+	uint8 Surface = 0;
+};
+
+static_assert(sizeof(FSBSurfaceFieldSample) == 6, "Surface field samples are written to disk as is");
+
+enum class ESBSurfaceFieldResult : uint8
+{
+	/** Probe left the baked area, the caller has to trace */
+	Unknown,
+	NoSurface,
+	Surface,
+};
+
+/**
+ * Sparse narrow band distance and normal field of the static skatepark geometry, baked offline by SBBakeSurfaceField.
+ * A dense brick index gives O(1) access to 8x8x8 sample bricks, only bricks close to a surface are stored.
+ * The file is memory mapped when the platform allows it, queries never touch the physics scene.
+ */
+class FSBSurfaceField
+{
+public:
+	FSBSurfaceField() = default;
+	~FSBSurfaceField();
+
+	FSBSurfaceField(const FSBSurfaceField&) = delete;
+	FSBSurfaceField& operator=(const FSBSurfaceField&) = delete;
+
+	bool Load(const FString& Filename);
+	void Reset();
+	bool IsLoaded() const { return Header != nullptr; }
+
+	/** Trilinear distance and normal at a location, and the surface slot of the nearest sample. False outside the baked area */
+	bool Sample(const FVector& Location, float& OutDistance, FVector& OutNormal, uint8* OutSurface = nullptr) const;
+
+	/** Sphere traces the segment against the field, fills the hit like a line trace would with the surface slot as its item */
+	ESBSurfaceFieldResult Probe(const FVector& Start, const FVector& End, FHitResult& OutHit) const;
+
+	/** Object paths describing each surface slot, slot 0 is unknown and has none */
+	const TArray<TArray<FSoftObjectPath>>& GetSurfaceKeys() const { return SurfaceKeys; }
+
+	static bool Save(const FString& Filename, const FSBSurfaceFieldHeader& InHeader, const TArray<int32>& InBrickIndex, const TArray<FSBSurfaceFieldSample>& InSamples,
+	                 const FString& InSurfaceTable);
+
+	static int32 GetSamplesPerBrick(int32 BrickSize) { return (BrickSize + 1) * (BrickSize + 1) * (BrickSize + 1); }
+	static uint16 QuantizeDistance(float Distance, float MaxDistance);
+	static int8 QuantizeNormal(float Value);
+
+private:
+	bool SetData(const uint8* Data, int64 Size);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	/** Owns the data when the platform can't map the file */
+	TArray64<uint8> LoadedData;
+
+	const FSBSurfaceFieldHeader* Header = nullptr;
+	const int32* BrickIndex = nullptr;
+	const FSBSurfaceFieldSample* Samples = nullptr;
+	int32 SamplesPerBrick = 0;
+	TArray<TArray<FSoftObjectPath>> SurfaceKeys;
+};
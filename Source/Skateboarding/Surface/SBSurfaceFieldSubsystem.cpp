@@ -0,0 +1,52 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSurfaceFieldSubsystem.h"
+
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+void USBSurfaceFieldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const FString MapPackageName = UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName());
+	const FString Filename = GetFieldFilename(MapPackageName);
+	if (FPaths::FileExists(Filename) == false)
+	{
+		return;
+	}
+
+	if (Field.Load(Filename))
+	{
+		UE_LOG(LogSkateMovement, Log, TEXT("Loaded surface field %s"), *Filename);
+	}
+	else
+	{
+		UE_LOG(LogSkateMovement, Warning, TEXT("Surface field %s is damaged or from an older bake, skaters trace the ground until the map is baked again"), *Filename);
+	}
+}
+
+void USBSurfaceFieldSubsystem::Deinitialize()
+{
+	Field.Reset();
+
+	Super::Deinitialize();
+}
+
+const FSBSurfaceField* USBSurfaceFieldSubsystem::GetField() const
+{
+	return Field.IsLoaded() ? &Field : nullptr;
+}
+
+FString USBSurfaceFieldSubsystem::GetFieldFilename(const FString& MapPackageName)
+{
+	return FPaths::ProjectContentDir() / TEXT("SurfaceFields") / FPackageName::GetShortName(MapPackageName) + TEXT(".sbfield");
+}
+
+bool USBSurfaceFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
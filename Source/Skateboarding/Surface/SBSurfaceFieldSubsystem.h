@@ -0,0 +1,33 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SBSurfaceField.h"
+#include "SBSurfaceFieldSubsystem.generated.h"
+
+/**
+ * Loads the baked surface field of the current map, if one was baked with SBBakeSurfaceField
+ */
+UCLASS()
+class SKATEBOARDING_API USBSurfaceFieldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Returns the field of this map, null if the map has no baked field */
+	const FSBSurfaceField* GetField() const;
+
+	/** Location of the baked field file of a map, staged as a loose file so it can be memory mapped */
+	static FString GetFieldFilename(const FString& MapPackageName);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	FSBSurfaceField Field;
+};
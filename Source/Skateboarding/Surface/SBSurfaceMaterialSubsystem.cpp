@@ -0,0 +1,103 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSurfaceMaterialSubsystem.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/HitResult.h"
+#include "SBSurfaceFieldSubsystem.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+void USBSurfaceMaterialSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const USBSurfaceMaterialTable* Table = SurfaceTable.IsNull() ? nullptr : SurfaceTable.LoadSynchronous();
+	if (Table == nullptr)
+	{
+		UE_CLOG(SurfaceTable.IsNull() == false, LogSkateMovement, Warning, TEXT("Surface table %s failed to load, using the default surfaces"), *SurfaceTable.ToString());
+		Table = GetDefault<USBSurfaceMaterialTable>();
+	}
+	BuildTable(*Table);
+
+	// Field slots are matched once here, field hits then cost an array lookup
+	const USBSurfaceFieldSubsystem* SurfaceFieldSubsystem = Collection.InitializeDependency<USBSurfaceFieldSubsystem>();
+	if (const FSBSurfaceField* Field = SurfaceFieldSubsystem != nullptr ? SurfaceFieldSubsystem->GetField() : nullptr)
+	{
+		const TArray<TArray<FSoftObjectPath>>& FieldSurfaceKeys = Field->GetSurfaceKeys();
+		FieldSurfaces.SetNumZeroed(FieldSurfaceKeys.Num());
+		for (int32 Slot = 0; Slot < FieldSurfaceKeys.Num(); ++Slot)
+		{
+			FieldSurfaces[Slot] = FindSurface(FieldSurfaceKeys[Slot]);
+		}
+	}
+}
+
+void USBSurfaceMaterialSubsystem::Deinitialize()
+{
+	PrimitiveSurfaces.Empty();
+	FieldSurfaces.Empty();
+
+	Super::Deinitialize();
+}
+
+const FSBSurfaceResponse& USBSurfaceMaterialSubsystem::GetResponse(const FHitResult& Hit)
+{
+	if (const UPrimitiveComponent* Primitive = Hit.GetComponent())
+	{
+		const FObjectKey PrimitiveKey(Primitive);
+		if (const uint8* Surface = PrimitiveSurfaces.Find(PrimitiveKey))
+		{
+			return Responses[*Surface];
+		}
+
+		TArray<FSoftObjectPath> Keys;
+		USBSurfaceMaterialTable::GetSurfaceKeys(Primitive, Keys);
+		return Responses[PrimitiveSurfaces.Add(PrimitiveKey, FindSurface(Keys))];
+	}
+
+	return FieldSurfaces.IsValidIndex(Hit.Item) ? Responses[FieldSurfaces[Hit.Item]] : Responses[0];
+}
+
+bool USBSurfaceMaterialSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USBSurfaceMaterialSubsystem::BuildTable(const USBSurfaceMaterialTable& Table)
+{
+	Responses.Reset();
+	Responses.Add(Table.DefaultResponse);
+	SurfaceIndices.Reset();
+
+	for (const FSBSurfaceMaterial& Surface : Table.Surfaces)
+	{
+		if (Responses.Num() > MAX_uint8)
+		{
+			UE_LOG(LogSkateMovement, Warning, TEXT("Surface table has more than %d surfaces, %s and later are ignored"), MAX_uint8, *Surface.Name.ToString());
+			break;
+		}
+
+		const uint8 Index = static_cast<uint8>(Responses.Add(Surface.Response));
+		for (const TSoftObjectPtr<UPhysicalMaterial>& PhysicalMaterial : Surface.PhysicalMaterials)
+		{
+			SurfaceIndices.FindOrAdd(PhysicalMaterial.ToSoftObjectPath(), Index);
+		}
+		for (const TSoftObjectPtr<UMaterialInterface>& Material : Surface.Materials)
+		{
+			SurfaceIndices.FindOrAdd(Material.ToSoftObjectPath(), Index);
+		}
+	}
+}
+
+uint8 USBSurfaceMaterialSubsystem::FindSurface(const TArray<FSoftObjectPath>& Keys) const
+{
+	for (const FSoftObjectPath& Key : Keys)
+	{
+		if (const uint8* Index = SurfaceIndices.Find(Key))
+		{
+			return *Index;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,47 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SBSurfaceMaterialTable.h"
+#include "SBSurfaceMaterialSubsystem.generated.h"
+
+/**
+ * Resolves the ground under a skater to its skate response. The surface table is flattened once into an array of
+ * responses, a primitive is matched against it the first time it is stood on and remembered by index from then on.
+ * Surface field hits have no primitive, they carry the surface slot baked into the field instead.
+ */
+UCLASS(Config = Game)
+class SKATEBOARDING_API USBSurfaceMaterialSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Response of the surface of a ground hit, the default response for unknown surfaces */
+	const FSBSurfaceResponse& GetResponse(const FHitResult& Hit);
+
+	const FSBSurfaceResponse& GetDefaultResponse() const { return Responses[0]; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void BuildTable(const USBSurfaceMaterialTable& Table);
+	uint8 FindSurface(const TArray<FSoftObjectPath>& Keys) const;
+
+	/** Table asset, the class defaults of USBSurfaceMaterialTable are used when it isn't set */
+	UPROPERTY(Config)
+	TSoftObjectPtr<USBSurfaceMaterialTable> SurfaceTable;
+
+	/** Index 0 is the default response */
+	TArray<FSBSurfaceResponse> Responses = {FSBSurfaceResponse()};
+	TMap<FSoftObjectPath, uint8> SurfaceIndices;
+	TMap<FObjectKey, uint8> PrimitiveSurfaces;
+	/** Surface field slot to response index */
+	TArray<uint8> FieldSurfaces;
+};
@@ -0,0 +1,74 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "SBSurfaceMaterialTable.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Materials/MaterialInstance.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+
+namespace
+{
+	FSBSurfaceMaterial MakeSurface(const TCHAR* Name, std::initializer_list<const TCHAR*> MaterialPaths, float RollingFriction, float Grip, float SlopeResponse)
+	{
+		FSBSurfaceMaterial Surface;
+		Surface.Name = Name;
+		for (const TCHAR* MaterialPath : MaterialPaths)
+		{
+			Surface.Materials.Emplace(FSoftObjectPath(MaterialPath));
+		}
+		Surface.Response.RollingFriction = RollingFriction;
+		Surface.Response.Grip = Grip;
+		Surface.Response.SlopeResponse = SlopeResponse;
+		return Surface;
+	}
+}
+
+USBSurfaceMaterialTable::USBSurfaceMaterialTable()
+{
+	Surfaces.Add(MakeSurface(TEXT("Asphalt"), {TEXT("/Game/SkatePark/Materials/MI_Asphalt.MI_Asphalt")}, 1.3f, 1.f, 1.f));
+	Surfaces.Add(MakeSurface(TEXT("Concrete"), {TEXT("/Game/SkatePark/Materials/MI_Concrete.MI_Concrete")}, 1.f, 1.f, 1.f));
+	Surfaces.Add(MakeSurface(TEXT("Wood"), {TEXT("/Game/SkatePark/Materials/MI_BaseParkElementsWood.MI_BaseParkElementsWood"),
+	                                        TEXT("/Game/SkatePark/Materials/MI_FoamPitWood.MI_FoamPitWood")}, 0.8f, 0.9f, 1.f));
+	Surfaces.Add(MakeSurface(TEXT("Aluminum"), {TEXT("/Game/SkatePark/Materials/MI_Aluminum.MI_Aluminum")}, 0.6f, 0.7f, 1.1f));
+	Surfaces.Add(MakeSurface(TEXT("Foam"), {TEXT("/Game/SkatePark/Materials/MI_FoamPitNew.MI_FoamPitNew"),
+	                                        TEXT("/Game/SkatePark/Materials/MI_FoamPitOld.MI_FoamPitOld")}, 12.f, 0.3f, 0.2f));
+}
+
+void USBSurfaceMaterialTable::GetSurfaceKeys(const UPrimitiveComponent* Primitive, TArray<FSoftObjectPath>& OutKeys)
+{
+	OutKeys.Reset();
+	if (Primitive == nullptr)
+	{
+		return;
+	}
+
+	for (int32 MaterialIndex = 0; MaterialIndex < Primitive->GetNumMaterials(); ++MaterialIndex)
+	{
+		const UMaterialInterface* Material = Primitive->GetMaterial(MaterialIndex);
+		if (Material == nullptr)
+		{
+			continue;
+		}
+
+		for (const UMaterialInterface* Chain = Material; Chain != nullptr;)
+		{
+			OutKeys.AddUnique(FSoftObjectPath(Chain));
+			const UMaterialInstance* Instance = Cast<UMaterialInstance>(Chain);
+			Chain = Instance != nullptr ? Instance->Parent.Get() : nullptr;
+		}
+
+		if (const UPhysicalMaterial* PhysicalMaterial = Material->GetPhysicalMaterial())
+		{
+			OutKeys.AddUnique(FSoftObjectPath(PhysicalMaterial));
+		}
+	}
+
+	if (const FBodyInstance* BodyInstance = Primitive->GetBodyInstance())
+	{
+		if (const UPhysicalMaterial* PhysicalMaterial = BodyInstance->GetSimplePhysicalMaterial())
+		{
+			OutKeys.AddUnique(FSoftObjectPath(PhysicalMaterial));
+		}
+	}
+}
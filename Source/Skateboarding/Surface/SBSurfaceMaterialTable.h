@@ -0,0 +1,77 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SBSurfaceMaterialTable.generated.h"
+
+class UMaterialInterface;
+class UPhysicalMaterial;
+class UPrimitiveComponent;
+
+/** How a surface changes the skate physics, 1 keeps the tuning of the movement component */
+USTRUCT(BlueprintType)
+struct FSBSurfaceResponse
+{
+	GENERATED_BODY()
+
+	/** Scales the rolling friction, foam is far above 1 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	float RollingFriction = 1.f;
+
+	/** Scales the lean acceleration, slippery surfaces turn less */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	float Grip = 1.f;
+
+	/** Scales the acceleration down slopes */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	float SlopeResponse = 1.f;
+};
+
+/** A surface of the table and the physical materials and materials that resolve to it */
+USTRUCT(BlueprintType)
+struct FSBSurfaceMaterial
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	FName Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<TSoftObjectPtr<UPhysicalMaterial>> PhysicalMaterials;
+
+	/** Material instances also match the primitives using any instance of them */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<TSoftObjectPtr<UMaterialInterface>> Materials;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	FSBSurfaceResponse Response;
+};
+
+/**
+ * Skate response of the surfaces of the park. Defaults cover the skatepark materials, so the class default object
+ * is a usable table when the project doesn't configure an asset.
+ */
+UCLASS(BlueprintType)
+class SKATEBOARDING_API USBSurfaceMaterialTable : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	USBSurfaceMaterialTable();
+
+	/** Response of surfaces that match no entry, and of the air */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Surfaces")
+	FSBSurfaceResponse DefaultResponse;
+
+	/** At most 255 surfaces, the first entry matching a primitive wins */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Surfaces")
+	TArray<FSBSurfaceMaterial> Surfaces;
+
+	/**
+	 * Objects a primitive can be matched by, in priority order: each material with its parent chain and physical material,
+	 * then the physical material of the body. Shared by the runtime lookup and the surface field bake.
+	 */
+	static void GetSurfaceKeys(const UPrimitiveComponent* Primitive, TArray<FSoftObjectPath>& OutKeys);
+};
@@ -0,0 +1,142 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Grind/SBGrindRails.h"
+
+namespace SBGrindRailsTests
+{
+	constexpr int32 GridSize = 8;
+	constexpr double RailLength = 1000.;
+
+	FVector GetRailStart(int32 Rail)
+	{
+		return FVector(0.f, (Rail % GridSize) * 100.f, (Rail / GridSize) * 50.f);
+	}
+
+	/** Straight rails along X on a grid in YZ, enough segments to build a few levels of the hierarchy */
+	void MakeRailGrid(FSBGrindRails& OutRails)
+	{
+		for (int32 Rail = 0; Rail < GridSize * GridSize; ++Rail)
+		{
+			const FVector Start = GetRailStart(Rail);
+			const FVector Polyline[] = {Start, Start + FVector(RailLength, 0.f, 0.f)};
+			OutRails.AddRail(Polyline, 25.f);
+		}
+		OutRails.Build();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBGrindRailsLocationTest, "Skateboarding.Grind.RailLocation",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBGrindRailsLocationTest::RunTest(const FString& Parameters)
+{
+	FSBGrindRails Rails;
+
+	// L shaped rail, 100 units along X then 100 along Y
+	const FVector Polyline[] = {FVector::ZeroVector, FVector(100.f, 0.f, 0.f), FVector(100.f, 100.f, 0.f)};
+	Rails.AddRail(Polyline, 10.f);
+
+	const FVector Degenerate[] = {FVector::ZeroVector};
+	Rails.AddRail(Degenerate, 10.f);
+	Rails.Build();
+
+	if (TestEqual(TEXT("Single point polyline is no rail"), Rails.GetNumRails(), 1) == false)
+	{
+		return false;
+	}
+
+	const FSBGrindRail& Rail = Rails.GetRail(0);
+	TestNearlyEqual(TEXT("Rail length"), Rail.Length, 200.f, 1.e-3f);
+	TestEqual(TEXT("Rail points"), Rail.NumPoints, 21);
+
+	FVector Tangent;
+	TestTrue(TEXT("Location on the first leg"), Rails.GetLocation(0, 50.f, &Tangent).Equals(FVector(50.f, 0.f, 0.f), 1.e-3f));
+	TestTrue(TEXT("Tangent on the first leg"), Tangent.Equals(FVector::ForwardVector, 1.e-3f));
+	TestTrue(TEXT("Location on the second leg"), Rails.GetLocation(0, 150.f, &Tangent).Equals(FVector(100.f, 50.f, 0.f), 1.e-3f));
+	TestTrue(TEXT("Tangent on the second leg"), Tangent.Equals(FVector::RightVector, 1.e-3f));
+	TestTrue(TEXT("Location clamped to the start"), Rails.GetLocation(0, -20.f).Equals(FVector::ZeroVector, 1.e-3f));
+	TestTrue(TEXT("Location clamped to the end"), Rails.GetLocation(0, 500.f).Equals(FVector(100.f, 100.f, 0.f), 1.e-3f));
+
+	FSBGrindRailPoint Point;
+	TestFalse(TEXT("Rail out of the radius"), Rails.FindClosestPoint(FVector(50.f, -30.f, 0.f), 20.f, Point));
+	if (TestTrue(TEXT("Rail inside the radius"), Rails.FindClosestPoint(FVector(50.f, -30.f, 0.f), 40.f, Point)))
+	{
+		TestEqual(TEXT("Closest rail"), Point.Rail, 0);
+		TestNearlyEqual(TEXT("Closest arc length"), Point.Distance, 50.f, 1.e-3f);
+		TestTrue(TEXT("Closest location"), Point.Location.Equals(FVector(50.f, 0.f, 0.f), 1.e-3f));
+	}
+
+	FSBGrindRails Empty;
+	Empty.Build();
+	TestFalse(TEXT("No rails, no closest point"), Empty.FindClosestPoint(FVector::ZeroVector, 1000.f, Point));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBGrindRailsClosestPointTest, "Skateboarding.Grind.ClosestPointMatchesBruteForce",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBGrindRailsClosestPointTest::RunTest(const FString& Parameters)
+{
+	using namespace SBGrindRailsTests;
+
+	FSBGrindRails Rails;
+	MakeRailGrid(Rails);
+
+	constexpr float Radius = 120.f;
+	FRandomStream Random(1234);
+	int32 NumHits = 0;
+	for (int32 Query = 0; Query < 2000; ++Query)
+	{
+		const FVector Location(Random.FRandRange(-150.f, static_cast<float>(RailLength) + 150.f), Random.FRandRange(-150.f, GridSize * 100.f + 50.f),
+		                       Random.FRandRange(-150.f, GridSize * 50.f + 100.f));
+
+		// Closest point on every rail, straight rails along X
+		int32 BestRail = INDEX_NONE;
+		double BestDistance = TNumericLimits<double>::Max();
+		double SecondDistance = TNumericLimits<double>::Max();
+		for (int32 Rail = 0; Rail < Rails.GetNumRails(); ++Rail)
+		{
+			const FVector Start = GetRailStart(Rail);
+			const double Distance = FVector::Dist(Location, FVector(FMath::Clamp(Location.X, 0., RailLength), Start.Y, Start.Z));
+			if (Distance < BestDistance)
+			{
+				SecondDistance = BestDistance;
+				BestDistance = Distance;
+				BestRail = Rail;
+			}
+			else if (Distance < SecondDistance)
+			{
+				SecondDistance = Distance;
+			}
+		}
+
+		// Ties and queries right on the radius can go either way in floats
+		if (FMath::IsNearlyEqual(BestDistance, static_cast<double>(Radius), 0.1) || SecondDistance - BestDistance < 0.1)
+		{
+			continue;
+		}
+
+		FSBGrindRailPoint Point;
+		const bool bFound = Rails.FindClosestPoint(Location, Radius, Point);
+		if (TestTrue(*FString::Printf(TEXT("Query %d finds a rail"), Query), bFound == (BestDistance < Radius)) == false || bFound == false)
+		{
+			continue;
+		}
+
+		++NumHits;
+		const FVector Expected(FMath::Clamp(Location.X, 0., RailLength), GetRailStart(BestRail).Y, GetRailStart(BestRail).Z);
+		TestEqual(*FString::Printf(TEXT("Query %d rail"), Query), Point.Rail, BestRail);
+		TestNearlyEqual(*FString::Printf(TEXT("Query %d arc length"), Query), Point.Distance, static_cast<float>(Expected.X), 0.01f);
+		TestTrue(*FString::Printf(TEXT("Query %d location"), Query), Point.Location.Equals(Expected, 0.01f));
+	}
+
+	TestTrue(TEXT("Queries hit rails"), NumHits > 100);
+	return true;
+}
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Score/SBLeaderboardStore.h"
+
+namespace SBLeaderboardStoreTests
+{
+	FSBLeaderboardEntry MakeEntry(const TCHAR* Map, const TCHAR* PlayerName, int32 Score)
+	{
+		FSBLeaderboardEntry Entry;
+		Entry.Map = Map;
+		Entry.PlayerName = PlayerName;
+		Entry.Score = Score;
+		Entry.BestCombo = Score / 100;
+		Entry.RunTime = Score * 0.25f;
+		Entry.ReplayId = FString::Printf(TEXT("%s_%d"), PlayerName, Score);
+		Entry.Date = FDateTime(2024, 5, 1, 12, 0, 0);
+		return Entry;
+	}
+
+	bool IsSameEntry(const FSBLeaderboardEntry& A, const FSBLeaderboardEntry& B)
+	{
+		return A.Map == B.Map && A.PlayerName == B.PlayerName && A.Score == B.Score && A.BestCombo == B.BestCombo && A.RunTime == B.RunTime
+			&& A.ReplayId == B.ReplayId && A.Date == B.Date;
+	}
+
+	FString GetTestFilename(const TCHAR* Name)
+	{
+		return FPaths::AutomationTransientDir() / Name;
+	}
+
+	void DeleteLog(const FString& Filename)
+	{
+		IFileManager::Get().Delete(*Filename, false, false, true);
+		IFileManager::Get().Delete(*(Filename + TEXT(".bak")), false, false, true);
+	}
+
+	/** Opens the log, appends Entries and closes it, OutIndex is what the log held when it was opened */
+	bool RunSession(const FString& Filename, TConstArrayView<FSBLeaderboardEntry> Entries, FSBLeaderboardIndex& OutIndex,
+	                int32 MaxEntriesPerMap = 10, int32 CompactionThreshold = 256)
+	{
+		FSBLeaderboardStore Store;
+		if (Store.Open(Filename, MaxEntriesPerMap, CompactionThreshold) == false)
+		{
+			return false;
+		}
+
+		for (const FSBLeaderboardEntry& Entry : Entries)
+		{
+			Store.Append(Entry);
+		}
+		Store.Close();
+		return Store.DequeueLoadedIndex(OutIndex);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBLeaderboardIndexTest, "Skateboarding.Leaderboard.IndexRanks",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBLeaderboardIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace SBLeaderboardStoreTests;
+
+	FSBLeaderboardIndex Index(3);
+	TestTrue(TEXT("First entry"), Index.Add(MakeEntry(TEXT("Park"), TEXT("A"), 100)));
+	TestTrue(TEXT("Better entry"), Index.Add(MakeEntry(TEXT("Park"), TEXT("B"), 300)));
+	TestTrue(TEXT("Middle entry"), Index.Add(MakeEntry(TEXT("Park"), TEXT("C"), 200)));
+	TestTrue(TEXT("Tied entry"), Index.Add(MakeEntry(TEXT("Park"), TEXT("D"), 300)));
+	TestFalse(TEXT("Entry below the full leaderboard"), Index.Add(MakeEntry(TEXT("Park"), TEXT("E"), 50)));
+	TestTrue(TEXT("Entry on another map"), Index.Add(MakeEntry(TEXT("Bowl"), TEXT("F"), 10)));
+
+	const TConstArrayView<FSBLeaderboardEntry> Entries = Index.GetEntries(TEXT("Park"));
+	if (TestEqual(TEXT("Entries are capped"), Entries.Num(), 3))
+	{
+		TestEqual(TEXT("Best entry"), Entries[0].PlayerName, FString(TEXT("B")));
+		TestEqual(TEXT("Earlier entry wins a tie"), Entries[1].PlayerName, FString(TEXT("D")));
+		TestEqual(TEXT("Last entry"), Entries[2].PlayerName, FString(TEXT("C")));
+	}
+
+	TestEqual(TEXT("Entries of every map"), Index.Num(), 4);
+	TestEqual(TEXT("Rank of a new best score"), Index.GetRank(TEXT("Park"), 400), 1);
+	TestEqual(TEXT("Rank of a tied score"), Index.GetRank(TEXT("Park"), 300), 3);
+	TestEqual(TEXT("Rank below the full leaderboard"), Index.GetRank(TEXT("Park"), 150), static_cast<int32>(INDEX_NONE));
+	TestEqual(TEXT("Rank on an empty map"), Index.GetRank(TEXT("Street"), 1), 1);
+	TestEqual(TEXT("No entries on an empty map"), Index.GetEntries(TEXT("Street")).Num(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBLeaderboardLogTest, "Skateboarding.Leaderboard.LogRoundTrip",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBLeaderboardLogTest::RunTest(const FString& Parameters)
+{
+	using namespace SBLeaderboardStoreTests;
+
+	const FString Filename = GetTestFilename(TEXT("RoundTrip.sblog"));
+	DeleteLog(Filename);
+
+	const FSBLeaderboardEntry Entries[] = {MakeEntry(TEXT("Park"), TEXT("A"), 100), MakeEntry(TEXT("Park"), TEXT("B"), 300), MakeEntry(TEXT("Bowl"), TEXT("C"), 200)};
+
+	FSBLeaderboardIndex Index;
+	if (TestTrue(TEXT("New log opened"), RunSession(Filename, Entries, Index)))
+	{
+		TestEqual(TEXT("New log is empty"), Index.Num(), 0);
+	}
+
+	if (TestTrue(TEXT("Log reopened"), RunSession(Filename, {}, Index)) && TestEqual(TEXT("Entries read back"), Index.Num(), 3))
+	{
+		TestTrue(TEXT("Best entry read back"), IsSameEntry(Index.GetEntries(TEXT("Park"))[0], Entries[1]));
+		TestTrue(TEXT("Second entry read back"), IsSameEntry(Index.GetEntries(TEXT("Park"))[1], Entries[0]));
+		TestTrue(TEXT("Other map read back"), IsSameEntry(Index.GetEntries(TEXT("Bowl"))[0], Entries[2]));
+	}
+
+	// Smaller leaderboard that compacts once more than one record fell off it
+	const FSBLeaderboardEntry MoreEntries[] = {MakeEntry(TEXT("Park"), TEXT("D"), 400), MakeEntry(TEXT("Park"), TEXT("E"), 50), MakeEntry(TEXT("Park"), TEXT("F"), 500)};
+	if (TestTrue(TEXT("Log appended and compacted"), RunSession(Filename, MoreEntries, Index, 2, 1)))
+	{
+		TestEqual(TEXT("Reopened with a smaller leaderboard"), Index.GetEntries(TEXT("Park")).Num(), 2);
+	}
+
+	if (TestTrue(TEXT("Compacted log reopened"), RunSession(Filename, {}, Index, 2, 1)))
+	{
+		const TConstArrayView<FSBLeaderboardEntry> ParkEntries = Index.GetEntries(TEXT("Park"));
+		if (TestEqual(TEXT("Compacted entries"), ParkEntries.Num(), 2))
+		{
+			TestEqual(TEXT("Compacted best entry"), ParkEntries[0].Score, 500);
+			TestEqual(TEXT("Compacted second entry"), ParkEntries[1].Score, 400);
+		}
+	}
+
+	DeleteLog(Filename);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBLeaderboardRecoveryTest, "Skateboarding.Leaderboard.LogRecovery",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::SuppressLogWarnings)
+
+bool FSBLeaderboardRecoveryTest::RunTest(const FString& Parameters)
+{
+	using namespace SBLeaderboardStoreTests;
+
+	const FString Filename = GetTestFilename(TEXT("Recovery.sblog"));
+	DeleteLog(Filename);
+
+	const FSBLeaderboardEntry Entries[] = {MakeEntry(TEXT("Park"), TEXT("A"), 100), MakeEntry(TEXT("Park"), TEXT("B"), 200), MakeEntry(TEXT("Park"), TEXT("C"), 300)};
+	FSBLeaderboardIndex Index;
+	if (TestTrue(TEXT("Log written"), RunSession(Filename, Entries, Index)) == false)
+	{
+		return false;
+	}
+
+	// Crash in the middle of the last record
+	TArray<uint8> Data;
+	FFileHelper::LoadFileToArray(Data, *Filename);
+	Data.SetNum(Data.Num() - 5);
+	FFileHelper::SaveArrayToFile(Data, *Filename);
+
+	const FSBLeaderboardEntry NewEntry = MakeEntry(TEXT("Park"), TEXT("D"), 400);
+	if (TestTrue(TEXT("Broken log opened"), RunSession(Filename, MakeArrayView(&NewEntry, 1), Index)))
+	{
+		TestEqual(TEXT("Records before the broken one"), Index.Num(), 2);
+	}
+	if (TestTrue(TEXT("Repaired log opened"), RunSession(Filename, {}, Index)))
+	{
+		TestEqual(TEXT("Records appended after the repair are readable"), Index.Num(), 3);
+		TestFalse(TEXT("Broken tail is no backup"), IFileManager::Get().FileExists(*(Filename + TEXT(".bak"))));
+	}
+
+	// Another version or another file altogether is kept aside, not rewritten
+	const FString Foreign = TEXT("Not a leaderboard log");
+	FFileHelper::SaveStringToFile(Foreign, *Filename);
+	if (TestTrue(TEXT("Foreign file opened"), RunSession(Filename, MakeArrayView(&NewEntry, 1), Index)))
+	{
+		TestEqual(TEXT("Nothing read from the foreign file"), Index.Num(), 0);
+
+		FString Backup;
+		TestTrue(TEXT("Foreign file moved aside"), FFileHelper::LoadFileToString(Backup, *(Filename + TEXT(".bak"))) && Backup == Foreign);
+	}
+	if (TestTrue(TEXT("New log opened"), RunSession(Filename, {}, Index)) && TestEqual(TEXT("New log holds the new entry"), Index.Num(), 1))
+	{
+		TestTrue(TEXT("New entry read back"), IsSameEntry(Index.GetEntries(TEXT("Park"))[0], NewEntry));
+	}
+
+	DeleteLog(Filename);
+	return true;
+}
+
+#endif
@@ -0,0 +1,220 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Commandlets/SBSkateSimulationWorld.h"
+#include "Skateboarding/SBCharacter.h"
+#include "Skateboarding/SBCharacterMovementComponent.h"
+
+namespace SBSkateMovementTests
+{
+	/** Step and frame times are powers of two, every frame rate splits the run into exactly the same steps */
+	constexpr float FixedStep = 1.f / 128.f;
+	constexpr float RunTime = 4.f;
+
+	struct FSkaterEndState
+	{
+		FTransform Transform;
+		float Distance = 0.f;
+		FVector Velocity = FVector::ZeroVector;
+	};
+
+	/** Pushes, carves right then left, and rolls down the slope, input changes land on frame boundaries of every tested rate */
+	bool RunSkater(float FrameTime, FSkaterEndState& OutState)
+	{
+		FSBSkateSimulationWorld SimulationWorld(ESBSkateScenario::Slope);
+		SimulationWorld.Populate(1, FVector(300.f, 0.f, 0.f));
+		if (SimulationWorld.GetSkaters().Num() != 1)
+		{
+			return false;
+		}
+
+		ASBCharacter* Skater = SimulationWorld.GetSkaters()[0];
+		USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+
+		// Fixed step is an editor setting, the default 1/120 can't be summed exactly in floats
+		FFloatProperty* FixedStepProperty = FindFProperty<FFloatProperty>(USBCharacterMovementComponent::StaticClass(), TEXT("FixedSkateStep"));
+		if (FixedStepProperty == nullptr)
+		{
+			return false;
+		}
+		FixedStepProperty->SetPropertyValue_InContainer(MovementComponent, FixedStep);
+
+		const FVector StartLocation = Skater->GetActorLocation();
+
+		const int32 Frames = FMath::RoundToInt32(RunTime / FrameTime);
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			const float Time = Frame * FrameTime;
+			MovementComponent->SetWantsToPush(Time < 0.5f);
+			MovementComponent->SetLeanInput(Time >= 1.f && Time < 2.f ? 1.f : Time >= 2.f && Time < 3.f ? -1.f : 0.f);
+			SimulationWorld.Tick(FrameTime);
+		}
+
+		OutState.Transform = Skater->GetActorTransform();
+		OutState.Distance = FVector::Dist(StartLocation, OutState.Transform.GetLocation());
+		OutState.Velocity = MovementComponent->Velocity;
+		return true;
+	}
+
+	bool IsSameSkateState(const FSavedMove_Skate& A, const FSavedMove_Skate& B)
+	{
+		return A.SavedPushCooldownRemaining == B.SavedPushCooldownRemaining && A.SavedSkateStepAccumulator == B.SavedSkateStepAccumulator
+			&& A.SavedAirSpinYaw == B.SavedAirSpinYaw && A.SavedGrindState.Rail == B.SavedGrindState.Rail
+			&& A.SavedGrindState.Distance == B.SavedGrindState.Distance && A.SavedGrindState.Speed == B.SavedGrindState.Speed
+			&& A.SavedGrindState.Cooldown == B.SavedGrindState.Cooldown && A.bSavedIsGrounded == B.bSavedIsGrounded;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateFixedStepTrajectoryTest, "Skateboarding.Movement.FixedStepTrajectory",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateFixedStepTrajectoryTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateMovementTests;
+
+	FSkaterEndState Reference;
+	if (TestTrue(TEXT("Skater runs at 128 fps"), RunSkater(1.f / 128.f, Reference)) == false)
+	{
+		return false;
+	}
+
+	TestTrue(TEXT("Skater moved"), Reference.Distance > 1000.f);
+
+	for (const float FrameTime : {1.f / 64.f, 1.f / 32.f})
+	{
+		FSkaterEndState State;
+		const FString Rate = FString::Printf(TEXT("%.0f fps"), 1.f / FrameTime);
+		if (TestTrue(FString::Printf(TEXT("Skater runs at %s"), *Rate), RunSkater(FrameTime, State)) == false)
+		{
+			continue;
+		}
+
+		TestTrue(FString::Printf(TEXT("Location at %s"), *Rate), State.Transform.GetLocation().Equals(Reference.Transform.GetLocation(), 0.1f));
+		TestTrue(FString::Printf(TEXT("Rotation at %s"), *Rate), State.Transform.GetRotation().Equals(Reference.Transform.GetRotation(), 1.e-3f));
+		TestTrue(FString::Printf(TEXT("Velocity at %s"), *Rate), State.Velocity.Equals(Reference.Velocity, 0.1f));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateCombinedMoveTest, "Skateboarding.Movement.CombinedMoveRestoresSkateState",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateCombinedMoveTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateMovementTests;
+
+	FSBSkateSimulationWorld SimulationWorld(ESBSkateScenario::Flat);
+	SimulationWorld.Populate(1, FVector(600.f, 0.f, 0.f));
+	if (TestEqual(TEXT("Skater spawned"), SimulationWorld.GetSkaters().Num(), 1) == false)
+	{
+		return false;
+	}
+
+	ASBCharacter* Skater = SimulationWorld.GetSkaters()[0];
+	USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+	FNetworkPredictionData_Client_Character& ClientData = *MovementComponent->GetPredictionData_Client_Character();
+	constexpr float FrameTime = 1.f / 60.f;
+
+	for (int32 Frame = 0; Frame < 10; ++Frame)
+	{
+		SimulationWorld.Tick(FrameTime);
+	}
+
+	// Old move starts from a state that differs in every saved field from the one the new move starts from
+	FSavedMove_Skate OldMove;
+	OldMove.SetMoveFor(Skater, FrameTime, FVector::ZeroVector, ClientData);
+	OldMove.SavedPushCooldownRemaining = 0.75f;
+	OldMove.SavedSkateStepAccumulator = 0.004f;
+	OldMove.SavedAirSpinYaw = 90.f;
+	OldMove.SavedGrindState.Cooldown = 0.2f;
+	OldMove.bSavedIsGrounded = false;
+	OldMove.PrepMoveFor(Skater);
+
+	// Skate steps advance the skate clock the combined move has to rewind
+	for (int32 Frame = 0; Frame < 10; ++Frame)
+	{
+		SimulationWorld.Tick(FrameTime);
+	}
+
+	FSavedMove_Skate NewMove;
+	NewMove.SetMoveFor(Skater, FrameTime, FVector::ZeroVector, ClientData);
+	NewMove.SavedPushCooldownRemaining = 0.25f;
+	NewMove.SavedSkateStepAccumulator = 0.002f;
+	NewMove.SavedAirSpinYaw = -45.f;
+	NewMove.SavedGrindState.Cooldown = 0.1f;
+	NewMove.bSavedIsGrounded = true;
+	NewMove.PrepMoveFor(Skater);
+	TestTrue(TEXT("Skate clock advanced between the moves"), NewMove.SavedSkateClock > OldMove.SavedSkateClock);
+
+	NewMove.CombineWith(&OldMove, Skater, nullptr, OldMove.GetRevertedLocation());
+	TestTrue(TEXT("Combined move saved the old start state"), IsSameSkateState(NewMove, OldMove));
+	TestEqual(TEXT("Combined move saved the old skate clock"), NewMove.SavedSkateClock, OldMove.SavedSkateClock);
+	TestEqual(TEXT("Combined move runs both moves"), NewMove.DeltaTime, FrameTime * 2.f);
+
+	FSavedMove_Skate CombinedState;
+	CombinedState.SetMoveFor(Skater, FrameTime, FVector::ZeroVector, ClientData);
+	TestTrue(TEXT("Combining restored the old start state"), IsSameSkateState(CombinedState, OldMove));
+	TestEqual(TEXT("Combining restored the old skate clock"), CombinedState.SavedSkateClock, OldMove.SavedSkateClock);
+
+	// Replaying the combined move starts from the old state again, whatever the skater did since
+	for (int32 Frame = 0; Frame < 10; ++Frame)
+	{
+		SimulationWorld.Tick(FrameTime);
+	}
+	NewMove.PrepMoveFor(Skater);
+
+	FSavedMove_Skate ReplayState;
+	ReplayState.SetMoveFor(Skater, FrameTime, FVector::ZeroVector, ClientData);
+	TestTrue(TEXT("Replay restored the old start state"), IsSameSkateState(ReplayState, OldMove));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateOllieTest, "Skateboarding.Movement.OllieLeavesGround",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateOllieTest::RunTest(const FString& Parameters)
+{
+	FSBSkateSimulationWorld SimulationWorld(ESBSkateScenario::Flat);
+	SimulationWorld.Populate(1, FVector(300.f, 0.f, 0.f));
+	if (TestEqual(TEXT("Skater spawned"), SimulationWorld.GetSkaters().Num(), 1) == false)
+	{
+		return false;
+	}
+
+	ASBCharacter* Skater = SimulationWorld.GetSkaters()[0];
+	USBCharacterMovementComponent* MovementComponent = Skater->GetSkateMovementComponent();
+	constexpr float FrameTime = 1.f / 60.f;
+
+	for (int32 Frame = 0; Frame < 30; ++Frame)
+	{
+		SimulationWorld.Tick(FrameTime);
+	}
+	if (TestTrue(TEXT("Skater rolls on the ground"), MovementComponent->GetIsGrounded()) == false)
+	{
+		return false;
+	}
+
+	const double GroundZ = Skater->GetActorLocation().Z;
+	Skater->Jump();
+
+	bool bLeftGround = false;
+	double MaxHeight = 0.0;
+	for (int32 Frame = 0; Frame < 90; ++Frame)
+	{
+		SimulationWorld.Tick(FrameTime);
+		bLeftGround |= MovementComponent->GetIsGrounded() == false;
+		MaxHeight = FMath::Max(MaxHeight, Skater->GetActorLocation().Z - GroundZ);
+	}
+
+	TestTrue(TEXT("Ollie left the ground"), bLeftGround);
+	TestTrue(TEXT("Ollie lifted the skater"), MaxHeight > 50.0);
+	TestTrue(TEXT("Skater landed"), MovementComponent->GetIsGrounded());
+	TestFalse(TEXT("Jump was consumed by the move"), Skater->bPressedJump);
+	return true;
+}
+
+#endif
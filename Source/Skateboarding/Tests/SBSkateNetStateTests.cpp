@@ -0,0 +1,194 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Replication/SBSkateNetState.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+namespace SBSkateNetStateTests
+{
+	/** Server side of one connection, the last state it sent and the last one the client acknowledged */
+	struct FSkateConnection
+	{
+		TSharedPtr<INetDeltaBaseState> SentState;
+		TSharedPtr<INetDeltaBaseState> AckedState;
+	};
+
+	/** Values on the grid of the quantization, so the client has to read back exactly what the server set */
+	void SetState(FSBSkateNetState& State, int32 Step)
+	{
+		State.Location = FVector(1200.5f + Step * 12.f, -340.f - Step * 0.5f, 88.5f);
+		State.Velocity = FVector(600.f, -25.f + Step, Step % 2 == 0 ? 0.f : -120.f);
+		State.Rotation = FRotator(0.f, Step % 2 == 0 ? 90.f : -45.f, 0.f);
+		State.Lean = Step % 3 - 1.f;
+		State.FrictionMultiplier = 0.5f;
+		State.bPushing = Step % 2 == 0;
+		State.bBraking = false;
+		State.bGrounded = true;
+		State.Quantize(0);
+	}
+
+	/** Serializes the server state against Base, returns false if nothing was sent */
+	bool Send(FSBSkateNetState& Server, FSkateConnection& Connection, INetDeltaBaseState* Base, FBitWriter& Writer)
+	{
+		FNetDeltaSerializeInfo DeltaParms;
+		DeltaParms.Writer = &Writer;
+		DeltaParms.OldState = Base;
+		DeltaParms.NewState = &Connection.SentState;
+		return Server.NetDeltaSerialize(DeltaParms);
+	}
+
+	/** Reads the update on the client, returns true if the client took it */
+	bool Receive(FSBSkateNetState& Client, FBitWriter& Writer)
+	{
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		FNetDeltaSerializeInfo DeltaParms;
+		DeltaParms.Reader = &Reader;
+		return Client.NetDeltaSerialize(DeltaParms) && Reader.IsError() == false && Reader.AtEnd() && Client.ConsumeReceivedUpdate();
+	}
+
+	/** Sends the server state against the acknowledged one and delivers it, the client acknowledges what it received */
+	bool Deliver(FSBSkateNetState& Server, FSBSkateNetState& Client, FSkateConnection& Connection)
+	{
+		FBitWriter Writer(0, true);
+		if (Send(Server, Connection, Connection.AckedState.Get(), Writer) == false || Receive(Client, Writer) == false)
+		{
+			return false;
+		}
+		Connection.AckedState = Connection.SentState;
+		return true;
+	}
+
+	bool IsSameState(const FSBSkateNetState& A, const FSBSkateNetState& B)
+	{
+		return A.Location == B.Location && A.Velocity == B.Velocity && A.Rotation.Equals(B.Rotation, 1.e-2f) && A.Lean == B.Lean
+			&& A.FrictionMultiplier == B.FrictionMultiplier && A.bPushing == B.bPushing && A.bBraking == B.bBraking && A.bGrounded == B.bGrounded;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateNetStateRoundTripTest, "Skateboarding.Net.SkateStateRoundTrip",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateNetStateRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateNetStateTests;
+
+	FSBSkateNetState Server;
+	FSBSkateNetState Client;
+	FSkateConnection Connection;
+
+	// Full state, nothing acknowledged yet
+	SetState(Server, 0);
+	FBitWriter FullWriter(0, true);
+	if (TestTrue(TEXT("Full state sent"), Send(Server, Connection, nullptr, FullWriter)) == false)
+	{
+		return false;
+	}
+	TestTrue(TEXT("Full state received"), Receive(Client, FullWriter));
+	TestTrue(TEXT("Full state read back"), IsSameState(Client, Server));
+	Connection.AckedState = Connection.SentState;
+
+	// Delta against the acknowledged state
+	SetState(Server, 1);
+	FBitWriter DeltaWriter(0, true);
+	if (TestTrue(TEXT("Delta sent"), Send(Server, Connection, Connection.AckedState.Get(), DeltaWriter)))
+	{
+		TestTrue(TEXT("Delta smaller than the full state"), DeltaWriter.GetNumBits() < FullWriter.GetNumBits());
+		TestTrue(TEXT("Delta received"), Receive(Client, DeltaWriter));
+		TestTrue(TEXT("Delta read back"), IsSameState(Client, Server));
+		Connection.AckedState = Connection.SentState;
+	}
+
+	// Nothing changed since the acknowledged state
+	SetState(Server, 1);
+	FBitWriter UnchangedWriter(0, true);
+	TestFalse(TEXT("Unchanged state not sent"), Send(Server, Connection, Connection.AckedState.Get(), UnchangedWriter));
+	TestEqual(TEXT("Unchanged state takes no bits"), UnchangedWriter.GetNumBits(), 0ll);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateNetStateMissingBaseTest, "Skateboarding.Net.SkateStateMissingBase",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateNetStateMissingBaseTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateNetStateTests;
+
+	FSBSkateNetState Server;
+	FSBSkateNetState Client;
+	FSkateConnection Connection;
+
+	SetState(Server, 0);
+	if (TestTrue(TEXT("First state delivered"), Deliver(Server, Client, Connection)) == false)
+	{
+		return false;
+	}
+	const FSBSkateNetState Delivered = Client;
+
+	// The next state is lost in flight, the server sends the one after against it before it learns about the loss
+	SetState(Server, 1);
+	FBitWriter LostWriter(0, true);
+	Send(Server, Connection, Connection.AckedState.Get(), LostWriter);
+	const TSharedPtr<INetDeltaBaseState> LostState = Connection.SentState;
+
+	const int64 DroppedBefore = FSBSkateNetState::GetStats().DroppedUpdates;
+	SetState(Server, 2);
+	FBitWriter MissingBaseWriter(0, true);
+	Send(Server, Connection, LostState.Get(), MissingBaseWriter);
+	TestFalse(TEXT("Delta against a missing base skipped"), Receive(Client, MissingBaseWriter));
+	TestEqual(TEXT("Skipped delta counted"), FSBSkateNetState::GetStats().DroppedUpdates, DroppedBefore + 1);
+	TestTrue(TEXT("Client kept its last state"), IsSameState(Client, Delivered));
+
+	// Falling back to the acknowledged base recovers
+	TestTrue(TEXT("Delta against the acknowledged base delivered"), Deliver(Server, Client, Connection));
+	TestTrue(TEXT("Client caught up"), IsSameState(Client, Server));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateNetStateStaleBaseTest, "Skateboarding.Net.SkateStateStaleBase",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateNetStateStaleBaseTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateNetStateTests;
+
+	FSBSkateNetState Server;
+	FSBSkateNetState Client;
+	FSkateConnection Connection;
+
+	SetState(Server, 0);
+	if (TestTrue(TEXT("First state delivered"), Deliver(Server, Client, Connection)) == false)
+	{
+		return false;
+	}
+	const TSharedPtr<INetDeltaBaseState> StaleState = Connection.AckedState;
+
+	// A full history of newer states reuses the slot of the first one
+	for (int32 Step = 1; Step <= SBSkateNetState::HistorySize; ++Step)
+	{
+		SetState(Server, Step);
+		if (TestTrue(*FString::Printf(TEXT("State %d delivered"), Step), Deliver(Server, Client, Connection)) == false)
+		{
+			return false;
+		}
+	}
+	const FSBSkateNetState Delivered = Client;
+
+	const int64 DroppedBefore = FSBSkateNetState::GetStats().DroppedUpdates;
+	SetState(Server, SBSkateNetState::HistorySize + 1);
+	FBitWriter StaleWriter(0, true);
+	Send(Server, Connection, StaleState.Get(), StaleWriter);
+	TestFalse(TEXT("Delta against an overwritten base skipped"), Receive(Client, StaleWriter));
+	TestEqual(TEXT("Skipped delta counted"), FSBSkateNetState::GetStats().DroppedUpdates, DroppedBefore + 1);
+	TestTrue(TEXT("Client kept its last state"), IsSameState(Client, Delivered));
+
+	TestTrue(TEXT("Delta against the acknowledged base delivered"), Deliver(Server, Client, Connection));
+	TestTrue(TEXT("Client caught up"), IsSameState(Client, Server));
+	return true;
+}
+
+#endif
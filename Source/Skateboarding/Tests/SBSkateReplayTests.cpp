@@ -0,0 +1,190 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Replay/SBSkateReplay.h"
+
+namespace SBSkateReplayTests
+{
+	/** Power of two, so the time of a frame divides back to its exact index */
+	constexpr float SampleInterval = 1.f / 32.f;
+	constexpr int32 NumFrames = 250;
+
+	/** Frames on the quantization grid of the codec, so decoding has to give them back unchanged */
+	TArray<FSBSkateReplayFrame> MakeFrames()
+	{
+		constexpr float AngleStep = 360.f / 65536.f;
+
+		TArray<FSBSkateReplayFrame> Frames;
+		FRandomStream Random(4321);
+		FVector Location(1000.f, -2000.f, 150.f);
+		int32 Yaw = 65000;
+		for (int32 Index = 0; Index < NumFrames; ++Index)
+		{
+			// Mostly smooth motion with a few teleports, so residuals take one byte and several bytes
+			const bool bTeleport = Index % 97 == 50;
+			Location += FVector(Random.RandRange(-40, 40), Random.RandRange(-40, 40), Random.RandRange(-8, 8)) * (bTeleport ? 1000.f : 0.25f);
+			// Yaw wraps around 360 several times
+			Yaw = (Yaw + Random.RandRange(0, 600)) & 0xFFFF;
+
+			FSBSkateReplayFrame& Frame = Frames.AddDefaulted_GetRef();
+			Frame.Location = Location;
+			Frame.Rotation = FRotator(Random.RandRange(0, 2000) * AngleStep, Yaw * AngleStep, Random.RandRange(64000, 65535) * AngleStep);
+			Frame.Velocity = FVector(Random.RandRange(-1500, 1500), Random.RandRange(-1500, 1500), Random.RandRange(-2000, 800));
+			Frame.LeanDirection = static_cast<int8>(Random.RandRange(-1, 1));
+			Frame.bWantsToPush = Random.RandRange(0, 3) == 0;
+			Frame.bWantsToBrake = Random.RandRange(0, 5) == 0;
+			Frame.bGrounded = Index % 40 < 30;
+		}
+		return Frames;
+	}
+
+	/** Rotations come back through the quaternion blend of FSBSkateReplayReader::Sample, everything else is copied */
+	bool IsSameFrame(const FSBSkateReplayFrame& A, const FSBSkateReplayFrame& B)
+	{
+		return A.Location == B.Location && A.Rotation.Equals(B.Rotation, 1.e-3f) && A.Velocity == B.Velocity && A.LeanDirection == B.LeanDirection
+			&& A.bWantsToPush == B.bWantsToPush && A.bWantsToBrake == B.bWantsToBrake && A.bGrounded == B.bGrounded;
+	}
+
+	bool WriteReplay(const FString& Filename, TConstArrayView<FSBSkateReplayFrame> Frames)
+	{
+		FSBSkateReplayWriter Writer;
+		if (Writer.Open(Filename, SampleInterval) == false)
+		{
+			return false;
+		}
+
+		for (const FSBSkateReplayFrame& Frame : Frames)
+		{
+			Writer.AddFrame(Frame);
+		}
+		Writer.Close();
+		return true;
+	}
+
+	FString GetTestFilename(const TCHAR* Name)
+	{
+		return FPaths::AutomationTransientDir() / Name;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateReplayRoundTripTest, "Skateboarding.Replay.RoundTrip",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateReplayRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateReplayTests;
+
+	const FString Filename = GetTestFilename(TEXT("RoundTrip.sbreplay"));
+	const TArray<FSBSkateReplayFrame> Frames = MakeFrames();
+	if (TestTrue(TEXT("Replay written"), WriteReplay(Filename, Frames)) == false)
+	{
+		return false;
+	}
+
+	FSBSkateReplayReader Reader;
+	if (TestTrue(TEXT("Replay opened"), Reader.Open(Filename)) && TestEqual(TEXT("Frames read back"), Reader.GetNumFrames(), NumFrames))
+	{
+		TestNearlyEqual(TEXT("Duration"), Reader.GetDuration(), (NumFrames - 1) * SampleInterval, 1.e-4f);
+		for (int32 Index = 0; Index < NumFrames; ++Index)
+		{
+			FSBSkateReplayFrame Frame;
+			TestTrue(*FString::Printf(TEXT("Frame %d decoded"), Index), Reader.Sample(Index * SampleInterval, Frame) && IsSameFrame(Frame, Frames[Index]));
+		}
+	}
+
+	IFileManager::Get().Delete(*Filename, false, false, true);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateReplaySeekTest, "Skateboarding.Replay.Seek",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateReplaySeekTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateReplayTests;
+
+	const FString Filename = GetTestFilename(TEXT("Seek.sbreplay"));
+	const TArray<FSBSkateReplayFrame> Frames = MakeFrames();
+	FSBSkateReplayReader Reader;
+	if (TestTrue(TEXT("Replay written"), WriteReplay(Filename, Frames)) == false || TestTrue(TEXT("Replay opened"), Reader.Open(Filename)) == false)
+	{
+		return false;
+	}
+
+	// Jumps back and forth across blocks, every jump decodes its block from the index alone
+	FRandomStream Random(99);
+	for (int32 Seek = 0; Seek < 100; ++Seek)
+	{
+		const int32 Index = Seek == 0 ? NumFrames - 1 : Random.RandRange(0, NumFrames - 1);
+		FSBSkateReplayFrame Frame;
+		TestTrue(*FString::Printf(TEXT("Seek %d to frame %d"), Seek, Index), Reader.Sample(Index * SampleInterval, Frame) && IsSameFrame(Frame, Frames[Index]));
+	}
+
+	// Halfway between two frames of different blocks
+	const int32 FramesPerBlock = FSBSkateReplayHeader().FramesPerBlock;
+	FSBSkateReplayFrame Frame;
+	if (TestTrue(TEXT("Seek between blocks"), Reader.Sample((FramesPerBlock - 0.5f) * SampleInterval, Frame)))
+	{
+		const FVector Expected = (Frames[FramesPerBlock - 1].Location + Frames[FramesPerBlock].Location) * 0.5;
+		TestTrue(TEXT("Location blended across blocks"), Frame.Location.Equals(Expected, 1.e-3f));
+	}
+
+	TestTrue(TEXT("Seek before the start"), Reader.Sample(-1.f, Frame) && IsSameFrame(Frame, Frames[0]));
+	TestTrue(TEXT("Seek past the end"), Reader.Sample(1000.f, Frame) && IsSameFrame(Frame, Frames.Last()));
+
+	IFileManager::Get().Delete(*Filename, false, false, true);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSkateReplayTruncatedTest, "Skateboarding.Replay.TruncatedRecovery",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSkateReplayTruncatedTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSkateReplayTests;
+
+	const FString Filename = GetTestFilename(TEXT("Truncated.sbreplay"));
+	const TArray<FSBSkateReplayFrame> Frames = MakeFrames();
+	if (TestTrue(TEXT("Replay written"), WriteReplay(Filename, Frames)) == false)
+	{
+		return false;
+	}
+
+	TArray<uint8> Data;
+	FFileHelper::LoadFileToArray(Data, *Filename);
+
+	// Crash in the middle of a block, the footer and the index were never written
+	const int32 FramesPerBlock = FSBSkateReplayHeader().FramesPerBlock;
+	TArray<uint8> Truncated(Data.GetData(), Data.Num() * 3 / 5);
+	FFileHelper::SaveArrayToFile(Truncated, *Filename);
+
+	FSBSkateReplayReader Reader;
+	if (TestTrue(TEXT("Truncated replay opened"), Reader.Open(Filename)))
+	{
+		const int32 Recovered = Reader.GetNumFrames();
+		TestTrue(TEXT("Whole blocks before the cut recovered"), Recovered >= FramesPerBlock && Recovered < NumFrames && Recovered % FramesPerBlock == 0);
+		for (int32 Index = 0; Index < Recovered; ++Index)
+		{
+			FSBSkateReplayFrame Frame;
+			TestTrue(*FString::Printf(TEXT("Recovered frame %d"), Index), Reader.Sample(Index * SampleInterval, Frame) && IsSameFrame(Frame, Frames[Index]));
+		}
+	}
+
+	// Crash before the first block was written
+	Truncated.SetNum(static_cast<int32>(sizeof(FSBSkateReplayHeader)) + 3);
+	FFileHelper::SaveArrayToFile(Truncated, *Filename);
+	FSBSkateReplayReader EmptyReader;
+	TestFalse(TEXT("Replay without a whole block"), EmptyReader.Open(Filename));
+
+	IFileManager::Get().Delete(*Filename, false, false, true);
+	return true;
+}
+
+#endif
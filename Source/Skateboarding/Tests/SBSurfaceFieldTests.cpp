@@ -0,0 +1,138 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/HitResult.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Surface/SBSurfaceField.h"
+
+namespace SBSurfaceFieldTests
+{
+	constexpr float PlaneZ = 10.f;
+
+	/** One brick of 2x2x2 cells of 10 units over a floor at Z = 10, with surface slot 1 */
+	void MakeFloorField(FSBSurfaceFieldHeader& OutHeader, TArray<int32>& OutBrickIndex, TArray<FSBSurfaceFieldSample>& OutSamples)
+	{
+		OutHeader = FSBSurfaceFieldHeader();
+		OutHeader.CellSize = 10.f;
+		OutHeader.MaxDistance = 30.f;
+		OutHeader.BrickSize = 2;
+		OutHeader.BrickGridSize = FIntVector3(1, 1, 1);
+		OutHeader.NumBricks = 1;
+
+		OutBrickIndex.Init(0, 1);
+
+		const int32 Stride = OutHeader.BrickSize + 1;
+		OutSamples.SetNum(FSBSurfaceField::GetSamplesPerBrick(OutHeader.BrickSize));
+		for (int32 Z = 0; Z < Stride; ++Z)
+		{
+			for (int32 Index = 0; Index < Stride * Stride; ++Index)
+			{
+				FSBSurfaceFieldSample& Sample = OutSamples[Z * Stride * Stride + Index];
+				Sample.Distance = FSBSurfaceField::QuantizeDistance(FMath::Abs(Z * OutHeader.CellSize - PlaneZ), OutHeader.MaxDistance);
+				Sample.Surface = 1;
+			}
+		}
+	}
+
+	FString GetTestFilename(const TCHAR* Name)
+	{
+		return FPaths::AutomationTransientDir() / Name;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSurfaceFieldSampleTest, "Skateboarding.Surface.FieldSampleAndProbe",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSurfaceFieldSampleTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSurfaceFieldTests;
+
+	FSBSurfaceFieldHeader Header;
+	TArray<int32> BrickIndex;
+	TArray<FSBSurfaceFieldSample> Samples;
+	MakeFloorField(Header, BrickIndex, Samples);
+
+	const FString Filename = GetTestFilename(TEXT("Floor.sbfield"));
+	if (TestTrue(TEXT("Field saved"), FSBSurfaceField::Save(Filename, Header, BrickIndex, Samples, TEXT("/Game/Test.Test"))) == false)
+	{
+		return false;
+	}
+
+	{
+		FSBSurfaceField Field;
+		if (TestTrue(TEXT("Field loaded"), Field.Load(Filename)))
+		{
+			float Distance;
+			FVector Normal;
+			uint8 Surface;
+			if (TestTrue(TEXT("Sample inside the baked area"), Field.Sample(FVector(5.f, 5.f, 15.f), Distance, Normal, &Surface)))
+			{
+				TestNearlyEqual(TEXT("Distance above the floor"), Distance, 5.f, 0.01f);
+				TestTrue(TEXT("Floor normal"), Normal.Equals(FVector::UpVector, 0.01f));
+				TestEqual(TEXT("Surface slot"), static_cast<int32>(Surface), 1);
+			}
+
+			TestFalse(TEXT("Sample outside the baked area"), Field.Sample(FVector(25.f, 5.f, 5.f), Distance, Normal));
+
+			FHitResult Hit;
+			if (TestTrue(TEXT("Probe down hits the floor"), Field.Probe(FVector(5.f, 5.f, 19.f), FVector(5.f, 5.f, 1.f), Hit) == ESBSurfaceFieldResult::Surface))
+			{
+				TestNearlyEqual(TEXT("Probe hit height"), Hit.ImpactPoint.Z, static_cast<double>(PlaneZ), Header.CellSize * 0.25);
+				TestEqual(TEXT("Probe hit carries the surface slot"), Hit.Item, 1);
+			}
+
+			TestEqual(TEXT("Surface table"), Field.GetSurfaceKeys().Num(), 2);
+		}
+	}
+
+	IFileManager::Get().Delete(*Filename);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBSurfaceFieldCorruptIndexTest, "Skateboarding.Surface.FieldRejectsBadBrickIndex",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBSurfaceFieldCorruptIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace SBSurfaceFieldTests;
+
+	FSBSurfaceFieldHeader Header;
+	TArray<int32> BrickIndex;
+	TArray<FSBSurfaceFieldSample> Samples;
+	MakeFloorField(Header, BrickIndex, Samples);
+
+	const FString Filename = GetTestFilename(TEXT("BadIndex.sbfield"));
+	for (const int32 BadSlot : {1, -2})
+	{
+		BrickIndex[0] = BadSlot;
+		if (TestTrue(TEXT("Field saved"), FSBSurfaceField::Save(Filename, Header, BrickIndex, Samples, FString())))
+		{
+			FSBSurfaceField Field;
+			TestFalse(FString::Printf(TEXT("Field with brick slot %d rejected"), BadSlot), Field.Load(Filename));
+			TestFalse(TEXT("Rejected field is not loaded"), Field.IsLoaded());
+		}
+	}
+
+	// Empty bricks are stored as INDEX_NONE and read as far from any surface
+	BrickIndex[0] = INDEX_NONE;
+	if (TestTrue(TEXT("Field saved"), FSBSurfaceField::Save(Filename, Header, BrickIndex, Samples, FString())))
+	{
+		FSBSurfaceField Field;
+		float Distance;
+		FVector Normal;
+		if (TestTrue(TEXT("Field with an empty brick loaded"), Field.Load(Filename)) && TestTrue(TEXT("Empty brick sampled"), Field.Sample(FVector(5.f), Distance, Normal)))
+		{
+			TestEqual(TEXT("Empty brick distance"), Distance, Header.MaxDistance);
+		}
+	}
+
+	IFileManager::Get().Delete(*Filename);
+	return true;
+}
+
+#endif
@@ -0,0 +1,200 @@
+// Copyright 2024 Dankann Passos Weissmuller
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Score/SBTrickRecognizer.h"
+
+namespace SBTrickRecognizerTests
+{
+	constexpr float StepTime = 1.f / 120.f;
+
+	/** Feeds Steps samples of the same state, turning by YawPerStep every step, and collects the finished tricks */
+	struct FTrickScript
+	{
+		explicit FTrickScript(const FSBTrickRecognizerSettings& InSettings)
+			: Settings(InSettings)
+		{
+		}
+
+		void Roll(int32 Steps, float Pitch = 0.f)
+		{
+			Add(Steps, 0.f, Pitch, true, false);
+		}
+
+		void Fly(int32 Steps, float YawPerStep)
+		{
+			Add(Steps, YawPerStep, 0.f, false, false);
+		}
+
+		void Add(int32 Steps, float YawPerStep, float Pitch, bool bGrounded, bool bOnWall)
+		{
+			for (int32 Step = 0; Step < Steps; ++Step)
+			{
+				Yaw = FRotator::NormalizeAxis(Yaw + YawPerStep);
+
+				FSBTrickEvent Trick;
+				if (Recognizer.AddSample(StepTime, Yaw, Pitch, bGrounded, bOnWall, false, Settings, Trick))
+				{
+					Tricks.Add(Trick);
+				}
+			}
+		}
+
+		FSBTrickRecognizerSettings Settings;
+		FSBTrickRecognizer Recognizer;
+		TArray<FSBTrickEvent> Tricks;
+		float Yaw = 0.f;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBTrickRecognizerSpinTest, "Skateboarding.Tricks.Spins",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBTrickRecognizerSpinTest::RunTest(const FString& Parameters)
+{
+	using namespace SBTrickRecognizerTests;
+
+	// No tolerance, every step of the spin has to count, the takeoff step included
+	FSBTrickRecognizerSettings Settings;
+	Settings.SpinTolerance = 0.f;
+
+	{
+		FTrickScript Script(Settings);
+		Script.Roll(10);
+		Script.Fly(60, 3.f);
+		Script.Roll(1);
+		if (TestEqual(TEXT("180 landed"), Script.Tricks.Num(), 1))
+		{
+			TestTrue(TEXT("Trick is a 180"), Script.Tricks[0].Trick == ESBTrick::Spin180);
+			TestEqual(TEXT("180 score"), Script.Tricks[0].Score, Settings.Spin180Score);
+			TestNearlyEqual(TEXT("180 air time"), Script.Tricks[0].Duration, 60 * StepTime, 1.e-4f);
+		}
+	}
+
+	{
+		// Spin wraps around the yaw range, the recognizer unwraps it
+		FTrickScript Script(Settings);
+		Script.Roll(10);
+		Script.Fly(80, -4.5f);
+		Script.Roll(1);
+		if (TestEqual(TEXT("360 landed"), Script.Tricks.Num(), 1))
+		{
+			TestTrue(TEXT("Trick is a 360"), Script.Tricks[0].Trick == ESBTrick::Spin360);
+			TestEqual(TEXT("360 score"), Script.Tricks[0].Score, Settings.Spin360Score);
+		}
+	}
+
+	{
+		FTrickScript Script(Settings);
+		Script.Roll(10);
+		Script.Fly(60, 2.f);
+		Script.Roll(1);
+		TestEqual(TEXT("120 degrees is no spin"), Script.Tricks.Num(), 0);
+	}
+
+	{
+		FTrickScript Script(Settings);
+		Script.Roll(10);
+		Script.Fly(FMath::FloorToInt32(Settings.MinAirTime / StepTime) - 2, 10.f);
+		Script.Roll(1);
+		TestEqual(TEXT("Spin shorter than the min air time"), Script.Tricks.Num(), 0);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBTrickRecognizerGroundTest, "Skateboarding.Tricks.ManualsAndWallRides",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBTrickRecognizerGroundTest::RunTest(const FString& Parameters)
+{
+	using namespace SBTrickRecognizerTests;
+
+	const FSBTrickRecognizerSettings Settings;
+
+	{
+		FTrickScript Script(Settings);
+		Script.Roll(10);
+		Script.Roll(120, Settings.ManualMinPitch + 5.f);
+		Script.Roll(1);
+		if (TestEqual(TEXT("Manual finished"), Script.Tricks.Num(), 1))
+		{
+			TestTrue(TEXT("Trick is a manual"), Script.Tricks[0].Trick == ESBTrick::Manual);
+			TestNearlyEqual(TEXT("Manual time"), Script.Tricks[0].Duration, 1.f, 1.e-3f);
+			TestEqual(TEXT("Manual score"), Script.Tricks[0].Score, Settings.ManualScorePerSecond);
+		}
+	}
+
+	{
+		FTrickScript Script(Settings);
+		Script.Roll(10);
+		Script.Roll(FMath::FloorToInt32(Settings.ManualMinTime / StepTime) - 2, -(Settings.ManualMinPitch + 5.f));
+		Script.Roll(1);
+		TestEqual(TEXT("Short nose manual"), Script.Tricks.Num(), 0);
+	}
+
+	{
+		FTrickScript Script(Settings);
+		Script.Roll(10);
+		Script.Add(60, 0.f, 0.f, true, true);
+		Script.Roll(1);
+		if (TestEqual(TEXT("Wall ride finished"), Script.Tricks.Num(), 1))
+		{
+			TestTrue(TEXT("Trick is a wall ride"), Script.Tricks[0].Trick == ESBTrick::WallRide);
+			TestEqual(TEXT("Wall ride score"), Script.Tricks[0].Score, FMath::RoundToInt32(Settings.WallRideScorePerSecond * 0.5f));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBTrickRecognizerComboTest, "Skateboarding.Tricks.Combos",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBTrickRecognizerComboTest::RunTest(const FString& Parameters)
+{
+	using namespace SBTrickRecognizerTests;
+
+	FSBTrickRecognizerSettings Settings;
+	Settings.SpinTolerance = 0.f;
+
+	FTrickScript Script(Settings);
+	Script.Roll(10);
+	Script.Fly(60, 3.f);
+	// Manual starts right after the landing, inside the combo window
+	Script.Roll(120, Settings.ManualMinPitch + 5.f);
+	Script.Roll(FMath::CeilToInt32(Settings.ComboWindow / StepTime) + 10);
+	Script.Fly(60, 3.f);
+	Script.Roll(1);
+
+	if (TestEqual(TEXT("Three tricks"), Script.Tricks.Num(), 3))
+	{
+		TestEqual(TEXT("First trick starts a combo"), Script.Tricks[0].ComboCount, 1);
+		TestEqual(TEXT("Manual continues the combo"), Script.Tricks[1].ComboCount, 2);
+		TestNearlyEqual(TEXT("Second trick multiplier"), Script.Tricks[1].ComboMultiplier, 1.f + Settings.ComboMultiplierStep);
+		TestEqual(TEXT("Second trick score"), Script.Tricks[1].Score,
+		          FMath::RoundToInt32(Settings.ManualScorePerSecond * (1.f + Settings.ComboMultiplierStep)));
+		TestEqual(TEXT("Trick after the window starts a new combo"), Script.Tricks[2].ComboCount, 1);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBTrickRecognizerHistoryTest, "Skateboarding.Tricks.SampleHistory",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSBTrickRecognizerHistoryTest::RunTest(const FString& Parameters)
+{
+	using namespace SBTrickRecognizerTests;
+
+	FTrickScript Script{FSBTrickRecognizerSettings()};
+	Script.Fly(FSBTrickRecognizer::Capacity + 10, 1.f);
+
+	TestEqual(TEXT("History is capped"), Script.Recognizer.GetNum(), FSBTrickRecognizer::Capacity);
+	TestNearlyEqual(TEXT("Latest sample"), Script.Recognizer.GetRecent(0).Yaw, Script.Yaw);
+	TestNearlyEqual(TEXT("Oldest sample"), Script.Recognizer.GetRecent(FSBTrickRecognizer::Capacity - 1).Yaw, Script.Yaw - (FSBTrickRecognizer::Capacity - 1));
+	TestNearlyEqual(TEXT("Yaw rate"), Script.Recognizer.GetRecent(0).YawRate, 1.f / StepTime, 0.1f);
+	return true;
+}
+
+#endif